@@ -0,0 +1,545 @@
+// Micro-benchmarks for the firmware's pure compute paths on the host:
+// colour normalisation, the load-cell filter stages, the loss-fraction
+// interpolation and every DisplayUI::show*() composed into the in-memory
+// SSD1306 buffer (flush held, so no bus emulation is timed).
+//
+// Each case reports ns/op (median of several batches) and heap allocations
+// and bytes per op; filter cases also report their step response (settle
+// time, residual noise, spike leak-through). Results go to a JSON file, one
+// benchmark per line, so runs from two commits can be diffed or fed back in
+// with --baseline:
+//
+//   pio run -e bench && .pio/build/bench/program [-o bench.json]
+//       [--baseline old.json] [--fail-over 10] [--filter show] [--label sha]
+
+#include <Arduino.h>
+#include <hal_native.h>
+
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <math.h>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "browning.h"
+#include "colour.h"
+#include "DisplayUI.h"
+#include "load_cell.h"
+#include "loss_fit.h"
+#include "ModeUI.h"
+#include "settle_detector.h"
+
+// ---------- Allocation counting ----------
+// glibc: interpose malloc & co. so C allocations (Arduino String, printf
+// buffers) count too; operator new goes through malloc. Elsewhere only
+// operator new is seen.
+namespace
+{
+    uint64_t g_allocs = 0;
+    uint64_t g_allocBytes = 0;
+}
+
+#if defined(__GLIBC__)
+extern "C"
+{
+    void *__libc_malloc(size_t);
+    void *__libc_calloc(size_t, size_t);
+    void *__libc_realloc(void *, size_t);
+    void __libc_free(void *);
+
+    void *malloc(size_t n)
+    {
+        g_allocs++;
+        g_allocBytes += n;
+        return __libc_malloc(n);
+    }
+    void *calloc(size_t n, size_t sz)
+    {
+        g_allocs++;
+        g_allocBytes += n * sz;
+        return __libc_calloc(n, sz);
+    }
+    void *realloc(void *p, size_t n)
+    {
+        g_allocs++;
+        g_allocBytes += n;
+        return __libc_realloc(p, n);
+    }
+    void free(void *p) { __libc_free(p); }
+}
+
+void *operator new(size_t n)
+{
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+#else
+void *operator new(size_t n)
+{
+    g_allocs++;
+    g_allocBytes += n;
+    if (void *p = malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+#endif
+void *operator new[](size_t n) { return operator new(n); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    // Keep results alive without letting the compiler see through them
+    template <class T>
+    inline void keep(T const &v)
+    {
+        asm volatile("" : : "r,m"(v) : "memory");
+    }
+
+    // Step response of a load-cell filter at the scale's output rate
+    struct Response
+    {
+        float settleStepMs;  // 0.5 g step on a loaded scale, to within SETTLE_BAND_G
+        float settlePlaceMs; // 30 g placed on an empty scale
+        float noiseG;        // residual RMS once settled
+        float spikeG;        // peak error after a one-sample 20 g spike
+    };
+
+    struct Result
+    {
+        std::string name;
+        uint64_t iters;
+        double nsPerOp;
+        double allocsPerOp;
+        double bytesPerOp;
+        bool hasResponse;
+        Response resp;
+    };
+
+    struct Options
+    {
+        const char *outPath = "bench.json";
+        const char *baselinePath = nullptr;
+        const char *filter = nullptr;
+        const char *label = "";
+        double failOverPct = 0.0; // 0 = report only
+        double minBatchMs = 20.0;
+        int batches = 7;
+    };
+
+    Options g_opt;
+    std::vector<Result> g_results;
+
+    // Run body(i) in batches sized to minBatchMs; report the median batch
+    template <class F>
+    void bench(const char *name, F &&body)
+    {
+        if (g_opt.filter && !strstr(name, g_opt.filter))
+            return;
+
+        uint64_t n = 1;
+        for (;;)
+        {
+            auto t0 = Clock::now();
+            for (uint64_t i = 0; i < n; i++)
+                body(i);
+            double ms = std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+            if (ms >= g_opt.minBatchMs || n >= (1ull << 34))
+                break;
+            n = ms > 0.5 ? (uint64_t)(n * (g_opt.minBatchMs * 1.2 / ms)) + 1 : n * 8;
+        }
+
+        std::vector<double> ns;
+        uint64_t allocs = 0, bytes = 0;
+        for (int b = 0; b < g_opt.batches; b++)
+        {
+            const uint64_t a0 = g_allocs, by0 = g_allocBytes;
+            auto t0 = Clock::now();
+            for (uint64_t i = 0; i < n; i++)
+                body(i);
+            auto t1 = Clock::now();
+            allocs += g_allocs - a0;
+            bytes += g_allocBytes - by0;
+            ns.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / n);
+        }
+        std::sort(ns.begin(), ns.end());
+        const double total = (double)n * g_opt.batches;
+        g_results.push_back({name, n, ns[ns.size() / 2], allocs / total, bytes / total, false, {}});
+        printf("%-34s %10.1f ns/op %8.2f allocs/op %9.1f B/op\n",
+               name, ns[ns.size() / 2], allocs / total, bytes / total);
+    }
+
+    uint32_t g_rng = 0x9E3779B9u;
+    uint32_t rnd()
+    {
+        g_rng ^= g_rng << 13;
+        g_rng ^= g_rng >> 17;
+        g_rng ^= g_rng << 5;
+        return g_rng;
+    }
+
+    float gauss()
+    {
+        float u1 = ((rnd() >> 8) + 0.5f) / 16777216.0f, u2 = (rnd() >> 8) / 16777216.0f;
+        return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+    }
+
+    // ---------- Kernels ----------
+    void benchKernels()
+    {
+        // Inputs vary per call so nothing folds to a constant
+        constexpr size_t N = 1024;
+        static ColourReading frames[N];
+        static float temps[N];
+        static float weights[N];
+        static float drying[N];
+        for (size_t i = 0; i < N; i++)
+        {
+            uint16_t c = 20 + rnd() % 4000;
+            frames[i].c16 = c;
+            frames[i].r16 = rnd() % (c + 1);
+            frames[i].g16 = rnd() % (c + 1);
+            frames[i].b16 = rnd() % (c + 1);
+            temps[i] = (float)(rnd() % 4000) / 100.0f - 10.0f;
+            weights[i] = (i & 255) < 128 ? 0.05f * gauss() : 30.0f + 0.05f * gauss(); // place / remove
+            drying[i] = 27.0f + 3.0f * expf(-(float)i / 300.0f) + 0.03f * gauss();
+        }
+
+        bench("colour/normalize", [&](uint64_t i) {
+            ColourReading &r = frames[i & (N - 1)];
+            colourNormalize(1200, r);
+            keep(r.r_out);
+        });
+
+        bench("colour/browning_index", [&](uint64_t i) {
+            const ColourReading &r = frames[i & (N - 1)];
+            int32_t idx = browningLog2Q12(r.r16 + 1) - browningLog2Q12(r.b16 + 1);
+            uint8_t l = browningLightness(((uint32_t)r.c16 << 8) / 1200u);
+            keep(idx);
+            keep(l);
+        });
+
+        bench("colour/next_exposure", [&](uint64_t i) {
+            const ColourReading &r = frames[i & (N - 1)];
+            ColourExposure e = colourNextExposure({(uint8_t)(i & 0xF0), (uint8_t)(i & 3)}, r.c16);
+            keep(e.atime);
+        });
+
+        bench("toast/loss_fraction", [&](uint64_t i) {
+            float f = ModeUI::lossFractionForStartTemp(temps[i & (N - 1)]);
+            keep(f);
+        });
+
+        SettleDetector<8> det;
+        bench("stats/settle_detector_push", [&](uint64_t i) {
+            SettleEvent e = det.push(weights[i & (N - 1)]);
+            keep(e);
+        });
+
+        LossCurveFit fit(0.1f);
+        fit.reset(drying[0]);
+        bench("toast/loss_fit_push_eta", [&](uint64_t i) {
+            fit.push(drying[i & (N - 1)]);
+            float eta = fit.timeTo(28.0f);
+            keep(eta);
+        });
+    }
+
+    // ---------- Load-cell filter stages ----------
+    constexpr float INPUT_NOISE_G = 0.05f;
+    constexpr float SETTLE_BAND_G = 0.1f;
+#if LC_STREAM_EN
+    constexpr float FILTER_DT_S = (float)LC_CIC_DECIM / LC_STREAM_SPS;
+#else
+    constexpr float FILTER_DT_S = 0.2f; // sensorManager's LC_PERIOD_MS
+#endif
+
+    // Feeds `seconds` of noisy input at `level`. Returns how long (ms) the
+    // output took to enter SETTLE_BAND_G around it for good, or -1 if it
+    // was still outside at the end; rms covers the second half.
+    template <class F>
+    float settle(F &f, float level, float seconds, float *rms = nullptr)
+    {
+        const int n = (int)(seconds / FILTER_DT_S);
+        int lastOut = -1;
+        double sq = 0.0;
+        int sqN = 0;
+        for (int i = 0; i < n; i++)
+        {
+            const float err = f.step(level + INPUT_NOISE_G * gauss()) - level;
+            if (fabsf(err) > SETTLE_BAND_G)
+                lastOut = i;
+            if (i >= n / 2)
+            {
+                sq += (double)err * err;
+                sqN++;
+            }
+        }
+        if (rms)
+            *rms = (float)sqrt(sq / sqN);
+        if (lastOut == n - 1)
+            return -1.0f;
+        return (lastOut + 1) * FILTER_DT_S * 1000.0f;
+    }
+
+    template <class F>
+    Response stepResponse()
+    {
+        F f;
+        f.configure(LoadCellNAU7802::filterConfig(FILTER_DT_S));
+        Response r{};
+        g_rng = 0x2545F491u; // same noise for every filter
+
+        f.reset(30.0f);
+        settle(f, 30.0f, 2.0f);
+        r.settleStepMs = settle(f, 30.5f, 8.0f, &r.noiseG);
+
+        f.reset(0.0f);
+        settle(f, 0.0f, 1.0f);
+        r.settlePlaceMs = settle(f, 30.0f, 6.0f);
+
+        f.reset(30.0f);
+        settle(f, 30.0f, 2.0f);
+        float peak = fabsf(f.step(50.0f) - 30.0f);
+        for (int i = 0; i < (int)(2.0f / FILTER_DT_S); i++)
+            peak = fmaxf(peak, fabsf(f.step(30.0f) - 30.0f));
+        r.spikeG = peak;
+        return r;
+    }
+
+    template <class F>
+    void benchFilter(const char *name, const float *grams, size_t n)
+    {
+        if (g_opt.filter && !strstr(name, g_opt.filter))
+            return;
+        F f;
+        f.configure(LoadCellNAU7802::filterConfig(FILTER_DT_S));
+        f.reset(0.0f);
+        bench(name, [&](uint64_t i) {
+            float y = f.step(grams[i & (n - 1)]);
+            keep(y);
+        });
+        g_results.back().hasResponse = true;
+        g_results.back().resp = stepResponse<F>();
+    }
+
+    void benchFilters()
+    {
+        // A slow ramp with noise and the odd spike, like a slice drying
+        constexpr size_t N = 1024;
+        static float grams[N];
+        for (size_t i = 0; i < N; i++)
+            grams[i] = 30.0f - 0.002f * i + INPUT_NOISE_G * gauss() + (i % 97 == 0 ? 8.0f : 0.0f);
+
+        benchFilter<FilterChain<MedianN<3>>>("filter/median3", grams, N);
+        benchFilter<FilterChain<MedianN<5>>>("filter/median5", grams, N);
+        benchFilter<FilterChain<FirHann<9>>>("filter/fir_hann9", grams, N);
+        benchFilter<FilterChain<Kalman1D>>("filter/kalman", grams, N);
+        benchFilter<FilterChain<Ema>>("filter/ema", grams, N);
+        benchFilter<FilterChain<Deadband>>("filter/deadband", grams, N);
+        // what update() did before LcFilter
+        benchFilter<FilterChain<Deadband, Ema>>("filter/legacy_deadband_ema", grams, N);
+        benchFilter<LcFilter>("loadcell/filter_step", grams, N);
+
+        printf("\n%-34s %10s %10s %9s %9s   (%.0f Hz, noise %.2f g, band %.2f g)\n", "step response",
+               "0.5g ms", "place ms", "noise g", "spike g", 1.0f / FILTER_DT_S, INPUT_NOISE_G, SETTLE_BAND_G);
+        for (const Result &r : g_results)
+        {
+            if (!r.hasResponse)
+                continue;
+            char a[16], b[16];
+            snprintf(a, sizeof(a), r.resp.settleStepMs < 0 ? "never" : "%.0f", r.resp.settleStepMs);
+            snprintf(b, sizeof(b), r.resp.settlePlaceMs < 0 ? "never" : "%.0f", r.resp.settlePlaceMs);
+            printf("%-34s %10s %10s %9.3f %9.2f\n", r.name.c_str(), a, b, r.resp.noiseG, r.resp.spikeG);
+        }
+        printf("\n");
+    }
+
+    // ---------- DisplayUI composition ----------
+    void benchDisplay()
+    {
+        static HostBoard board;
+        board.powerOn();
+        hal::serialEcho(false);
+        DisplayUI::begin();
+        DisplayUI::holdFlush(true);
+        const uint8_t *fb = DisplayUI::getDisplay().getBuffer();
+
+        bench("display/show_splash", [&](uint64_t) {
+            DisplayUI::showSplash();
+            keep(fb[0]);
+        });
+        bench("display/show_mode_selection", [&](uint64_t i) {
+            DisplayUI::showModeSelection((int)(i % 3));
+            keep(fb[0]);
+        });
+        bench("display/show_sensor_showcase", [&](uint64_t i) {
+            DisplayUI::showSensorShowcase(20.0f + (i % 200) * 0.7f, (i % 500) * 0.1f,
+                                          (uint8_t)i, (uint8_t)(i >> 3), (uint8_t)(i >> 5),
+                                          (i % 100) / 100.0f);
+            keep(fb[0]);
+        });
+        bench("display/show_toasting_process", [&](uint64_t i) {
+            DisplayUI::showToastingProcess((i % 101) / 100.0f);
+            keep(fb[0]);
+        });
+        bench("display/show_toast_ready", [&](uint64_t) {
+            DisplayUI::showToastReady();
+            keep(fb[0]);
+        });
+        bench("display/show_place_bread", [&](uint64_t i) {
+            DisplayUI::showPlaceBread(i & 1, (i % 6) * 1.0f);
+            keep(fb[0]);
+        });
+        bench("display/show_calibrating", [&](uint64_t i) {
+            DisplayUI::showCalibrating((i % 600) * 0.1f);
+            keep(fb[0]);
+        });
+        bench("display/show_yes_no", [&](uint64_t i) {
+            DisplayUI::showYesNo((int)(i & 1));
+            keep(fb[0]);
+        });
+
+        DisplayUI::holdFlush(false);
+    }
+
+    // ---------- Output ----------
+    bool writeJson(const char *path)
+    {
+        FILE *f = fopen(path, "w");
+        if (!f)
+        {
+            perror(path);
+            return false;
+        }
+        fprintf(f, "{\"schema\": 1, \"label\": \"%s\", \"benchmarks\": [\n", g_opt.label);
+        for (size_t i = 0; i < g_results.size(); i++)
+        {
+            const Result &r = g_results[i];
+            fprintf(f, "  {\"name\": \"%s\", \"iters\": %llu, \"ns_per_op\": %.3f, "
+                       "\"allocs_per_op\": %.4f, \"bytes_per_op\": %.2f",
+                    r.name.c_str(), (unsigned long long)r.iters, r.nsPerOp,
+                    r.allocsPerOp, r.bytesPerOp);
+            if (r.hasResponse)
+                fprintf(f, ", \"settle_step_ms\": %.0f, \"settle_place_ms\": %.0f, "
+                           "\"noise_g\": %.4f, \"spike_g\": %.3f",
+                        r.resp.settleStepMs, r.resp.settlePlaceMs, r.resp.noiseG, r.resp.spikeG);
+            fprintf(f, "}%s\n", i + 1 < g_results.size() ? "," : "");
+        }
+        fprintf(f, "]}\n");
+        fclose(f);
+        return true;
+    }
+
+    // Reads back what writeJson() produces (one benchmark per line)
+    std::map<std::string, Result> readJson(const char *path)
+    {
+        std::map<std::string, Result> out;
+        FILE *f = fopen(path, "r");
+        if (!f)
+        {
+            perror(path);
+            return out;
+        }
+        char line[512];
+        while (fgets(line, sizeof(line), f))
+        {
+            char name[128];
+            Result r{};
+            unsigned long long iters = 0;
+            if (sscanf(line, " {\"name\": \"%127[^\"]\", \"iters\": %llu, \"ns_per_op\": %lf, "
+                             "\"allocs_per_op\": %lf, \"bytes_per_op\": %lf",
+                       name, &iters, &r.nsPerOp, &r.allocsPerOp, &r.bytesPerOp) == 5)
+            {
+                r.name = name;
+                r.iters = iters;
+                out[r.name] = r;
+            }
+        }
+        fclose(f);
+        return out;
+    }
+
+    // Flags slower-than---fail-over or extra allocations; returns how many
+    // (only counted when --fail-over is given, so plain runs never fail)
+    int compare(const char *path)
+    {
+        std::map<std::string, Result> base = readJson(path);
+        int regressions = 0;
+        printf("\n%-34s %10s %10s %8s %10s\n", "vs baseline", "old ns", "new ns", "delta", "allocs");
+        for (const Result &r : g_results)
+        {
+            auto it = base.find(r.name);
+            if (it == base.end())
+            {
+                printf("%-34s %10s %10.1f %8s\n", r.name.c_str(), "-", r.nsPerOp, "new");
+                continue;
+            }
+            const Result &b = it->second;
+            double pct = b.nsPerOp > 0 ? (r.nsPerOp / b.nsPerOp - 1.0) * 100.0 : 0.0;
+            bool allocUp = r.allocsPerOp > b.allocsPerOp + 1e-6;
+            bool bad = (g_opt.failOverPct > 0 && pct > g_opt.failOverPct) || allocUp;
+            regressions += bad && g_opt.failOverPct > 0;
+            printf("%-34s %10.1f %10.1f %+7.1f%% %4.2f->%-4.2f%s\n", r.name.c_str(), b.nsPerOp, r.nsPerOp,
+                   pct, b.allocsPerOp, r.allocsPerOp, bad ? "  REGRESSION" : "");
+        }
+        return regressions;
+    }
+
+    void usage(const char *argv0)
+    {
+        fprintf(stderr, "usage: %s [-o out.json] [--baseline old.json] [--fail-over pct]\n"
+                        "          [--filter substr] [--label text] [--min-ms ms] [--batches n]\n",
+                argv0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const bool hasArg = i + 1 < argc;
+        if (hasArg && strcmp(argv[i], "-o") == 0)
+            g_opt.outPath = argv[++i];
+        else if (hasArg && strcmp(argv[i], "--baseline") == 0)
+            g_opt.baselinePath = argv[++i];
+        else if (hasArg && strcmp(argv[i], "--fail-over") == 0)
+            g_opt.failOverPct = atof(argv[++i]);
+        else if (hasArg && strcmp(argv[i], "--filter") == 0)
+            g_opt.filter = argv[++i];
+        else if (hasArg && strcmp(argv[i], "--label") == 0)
+            g_opt.label = argv[++i];
+        else if (hasArg && strcmp(argv[i], "--min-ms") == 0)
+            g_opt.minBatchMs = atof(argv[++i]);
+        else if (hasArg && strcmp(argv[i], "--batches") == 0)
+            g_opt.batches = std::max(1, atoi(argv[++i]));
+        else
+        {
+            usage(argv[0]);
+            return 2;
+        }
+    }
+
+    benchKernels();
+    benchFilters();
+    benchDisplay();
+
+    if (!writeJson(g_opt.outPath))
+        return 1;
+    printf("\n%zu benchmarks -> %s\n", g_results.size(), g_opt.outPath);
+
+    if (g_opt.baselinePath && compare(g_opt.baselinePath) > 0)
+        return 1;
+    return 0;
+}
@@ -0,0 +1,33 @@
+#include "board.h"
+
+#include <Arduino.h>
+#include "DisplayUI.h"
+#include "Input.h"
+
+constexpr int8_t HostBoard::COLOUR_CH[3];
+
+void HostBoard::powerOn()
+{
+    hal::reset();
+    hal::attachI2C(OLED_ADDR, &oled);
+    hal::attachI2C(0x2A, &nau);
+    nau.attachDrdy(SCALE_DRDY_PIN);
+    hal::attachI2C(0x5A, &mlx, TEMP_CH);
+    for (int i = 0; i < 3; i++)
+        hal::attachI2C(0x29, &tcs[i], COLOUR_CH[i]);
+    setGrams(0.0f);
+}
+
+void HostBoard::setGrams(float g)
+{
+    nau.setCounts(SCALE_ZERO_COUNTS + (int32_t)(g * SCALE_COUNTS_PER_G));
+}
+
+int hostClickEvery(uint32_t periodMs, uint32_t holdMs)
+{
+    const uint64_t periodUs = (uint64_t)periodMs * 1000u;
+    const uint64_t holdUs = (uint64_t)holdMs * 1000u;
+    return hal::addTickHook([=](uint64_t now) {
+        hal::setPin(ENC_PIN_SW, (now % periodUs) < holdUs ? LOW : HIGH);
+    });
+}
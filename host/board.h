@@ -0,0 +1,36 @@
+#pragma once
+
+// The toaster's I2C bus on the host: the same parts at the same addresses and
+// TCA9548A channels as the real board, as fake_devices models.
+
+#include <fake_devices.h>
+
+struct HostBoard
+{
+    // Must match sensorManager.cpp (TEMP_MUX_CH) and colour.cpp (COLOR_CH)
+    static constexpr int8_t TEMP_CH = 0;
+    static constexpr int8_t COLOUR_CH[3] = {1, 3, 4};
+
+    // Scale wiring: raw counts at zero load and the firmware's default
+    // counts-per-gram (used until a calibration is stored).
+    static constexpr int32_t SCALE_ZERO_COUNTS = 84000;
+    static constexpr float SCALE_COUNTS_PER_G = 700.0f;
+    // Must match load_cell.h (LC_DRDY_PIN)
+    static constexpr uint8_t SCALE_DRDY_PIN = 27;
+
+    hal::FakeSsd1306 oled;
+    hal::FakeTcs34725 tcs[3];
+    hal::FakeMlx90614 mlx;
+    hal::FakeNau7802 nau;
+
+    // hal::reset() and attach every part to the fake bus
+    void powerOn();
+
+    void setGrams(float g);
+    void setTemps(float ambientC, float objectC) { mlx.setTemps(ambientC, objectC); }
+    void setColour(int idx, float r, float g, float b, float c) { tcs[idx].setScene(r, g, b, c); }
+};
+
+// Click the encoder push button (active low) for holdMs at the start of every
+// periodMs of virtual time. Returns the tick-hook handle.
+int hostClickEvery(uint32_t periodMs, uint32_t holdMs = 60);
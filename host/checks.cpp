@@ -0,0 +1,207 @@
+// Pass/fail checks of firmware behaviour on the fake board and virtual
+// clock. Each check starts from a fresh board; the exit status is the
+// number that failed.
+//
+//   pio run -e checks && .pio/build/checks/program [-v]
+
+#include <Arduino.h>
+#include <hal_native.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <Adafruit_GFX.h>
+
+#include "board.h"
+#include "DisplayUI.h"
+#include "Input.h"
+#include "ModeUI.h"
+#include "boot.h"
+#include "scheduler.h"
+#include "sensorManager.h"
+
+namespace
+{
+    bool verbose = false;
+
+    // Fresh board with the firmware booted on it (menu up, sensors ready)
+    void bootBoard(HostBoard &board)
+    {
+        board.powerOn();
+        hal::serialEcho(verbose);
+        board.setTemps(21.0f, 21.0f);
+        for (int i = 0; i < 3; i++)
+            board.setColour(i, 900, 820, 700, 2400);
+        Serial.begin(115200);
+        Boot::run();
+    }
+
+    // Acquisition passes (inline on the host) until the scale op leaves
+    // Running or timeoutMs of virtual time has passed
+    LoadCellNAU7802::OpStatus runScaleOp(uint32_t timeoutMs)
+    {
+        const uint32_t start = millis();
+        while (scaleOpStatus() == LoadCellNAU7802::OpStatus::Running && millis() - start < timeoutMs)
+        {
+            sensorsUpdate();
+            delay(SENSOR_TASK_PERIOD_MS);
+        }
+        return scaleOpStatus();
+    }
+
+    bool checkTare(HostBoard &board)
+    {
+        // The boot zero reads an empty scale; an offset appears (crumbs, a
+        // board laid on it) and a tare has to take it back out
+        board.setGrams(12.0f);
+        for (int i = 0; i < 100; i++)
+        {
+            sensorsUpdate();
+            delay(SENSOR_TASK_PERIOD_MS);
+        }
+        const float before = getSensorSnapshot().weightG;
+        if (fabsf(before - 12.0f) > 0.5f)
+        {
+            printf("  scale reads %.2f g before the tare, expected 12\n", before);
+            return false;
+        }
+
+        if (!scaleStartTare())
+        {
+            printf("  scaleStartTare() refused\n");
+            return false;
+        }
+        if (scaleStartTare())
+        {
+            printf("  a second tare started while one was running\n");
+            return false;
+        }
+
+        const uint32_t startMs = millis();
+        const LoadCellNAU7802::OpStatus st = runScaleOp(LC_OP_TIMEOUT_MS + 1000);
+        const uint32_t tookMs = millis() - startMs;
+        if (st != LoadCellNAU7802::OpStatus::Done || scaleOpProgress() != 1.0f)
+        {
+            printf("  tare ended %s (progress %.2f) after %lu ms\n", LoadCellNAU7802::opStatusName(st),
+                   scaleOpProgress(), (unsigned long)tookMs);
+            return false;
+        }
+
+        for (int i = 0; i < 20; i++)
+        {
+            sensorsUpdate();
+            delay(SENSOR_TASK_PERIOD_MS);
+        }
+        const float after = getSensorSnapshot().weightG;
+        printf("  tare done in %lu ms: %.2f g -> %.2f g\n", (unsigned long)tookMs, before, after);
+        return fabsf(after) < 0.2f;
+    }
+
+    // ---------- UI driving ----------
+    // The loop task's passes until ms of virtual time have gone by
+    void runUi(uint32_t ms)
+    {
+        const uint32_t start = millis();
+        while (millis() - start < ms)
+            Sched::runOnce();
+    }
+
+    void click()
+    {
+        hal::setPin(ENC_PIN_SW, LOW);
+        runUi(60);
+        hal::setPin(ENC_PIN_SW, HIGH);
+        runUi(200);
+    }
+
+    // One detent clockwise (A edge with A == B afterwards, as the decoder counts)
+    void turnClockwise()
+    {
+        const int a = !hal::pinLevel(ENC_PIN_A);
+        hal::setPin(ENC_PIN_B, a);
+        hal::setPin(ENC_PIN_A, a);
+        runUi(200);
+    }
+
+    // Text rendered exactly as the firmware's font draws it, anywhere in
+    // the question area (above the YES/NO buttons) of the panel
+    bool panelShows(const HostBoard &board, const char *text)
+    {
+        const int w = 6 * (int)strlen(text), h = 8;
+        GFXcanvas1 want(w, h);
+        want.setTextWrap(false);
+        want.setCursor(0, 0);
+        want.print(text);
+
+        for (int y0 = 0; y0 + h <= 27; y0++)
+            for (int x0 = 0; x0 + w <= hal::FakeSsd1306::W; x0++)
+            {
+                bool same = true;
+                for (int y = 0; y < h && same; y++)
+                    for (int x = 0; x < w && same; x++)
+                        same = want.getPixel(x, y) == board.oled.pixel(x0 + x, y0 + y);
+                if (same)
+                    return true;
+            }
+        return false;
+    }
+
+    bool expectPanel(const HostBoard &board, const char *text, bool shown)
+    {
+        if (panelShows(board, text) == shown)
+            return true;
+        printf("  \"%s\" is %s the panel\n", text, shown ? "not on" : "still on");
+        return false;
+    }
+
+    bool checkDialogQuestions(HostBoard &board)
+    {
+        hal::setPin(ENC_PIN_SW, HIGH);
+        runUi(300);
+        if (!ModeUI::inMenu())
+        {
+            printf("  not in the menu after boot\n");
+            return false;
+        }
+
+        // Toast -> "Is the Temperature Jig Setup?"
+        click();
+        if (!expectPanel(board, "Is the Temperature", true) || !expectPanel(board, "Jig Setup?", true))
+            return false;
+
+        // No -> the second question replaces the first on the panel
+        turnClockwise();
+        click();
+        return expectPanel(board, "Stop on toast colour?", true) && expectPanel(board, "Is the Temperature", false);
+    }
+
+    struct Check
+    {
+        const char *name;
+        bool (*fn)(HostBoard &);
+    };
+
+    const Check checks[] = {
+        {"scale tare runs to completion", checkTare},
+        {"yes/no dialogs show their own question", checkDialogQuestions},
+    };
+}
+
+int main(int argc, char **argv)
+{
+    verbose = argc > 1 && strcmp(argv[1], "-v") == 0;
+
+    static HostBoard board;
+    int failed = 0;
+    for (const Check &c : checks)
+    {
+        printf("[CHECK] %s\n", c.name);
+        bootBoard(board);
+        const bool ok = c.fn(board);
+        printf("[%s] %s\n", ok ? "PASS" : "FAIL", c.name);
+        failed += ok ? 0 : 1;
+    }
+    printf("[CHECK] %d of %u failed\n", failed, (unsigned)(sizeof(checks) / sizeof(checks[0])));
+    return failed;
+}
@@ -0,0 +1,429 @@
+// Replay recorded toasting cycles (src/cycle_log.h) through the real
+// sensorManager and ModeUI::runToastingFlow() on the fake board, far faster
+// than real time, and report how each stop moved against the recording.
+//
+//   pio run -e replay && .pio/build/replay/program [-g temp|weight|colour]
+//       [-o replay.csv] traces/*.bin | capture.log ...
+//
+// Inputs are /tlog/<n>.bin files or Serial captures of the 'L' export
+// (tools/tlog2csv.py reads the same). Without -g each trace runs with the
+// guide it was recorded under.
+//
+// The recorded streams drive the fakes: weight as the load cell's load
+// (advanced by the firmware's own weight lag, since the recording already
+// went through the filter once), object temperature as the MLX reading,
+// each colour sensor's frames as its scene. The slice goes in a moment
+// after the flow starts and the trace's t = 0 follows the recorded settle
+// time; stops are reported on the trace's own timeline, corrected for any
+// difference in the replayed settle. Past the last sample the weight runs
+// on at its final slope and the rest hold; a stop well past the end is
+// flagged. Colour stops reproduce to a second or two: the log keeps every
+// third frame of each sensor, so the browning reference frame differs.
+//
+// Against an unchanged firmware the stops should come back within a tick
+// or so (weight, temp) and the same reason; anything else is the change.
+
+#include <Arduino.h>
+#include <hal_native.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "board.h"
+#include "DisplayUI.h"
+#include "Input.h"
+#include "ModeUI.h"
+#include "cycle_log.h"
+#include "sensorManager.h"
+
+namespace
+{
+    constexpr float EMPTY_S = 2.5f;      // empty jig before the flow, as in the sweep
+    constexpr float PLACE_AT_S = 1.0f;   // slice goes in this long after the flow starts
+    constexpr uint32_t DEFAULT_SETTLE_MS = 1500; // traces cut short have no end record
+    constexpr float TAIL_S = 3.0f;       // weight slope carried past the end from this window
+    constexpr float PAST_END_GRACE_S = 1.0f; // a stop later than this past the last sample is flagged
+
+    struct Sample
+    {
+        uint32_t tMs;
+        float weightG, tempC;
+        uint8_t sensor;
+        uint16_t r, g, b, c;
+    };
+
+    struct Trace
+    {
+        std::string name;
+        CycleLogHeader h;
+        std::vector<Sample> samples;
+        bool hasEnd = false;
+        CycleLogEnd end;
+    };
+
+    bool decode(const std::string &name, const std::vector<uint8_t> &data, Trace &t)
+    {
+        if (data.size() < sizeof(CycleLogHeader))
+            return false;
+        memcpy(&t.h, data.data(), sizeof(t.h));
+        if (memcmp(t.h.magic, "TLOG", 4) != 0 || t.h.version != 1)
+            return false;
+
+        t.name = name;
+        uint32_t ms = 0;
+        int32_t wMg = t.h.startWeightMg, tMc = t.h.startTempMc;
+        for (size_t off = sizeof(CycleLogHeader); off + 16 <= data.size(); off += 16)
+        {
+            if (data[off] == 'S')
+            {
+                CycleLogSample s;
+                memcpy(&s, &data[off], sizeof(s));
+                ms += s.dtMs;
+                wMg += s.dWeightMg;
+                tMc += s.dTempMc;
+                t.samples.push_back({ms, wMg / 1000.0f, tMc / 1000.0f, s.sensor, s.r, s.g, s.b, s.c});
+            }
+            else if (data[off] == 'E')
+            {
+                memcpy(&t.end, &data[off], sizeof(t.end));
+                t.hasEnd = true;
+            }
+        }
+        return !t.samples.empty();
+    }
+
+    bool readFile(const char *path, std::vector<uint8_t> &out)
+    {
+        FILE *f = fopen(path, "rb");
+        if (!f)
+            return false;
+        uint8_t buf[4096];
+        size_t n;
+        while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+            out.insert(out.end(), buf, buf + n);
+        fclose(f);
+        return true;
+    }
+
+    // A .bin is one trace; anything else is a Serial capture of #TLOG blocks
+    void load(const char *path, std::vector<Trace> &traces)
+    {
+        std::vector<uint8_t> raw;
+        if (!readFile(path, raw))
+        {
+            perror(path);
+            return;
+        }
+        const size_t len = strlen(path);
+        if (len > 4 && strcmp(path + len - 4, ".bin") == 0)
+        {
+            Trace t;
+            if (decode(path, raw, t))
+                traces.push_back(t);
+            return;
+        }
+
+        std::string text(raw.begin(), raw.end());
+        std::vector<uint8_t> block;
+        bool in = false;
+        unsigned long cycle = 0;
+        size_t pos = 0;
+        while (pos < text.size())
+        {
+            size_t eol = text.find('\n', pos);
+            if (eol == std::string::npos)
+                eol = text.size();
+            std::string line = text.substr(pos, eol - pos);
+            pos = eol + 1;
+            while (!line.empty() && (line.back() == '\r' || line.back() == ' '))
+                line.pop_back();
+
+            if (line.compare(0, 5, "#TLOG") == 0)
+            {
+                const size_t c = line.find("cycle=");
+                cycle = c == std::string::npos ? 0 : strtoul(line.c_str() + c + 6, nullptr, 10);
+                block.clear();
+                in = true;
+            }
+            else if (in && line == "#END")
+            {
+                Trace t;
+                if (decode(std::string(path) + "#" + std::to_string(cycle), block, t))
+                    traces.push_back(t);
+                in = false;
+            }
+            else if (in && line.size() % 2 == 0 && line.find_first_not_of("0123456789abcdefABCDEF") == std::string::npos)
+            {
+                for (size_t i = 0; i < line.size(); i += 2)
+                    block.push_back((uint8_t)strtoul(line.substr(i, 2).c_str(), nullptr, 16));
+            }
+        }
+    }
+
+    // ---------- Driving the fakes ----------
+
+    // Plays one trace onto the fakes. Time only moves forward within a
+    // trace, so every lookup walks on from the previous one.
+    struct Player
+    {
+        const Trace *t = nullptr;
+        float lagS = 0;
+        size_t at = 0, weightAtIdx = 0; // samples[i] <= time < samples[i + 1]
+        float tailGps = 0;       // weight slope over the last TAIL_S
+        std::vector<size_t> frames[3]; // per colour sensor: its samples
+        size_t frameAt[3] = {};
+
+        void load(const Trace &trace)
+        {
+            t = &trace;
+            at = weightAtIdx = 0;
+            for (int idx = 0; idx < 3; idx++)
+            {
+                frames[idx].clear();
+                frameAt[idx] = 0;
+            }
+            for (size_t i = 0; i < trace.samples.size(); i++)
+                if (trace.samples[i].sensor < 3)
+                    frames[trace.samples[i].sensor].push_back(i);
+
+            const Sample &last = trace.samples.back();
+            size_t i = trace.samples.size() - 1;
+            while (i > 0 && last.tMs - trace.samples[i - 1].tMs <= TAIL_S * 1000.0f)
+                i--;
+            const Sample &first = trace.samples[i];
+            tailGps = last.tMs > first.tMs ? (last.weightG - first.weightG) * 1000.0f / (last.tMs - first.tMs) : 0.0f;
+        }
+
+        // Linear in the samples around ms, walking cursor i forward;
+        // clamped before the first and after the last
+        float lerp(size_t &i, float ms, float Sample::*field) const
+        {
+            const std::vector<Sample> &s = t->samples;
+            while (i + 1 < s.size() && s[i + 1].tMs <= ms)
+                i++;
+            if (ms <= s[i].tMs || i + 1 >= s.size())
+                return s[i].*field;
+            const float a = (ms - s[i].tMs) / (float)(s[i + 1].tMs - s[i].tMs);
+            return s[i].*field + a * (s[i + 1].*field - s[i].*field);
+        }
+
+        // Weight runs on at its final slope past the end: the stop usually
+        // comes before the reading (and so the recording) reaches the target
+        float weightAt(float ms)
+        {
+            const Sample &last = t->samples.back();
+            if (ms > last.tMs)
+                return last.weightG + tailGps * (ms - last.tMs) / 1000.0f;
+            return lerp(weightAtIdx, ms, &Sample::weightG);
+        }
+
+        // Each sensor's frames come one sample in three: interpolate between
+        // them rather than hold, so the frames do not arrive as steps
+        void showColour(HostBoard &board, float ms)
+        {
+            const std::vector<Sample> &s = t->samples;
+            for (int idx = 0; idx < 3; idx++)
+            {
+                const std::vector<size_t> &f = frames[idx];
+                if (f.empty())
+                    continue;
+                size_t &k = frameAt[idx];
+                while (k + 1 < f.size() && s[f[k + 1]].tMs <= ms)
+                    k++;
+                const Sample &p = s[f[k]];
+                if (k + 1 >= f.size() || ms <= p.tMs)
+                {
+                    board.setColour(idx, p.r, p.g, p.b, p.c);
+                    continue;
+                }
+                const Sample &q = s[f[k + 1]];
+                const float a = (ms - p.tMs) / (float)(q.tMs - p.tMs);
+                board.setColour(idx, p.r + a * (q.r - p.r), p.g + a * (q.g - p.g), p.b + a * (q.b - p.b),
+                                p.c + a * (q.c - p.c));
+            }
+        }
+
+        void step(HostBoard &board, float traceMs)
+        {
+            board.setGrams(weightAt(traceMs + lagS * 1000.0f));
+            board.setTemps(t->h.startTempMc / 1000.0f, lerp(at, traceMs, &Sample::tempC));
+            showColour(board, traceMs);
+        }
+    };
+
+    ToastGuide parseGuide(const char *s, bool &ok)
+    {
+        ok = true;
+        if (strcmp(s, "temp") == 0)
+            return ToastGuide::Temp;
+        if (strcmp(s, "colour") == 0)
+            return ToastGuide::Colour;
+        ok = strcmp(s, "weight") == 0;
+        return ToastGuide::Weight;
+    }
+
+    const char *guideName(uint8_t g)
+    {
+        return g == (uint8_t)ToastGuide::Temp ? "temp" : g == (uint8_t)ToastGuide::Colour ? "colour" : "weight";
+    }
+
+    const char *reasonName(uint8_t r)
+    {
+        switch ((ToastStop)r)
+        {
+        case ToastStop::Weight:
+            return "weight";
+        case ToastStop::TempHold:
+            return "temp_hold";
+        case ToastStop::Colour:
+            return "colour";
+        default:
+            return "timeout";
+        }
+    }
+
+    void usage(const char *argv0)
+    {
+        fprintf(stderr, "usage: %s [-g temp|weight|colour] [-o replay.csv] trace.bin|capture.log ...\n", argv0);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    const char *csvPath = "replay.csv";
+    bool forceGuide = false;
+    ToastGuide guideOverride = ToastGuide::Weight;
+    std::vector<Trace> traces;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (i + 1 < argc && strcmp(argv[i], "-o") == 0)
+            csvPath = argv[++i];
+        else if (i + 1 < argc && strcmp(argv[i], "-g") == 0)
+        {
+            bool ok;
+            guideOverride = parseGuide(argv[++i], ok);
+            forceGuide = true;
+            if (!ok)
+            {
+                usage(argv[0]);
+                return 2;
+            }
+        }
+        else if (argv[i][0] == '-' && argv[i][1])
+        {
+            usage(argv[0]);
+            return 2;
+        }
+        else
+            load(argv[i], traces);
+    }
+    if (traces.empty())
+    {
+        fprintf(stderr, "no traces\n");
+        usage(argv[0]);
+        return 2;
+    }
+
+    FILE *csv = fopen(csvPath, "w");
+    if (!csv)
+    {
+        perror(csvPath);
+        return 1;
+    }
+    fprintf(csv, "trace,guide,rec_reason,new_reason,rec_stop_s,new_stop_s,d_stop_s,"
+                 "rec_stop_g,new_stop_g,d_stop_g,rec_brown,new_brown,extrapolated\n");
+
+    // One power-up for every trace, like the sweep
+    static HostBoard board;
+    board.powerOn();
+    hal::serialEcho(false);
+    Serial.begin(115200);
+    DisplayUI::begin();
+    DisplayUI::holdFlush(true); // nobody watches the panel
+    Input::begin();
+    sensorsBegin();
+    hostClickEvery(1000);
+    const float lagS = sensorsWeightLagS();
+
+    Player player;
+    player.lagS = lagS;
+    float traceZeroS = 0;  // virtual time of the trace's t = 0
+    float placeAtS = 0;
+    bool playing = false;
+    hal::addTickHook([&](uint64_t now) {
+        if (!playing)
+            return;
+        const float t = now / 1e6f;
+        if (t < placeAtS)
+            return;
+        player.step(board, (t - traceZeroS) * 1000.0f);
+    });
+
+    uint32_t sameReason = 0, extrapolated = 0, earlier = 0, later = 0;
+    double sumAbsDt = 0, maxAbsDt = 0, sumAbsDg = 0;
+    printf("%-40s %-6s %-9s %-9s %8s %8s %7s %8s\n", "trace", "guide", "rec", "new", "rec_s", "new_s", "d_s", "d_g");
+
+    for (const Trace &tr : traces)
+    {
+        const ToastGuide guide = forceGuide ? guideOverride : (ToastGuide)tr.h.guide;
+        const uint32_t recSettleMs = tr.hasEnd ? tr.end.settleMs : DEFAULT_SETTLE_MS;
+
+        // Empty jig at the slice's starting temperature
+        playing = false;
+        player.load(tr);
+        board.setGrams(0.0f);
+        board.setTemps(tr.h.startTempMc / 1000.0f, tr.h.startTempMc / 1000.0f);
+        player.showColour(board, 0.0f);
+        for (uint32_t t0 = millis(); millis() - t0 < (uint32_t)(EMPTY_S * 1000);)
+        {
+            sensorsUpdate();
+            delay(100);
+        }
+
+        // The slice goes in PLACE_AT_S into the flow at its settled weight
+        // (the streams clamp to their first sample until the trace's t = 0,
+        // which follows after the recorded settle time)
+        const float flowStartS = hal::nowUs() / 1e6f;
+        placeAtS = flowStartS + PLACE_AT_S;
+        traceZeroS = placeAtS + recSettleMs / 1000.0f;
+        playing = true;
+
+        const ToastResult r = ModeUI::runToastingFlow(guide);
+        playing = false;
+
+        // Both stops on the trace's own timeline (0 = recorded toasting start)
+        const float newStopS = (r.settleMs + (float)r.toastMs - recSettleMs) / 1000.0f;
+        const float recStopS = tr.hasEnd ? tr.end.toastMs / 1000.0f : tr.samples.back().tMs / 1000.0f;
+        const float recStopG = tr.hasEnd ? tr.end.stopWeightMg / 1000.0f : tr.samples.back().weightG;
+        const bool extrap = newStopS > tr.samples.back().tMs / 1000.0f + PAST_END_GRACE_S;
+        const float dS = newStopS - recStopS, dG = r.stopWeightG - recStopG;
+
+        const char *recReason = tr.hasEnd ? reasonName(tr.end.reason) : "cut_short";
+        const char *newReason = reasonName((uint8_t)r.reason);
+        fprintf(csv, "%s,%s,%s,%s,%.2f,%.2f,%.2f,%.3f,%.3f,%.3f,%d,%d,%d\n",
+                tr.name.c_str(), guideName((uint8_t)guide), recReason, newReason, recStopS, newStopS, dS,
+                recStopG, r.stopWeightG, dG, tr.hasEnd ? tr.end.brownIndex : 0, r.brownIndex, extrap);
+        printf("%-40s %-6s %-9s %-9s %8.1f %8.1f %+7.1f %+8.3f%s\n", tr.name.c_str(), guideName((uint8_t)guide),
+               recReason, newReason, recStopS, newStopS, dS, dG, extrap ? "  (past recording)" : "");
+
+        sameReason += strcmp(recReason, newReason) == 0;
+        extrapolated += extrap;
+        earlier += dS < -0.05f;
+        later += dS > 0.05f;
+        sumAbsDt += fabs(dS);
+        sumAbsDg += fabs(dG);
+        maxAbsDt = fmax(maxAbsDt, fabs(dS));
+    }
+    fclose(csv);
+
+    const size_t n = traces.size();
+    printf("\n%zu traces: same reason %u, stop earlier %u / later %u, |d_s| mean %.2f max %.2f, "
+           "|d_g| mean %.3f, %u past the recording; rows in %s\n",
+           n, sameReason, earlier, later, sumAbsDt / n, maxAbsDt, sumAbsDg / n, extrapolated, csvPath);
+    return 0;
+}
@@ -0,0 +1,132 @@
+// One complete ModeUI::runToastingFlow() on the fake board and virtual clock.
+// A scripted bread/toaster profile feeds the sensors; the run prints the
+// firmware's own Serial log plus virtual vs. host time.
+//
+//   pio run -e native && .pio/build/native/program [-q]
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <hal_native.h>
+
+#include <chrono>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "board.h"
+#include "DisplayUI.h"
+#include "Input.h"
+#include "ModeUI.h"
+#include "boot.h"
+#include "cycle_log.h"
+#include "sensorManager.h"
+
+namespace
+{
+    // Scripted profile (seconds from flow start)
+    constexpr float BREAD_AT_S = 3.0f;
+    constexpr float BREAD_G = 40.0f;
+    constexpr float LOSS_G = 7.0f;      // moisture that can leave
+    constexpr float LOSS_TAU_S = 110.0f;
+    constexpr float AMBIENT_C = 21.0f;
+    constexpr float SURFACE_MAX_C = 160.0f;
+    constexpr float HEAT_TAU_S = 35.0f;
+
+    void scriptStep(HostBoard &board, float t)
+    {
+        float grams = 0.0f, surface = AMBIENT_C;
+        if (t >= BREAD_AT_S)
+        {
+            float dt = t - BREAD_AT_S;
+            grams = BREAD_G - LOSS_G * (1.0f - expf(-dt / LOSS_TAU_S));
+            surface = SURFACE_MAX_C - (SURFACE_MAX_C - AMBIENT_C) * expf(-dt / HEAT_TAU_S);
+        }
+        board.setGrams(grams);
+        board.setTemps(AMBIENT_C, surface);
+
+        // pale crumb browning towards golden as the surface heats
+        float brown = surface > 110.0f ? fminf((surface - 110.0f) / 50.0f, 1.0f) : 0.0f;
+        for (int i = 0; i < 3; i++)
+            board.setColour(i, 900 - 250 * brown, 820 - 330 * brown, 700 - 380 * brown, 2400 - 900 * brown);
+    }
+
+    // Decode the cycle the flow just logged and report what it holds
+    void printCycleLog()
+    {
+        File dir = LittleFS.open("/tlog");
+        File f = dir ? dir.openNextFile() : File();
+        CycleLogHeader h;
+        if (!f || f.read((uint8_t *)&h, sizeof(h)) != sizeof(h) || memcmp(h.magic, "TLOG", 4) != 0)
+        {
+            printf("[HOST] log: no cycle file\n");
+            return;
+        }
+
+        int32_t weightMg = h.startWeightMg, tempMc = h.startTempMc;
+        uint32_t ms = 0, samples = 0;
+        CycleLogEnd end{};
+        uint8_t rec[16];
+        while (f.read(rec, sizeof(rec)) == sizeof(rec))
+        {
+            if (rec[0] == 'S')
+            {
+                CycleLogSample s;
+                memcpy(&s, rec, sizeof(s));
+                ms += s.dtMs;
+                weightMg += s.dWeightMg;
+                tempMc += s.dTempMc;
+                samples++;
+            }
+            else if (rec[0] == 'E')
+            {
+                memcpy(&end, rec, sizeof(end));
+            }
+        }
+        printf("[HOST] log: %s %u bytes, %lu samples over %.1f s, last %.3f g / %.2f C, end=%c reason %u\n",
+               f.path(), (unsigned)f.size(), (unsigned long)samples, ms / 1000.0,
+               weightMg / 1000.0, tempMc / 1000.0, end.tag ? end.tag : '-', (unsigned)end.reason);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    bool quiet = argc > 1 && strcmp(argv[1], "-q") == 0;
+
+    static HostBoard board;
+    board.powerOn();
+    hal::serialEcho(!quiet);
+    scriptStep(board, 0.0f);
+
+    // The firmware's own setup() path, boot report included
+    Serial.begin(115200);
+    Boot::run();
+
+    const uint64_t startUs = hal::nowUs();
+    hal::addTickHook([&](uint64_t now) {
+        scriptStep(board, (float)(now - startUs) / 1e6f);
+    });
+
+    // The flow ends on the "toast ready" screen waiting for a click; keep
+    // clicking once a second (nothing earlier in the flow reads the button).
+    hostClickEvery(1000);
+
+    const auto wallStart = std::chrono::steady_clock::now();
+    const ToastResult r = ModeUI::runToastingFlow(ToastGuide::Temp);
+    const auto wallEnd = std::chrono::steady_clock::now();
+
+    const double virtS = (double)(hal::nowUs() - startUs) / 1e6;
+    const double wallMs = std::chrono::duration<double, std::milli>(wallEnd - wallStart).count();
+    const SensorSnapshot s = getSensorSnapshot();
+    const hal::I2CCounters bus = hal::i2cCounters();
+
+    printf("\n[HOST] cycle: %.1f s virtual in %.1f ms host (x%.0f)\n",
+           virtS, wallMs, wallMs > 0 ? virtS * 1000.0 / wallMs : 0.0);
+    printf("[HOST] start weight %.2f g (settled %lu ms after placement)\n",
+           r.startWeightG, (unsigned long)r.settleMs);
+    printf("[HOST] final weight %.2f g, object %.1f C\n", s.weightG, s.tempC);
+    printf("[HOST] bus: %llu txns, %llu bytes, %llu nacks, %u panel data bytes\n",
+           (unsigned long long)bus.txns, (unsigned long long)bus.bytes,
+           (unsigned long long)bus.nacks, (unsigned)board.oled.dataBytes());
+    printCycleLog();
+    return 0;
+}
@@ -0,0 +1,263 @@
+#include "toaster_plant.h"
+
+#include <hal_native.h>
+#include <math.h>
+
+namespace
+{
+    constexpr float CP_J_PER_GK = 2.8f;     // moist crumb
+    constexpr float LATENT_EVAP_J_PER_G = 2260.0f;
+    constexpr float LATENT_FUSION_J_PER_G = 334.0f;
+    constexpr float FREEZABLE_FRAC = 0.8f;  // bound water never freezes
+    constexpr float SURFACE_FRAC = 0.15f;   // mass (and water) share of the crust node
+    constexpr float CORE_COND_W_PER_K = 0.60f;
+    constexpr float SURFACE_LOSS_W_PER_K = 0.30f; // convection + re-radiation
+    constexpr float SURFACE_EVAP_G_PER_S = 0.15f;
+    constexpr float CORE_EVAP_G_PER_S = 0.05f;    // steam venting through the crust
+    constexpr float REF_MASS_G = 30.0f;
+
+    // Maillard: rate doubles every ~10 K around 150 C, index 1.0 ~ golden
+    constexpr float BROWN_EA_OVER_R = 12100.0f;
+    constexpr float BROWN_PREFACTOR = 2.3e10f;
+    constexpr float ABSORB[4] = {0.30f, 0.55f, 0.85f, 0.55f}; // R, G, B, C per index unit
+    constexpr float JIG_SCENE[4] = {120.0f, 110.0f, 100.0f, 330.0f};
+
+    constexpr uint32_t SENSOR_EVERY = 10;   // sensor refresh / history: every 100 ms
+
+    const BreadType BREADS[] = {
+        {"white", 30.0f, 0.38f, 0.40f, 1.0f, {900, 820, 700, 2400}},
+        {"wholemeal", 38.0f, 0.40f, 0.35f, 0.9f, {760, 640, 500, 1900}},
+        {"sourdough", 45.0f, 0.42f, 0.32f, 0.8f, {880, 800, 680, 2350}},
+        {"brioche", 32.0f, 0.30f, 0.45f, 1.8f, {940, 830, 600, 2450}},
+        {"rye", 35.0f, 0.45f, 0.26f, 0.7f, {640, 540, 430, 1600}},
+        {"bagel", 48.0f, 0.33f, 0.33f, 1.2f, {880, 780, 620, 2300}},
+    };
+
+    float smoothstep(float e0, float e1, float x)
+    {
+        float t = (x - e0) / (e1 - e0);
+        if (t <= 0.0f)
+            return 0.0f;
+        if (t >= 1.0f)
+            return 1.0f;
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    float toK(float c) { return c + 273.15f; }
+}
+
+const BreadType *breadTypes(int &count)
+{
+    count = (int)(sizeof(BREADS) / sizeof(BREADS[0]));
+    return BREADS;
+}
+
+const char *startConditionName(StartCondition c)
+{
+    switch (c)
+    {
+    case StartCondition::Frozen:
+        return "frozen";
+    case StartCondition::Fridge:
+        return "fridge";
+    default:
+        return "room";
+    }
+}
+
+ToasterPlant::ToasterPlant(HostBoard &board, const Params &p) : _board(board), _p(p) {}
+
+ToasterPlant::~ToasterPlant()
+{
+    detach();
+}
+
+void ToasterPlant::start(const BreadSpec &bread, uint32_t seed)
+{
+    detach();
+    _bread = bread;
+    _rng = seed ? seed : 1;
+    _t0Us = hal::nowUs();
+    _nextStepUs = _t0Us;
+    _step = 0;
+    _history.clear();
+
+    const float m = bread.massG;
+    _surfCapJK = SURFACE_FRAC * m * CP_J_PER_GK;
+    _coreCapJK = (1.0f - SURFACE_FRAC) * m * CP_J_PER_GK;
+    _waterG = m * bread.type->moistureFrac;
+    _surfWaterG = _surfWater0G = _waterG * SURFACE_FRAC;
+    _coreReachG = _coreReach0G = (_waterG - _surfWaterG) * bread.type->reachableFrac;
+
+    float iceG = bread.startC < 0.0f ? _waterG * FREEZABLE_FRAC : 0.0f;
+    _surfIceG = iceG * SURFACE_FRAC;
+    _coreIceG = iceG - _surfIceG;
+
+    for (int i = 0; i < 3; i++)
+        _sensorRate[i] = fmaxf(0.5f, 1.0f + _p.sensorSpread * gauss());
+
+    _s = State{};
+    _s.elementC = _p.ambientC;
+    _s.surfaceC = bread.startC;
+    _s.coreC = bread.startC;
+    _s.massG = m;
+    _ambientDieC = _p.ambientC;
+    _mlxHeldC = _p.ambientC;
+
+    publish();
+    _hook = hal::addTickHook([this](uint64_t now) { tick(now); });
+}
+
+void ToasterPlant::detach()
+{
+    if (_hook >= 0)
+        hal::removeTickHook(_hook);
+    _hook = -1;
+}
+
+ToasterPlant::State ToasterPlant::stateAt(float tS) const
+{
+    if (_history.empty())
+        return _s;
+    long i = lroundf(tS / (SENSOR_EVERY * STEP_US / 1e6f));
+    if (i < 0)
+        i = 0;
+    if (i >= (long)_history.size())
+        i = (long)_history.size() - 1;
+    return _history[i];
+}
+
+void ToasterPlant::tick(uint64_t nowUs)
+{
+    while (nowUs >= _nextStepUs + STEP_US)
+    {
+        _nextStepUs += STEP_US;
+        step(STEP_US / 1e6f);
+        if (++_step % SENSOR_EVERY == 0)
+            publish();
+    }
+}
+
+void ToasterPlant::heatNode(float &tempC, float &iceG, float capJK, float joules)
+{
+    // Ice pins the node at 0 C until it has melted
+    if (iceG > 0.0f && joules > 0.0f)
+    {
+        float toZero = -tempC * capJK;
+        if (toZero > 0.0f)
+        {
+            if (joules <= toZero)
+            {
+                tempC += joules / capJK;
+                return;
+            }
+            joules -= toZero;
+            tempC = 0.0f;
+        }
+        float melt = fminf(iceG, joules / LATENT_FUSION_J_PER_G);
+        iceG -= melt;
+        joules -= melt * LATENT_FUSION_J_PER_G;
+    }
+    tempC += joules / capJK;
+}
+
+void ToasterPlant::step(float dt)
+{
+    _s.tS = (float)(_nextStepUs - _t0Us) / 1e6f;
+    const float sinceOn = _s.tS - _p.placeAtS;
+    if (sinceOn < 0.0f)
+        return; // nothing on the scale yet, element off
+
+    const float amb = _p.ambientC;
+    _s.elementC = amb + (_p.elementMaxC - amb) * (1.0f - expf(-sinceOn / _p.elementTauS));
+
+    // Linearised radiant coupling, scaled with face area (~ mass^0.5 for
+    // slices cut to the same outline)
+    const float area = sqrtf(_bread.massG / REF_MASS_G);
+    const float qIn = _p.couplingWPerK * area * (_s.elementC - _s.surfaceC);
+    const float qCore = CORE_COND_W_PER_K * area * (_s.surfaceC - _s.coreC);
+    const float qLoss = SURFACE_LOSS_W_PER_K * area * (_s.surfaceC - amb);
+
+    // Evaporation needs heat (vapour pressure climbs steeply towards 100 C)
+    // and water left in the node. The crust dries first and is then free to
+    // climb past 100 C; the core keeps venting steam through it.
+    float evapS = 0.0f, evapC = 0.0f;
+    if (_surfIceG <= 0.0f && _surfWater0G > 0.0f)
+        evapS = SURFACE_EVAP_G_PER_S * area * (_surfWaterG / _surfWater0G) * smoothstep(60.0f, 102.0f, _s.surfaceC);
+    if (_coreIceG <= 0.0f && _coreReach0G > 0.0f)
+        evapC = CORE_EVAP_G_PER_S * area * (_coreReachG / _coreReach0G) * smoothstep(40.0f, 90.0f, _s.coreC);
+    evapS = fminf(evapS, _surfWaterG / dt);
+    evapC = fminf(evapC, _coreReachG / dt);
+    _surfWaterG -= evapS * dt;
+    _coreReachG -= evapC * dt;
+    _s.evapGps = evapS + evapC;
+    _s.lostG += _s.evapGps * dt;
+    _s.massG = _bread.massG - _s.lostG;
+
+    heatNode(_s.surfaceC, _surfIceG, _surfCapJK, (qIn - qCore - qLoss - evapS * LATENT_EVAP_J_PER_G) * dt);
+    heatNode(_s.coreC, _coreIceG, _coreCapJK, (qCore - evapC * LATENT_EVAP_J_PER_G) * dt);
+
+    const float k = BROWN_PREFACTOR * expf(-BROWN_EA_OVER_R / toK(_s.surfaceC)) * _bread.type->browningRate;
+    for (int i = 0; i < 3; i++)
+    {
+        // each sensor's patch runs a little hotter or cooler
+        _s.browning[i] += k * _sensorRate[i] * dt;
+    }
+
+    // MLX die warms with the toaster body
+    _ambientDieC = amb + 6.0f * (1.0f - expf(-sinceOn / 150.0f));
+}
+
+void ToasterPlant::publish()
+{
+    const bool placed = _s.tS >= _p.placeAtS;
+    const float amb = _p.ambientC;
+    const float heat = (_s.elementC - amb) / (_p.elementMaxC - amb);
+
+    // Load cell: bread mass, hot-air lift, steam buffeting
+    float grams = placed ? _s.massG : 0.0f;
+    grams -= _p.liftG * heat;
+    _board.setGrams(grams);
+    _board.nau.setNoise((_p.scaleNoiseG + _p.steamJitterG * _s.evapGps) * HostBoard::SCALE_COUNTS_PER_G);
+
+    // MLX90614: grey body plus reflected toaster walls, sample-and-hold
+    const float wallC = amb + 0.25f * (_s.elementC - amb);
+    float objC = wallC;
+    if (placed)
+    {
+        const float e = _p.emissivity;
+        const float ts = toK(_s.surfaceC), tw = toK(wallC);
+        objC = powf(e * ts * ts * ts * ts + (1.0f - e) * tw * tw * tw * tw, 0.25f) - 273.15f;
+    }
+    _mlxHeldC = objC + _p.mlxNoiseC * gauss();
+    _s.mlxObjectC = _mlxHeldC;
+    _board.setTemps(_ambientDieC, _mlxHeldC);
+
+    // TCS34725s: crumb darkening per browning index, shot noise
+    for (int i = 0; i < 3; i++)
+    {
+        float ch[4];
+        for (int c = 0; c < 4; c++)
+        {
+            float base = placed ? _bread.type->crumb[c] * expf(-ABSORB[c] * _s.browning[i]) : JIG_SCENE[c];
+            ch[c] = fmaxf(0.0f, base * (1.0f + _p.tcsNoise * gauss()));
+        }
+        _board.setColour(i, ch[0], ch[1], ch[2], ch[3]);
+    }
+
+    _history.push_back(_s);
+}
+
+float ToasterPlant::uniform()
+{
+    _rng ^= _rng << 13;
+    _rng ^= _rng >> 17;
+    _rng ^= _rng << 5;
+    return (_rng >> 8) * (1.0f / 16777216.0f);
+}
+
+float ToasterPlant::gauss()
+{
+    float u1 = fmaxf(uniform(), 1e-7f), u2 = uniform();
+    return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+// Physics-based stand-in for the toaster and the slice in it, driving the
+// fake sensors on a HostBoard from a hal tick hook:
+//
+//   element    first-order warm-up to its running temperature
+//   slice      two thermal nodes (surface layer, core) with conduction,
+//              ice melting for frozen bread and evaporative cooling that
+//              holds the surface near 100 C while it is still wet
+//   moisture   the crust's water flashes off first, then steam from the
+//              crumb vents through it; what leaves is what the load cell loses
+//   browning   Arrhenius-rate Maillard index per colour sensor (each sees a
+//              slightly hotter or cooler patch), mapped to RGBC reflectance
+//
+// Sensors see it the way the real parts would: the MLX90614 reads a
+// grey-body mix of surface and toaster walls, refreshed every 100 ms with
+// noise; the scale picks up convection lift and steam jitter; the TCS34725s
+// get shot noise. Nothing here knows about the firmware's stop logic.
+
+#include <stdint.h>
+#include <vector>
+
+#include "board.h"
+
+enum class StartCondition : uint8_t
+{
+    Frozen,
+    Fridge,
+    Room
+};
+
+struct BreadType
+{
+    const char *name;
+    float massG;          // nominal slice mass
+    float moistureFrac;   // water / total mass
+    float reachableFrac;  // share of the crumb's water that can vent in one cycle
+    float browningRate;   // Maillard multiplier (sugar, milk, egg)
+    float crumb[4];       // R, G, B, C seen at 614 ms / 1x before toasting
+};
+
+// Built-in bread library (white, wholemeal, sourdough, brioche, rye, bagel)
+const BreadType *breadTypes(int &count);
+
+struct BreadSpec
+{
+    const BreadType *type;
+    float massG;
+    StartCondition start;
+    float startC;         // slice temperature when it goes in
+};
+
+class ToasterPlant
+{
+public:
+    static constexpr uint32_t STEP_US = 10000; // integration step
+
+    struct Params
+    {
+        float ambientC = 21.0f;
+        float elementMaxC = 640.0f;
+        float elementTauS = 18.0f;
+        float couplingWPerK = 0.20f;    // radiant element -> surface, per 30 g slice
+        float placeAtS = 3.0f;          // bread on the scale, lever down
+        float emissivity = 0.95f;       // bread surface, as seen by the MLX
+        float mlxNoiseC = 0.15f;
+        float scaleNoiseG = 0.03f;
+        float steamJitterG = 1.5f;      // extra rms per g/s evaporated
+        float liftG = 0.35f;            // convection lift at full element temperature
+        float tcsNoise = 0.006f;        // relative, per reading
+        float sensorSpread = 0.08f;     // browning-rate spread across the three sensors
+    };
+
+    // Plant state at one instant (also kept as 100 ms history)
+    struct State
+    {
+        float tS;
+        float elementC;
+        float surfaceC;
+        float coreC;
+        float massG;
+        float lostG;
+        float evapGps;
+        float browning[3];
+        float mlxObjectC;
+    };
+
+    explicit ToasterPlant(HostBoard &board) : ToasterPlant(board, Params()) {}
+    ToasterPlant(HostBoard &board, const Params &p);
+    ~ToasterPlant();
+
+    // Load a new slice and start the clock at the current virtual time.
+    // Installs the tick hook; the plant then runs until detach().
+    void start(const BreadSpec &bread, uint32_t seed);
+    void detach();
+
+    // Takes effect at the next start()
+    void setParams(const Params &p) { _p = p; }
+
+    const State &state() const { return _s; }
+    // State at virtual time tS since start() (nearest 100 ms sample)
+    State stateAt(float tS) const;
+    float startedAtS() const { return _t0Us / 1e6f; }
+
+private:
+    HostBoard &_board;
+    Params _p;
+    BreadSpec _bread{};
+    State _s{};
+    std::vector<State> _history;
+
+    int _hook = -1;
+    uint64_t _t0Us = 0;
+    uint64_t _nextStepUs = 0;
+    uint32_t _step = 0;
+    uint32_t _rng = 1;
+
+    // thermal nodes
+    float _surfCapJK = 0, _coreCapJK = 0;
+    float _surfIceG = 0, _coreIceG = 0;
+    float _waterG = 0;
+    float _surfWaterG = 0, _surfWater0G = 0;
+    float _coreReachG = 0, _coreReach0G = 0;
+    float _sensorRate[3] = {1, 1, 1};
+    float _mlxHeldC = 0, _ambientDieC = 0;
+
+    void tick(uint64_t nowUs);
+    void step(float dt);
+    void heatNode(float &tempC, float &iceG, float capJK, float joules);
+    void publish();
+
+    float uniform();
+    float gauss();
+};
+
+const char *startConditionName(StartCondition c);
@@ -0,0 +1,8 @@
+#pragma once
+
+// Adafruit_GFX.h includes the BusIO headers unconditionally; the host build
+// drops BusIO (lib_ignore) and none of the GFX code we use needs it.
+
+#include <Wire.h>
+
+class Adafruit_I2CDevice;
@@ -0,0 +1,34 @@
+#include "Adafruit_MLX90614.h"
+
+bool Adafruit_MLX90614::begin(uint8_t addr, TwoWire *wire)
+{
+    _addr = addr;
+    _wire = wire;
+    _wire->beginTransmission(_addr);
+    return _wire->endTransmission() == 0;
+}
+
+uint16_t Adafruit_MLX90614::read16(uint8_t reg)
+{
+    _wire->beginTransmission(_addr);
+    _wire->write(reg);
+    if (_wire->endTransmission(false) != 0)
+        return 0;
+    if (_wire->requestFrom(_addr, (uint8_t)3) != 3)
+        return 0;
+    uint16_t lo = (uint16_t)_wire->read();
+    uint16_t hi = (uint16_t)_wire->read();
+    (void)_wire->read(); // PEC
+    return (uint16_t)(lo | (hi << 8));
+}
+
+double Adafruit_MLX90614::readTemp(uint8_t reg)
+{
+    double temp = read16(reg);
+    temp *= .02;
+    temp -= 273.15;
+    return temp;
+}
+
+double Adafruit_MLX90614::readObjectTempC() { return readTemp(MLX90614_TOBJ1); }
+double Adafruit_MLX90614::readAmbientTempC() { return readTemp(MLX90614_TA); }
@@ -0,0 +1,27 @@
+#pragma once
+
+// Host build of the Adafruit MLX90614 driver over the fake Wire bus.
+
+#include <Wire.h>
+
+#define MLX90614_I2CADDR 0x5A
+#define MLX90614_TA 0x06
+#define MLX90614_TOBJ1 0x07
+
+class Adafruit_MLX90614
+{
+public:
+    bool begin(uint8_t addr = MLX90614_I2CADDR, TwoWire *wire = &Wire);
+
+    double readObjectTempC();
+    double readAmbientTempC();
+    double readObjectTempF() { return readObjectTempC() * 9 / 5 + 32; }
+    double readAmbientTempF() { return readAmbientTempC() * 9 / 5 + 32; }
+
+private:
+    TwoWire *_wire = &Wire;
+    uint8_t _addr = MLX90614_I2CADDR;
+
+    uint16_t read16(uint8_t reg);
+    double readTemp(uint8_t reg);
+};
@@ -0,0 +1,7 @@
+#pragma once
+
+// See Adafruit_I2CDevice.h
+
+#include <SPI.h>
+
+class Adafruit_SPIDevice;
@@ -0,0 +1,135 @@
+#include "Adafruit_SSD1306.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+Adafruit_SSD1306::Adafruit_SSD1306(uint8_t w, uint8_t h, TwoWire *twi, int8_t,
+                                   uint32_t clkDuring, uint32_t clkAfter)
+    : Adafruit_GFX(w, h), wire(twi), wireClk(clkDuring), restoreClk(clkAfter) {}
+
+Adafruit_SSD1306::~Adafruit_SSD1306()
+{
+    free(buffer);
+}
+
+void Adafruit_SSD1306::commandList(const uint8_t *c, uint8_t n)
+{
+    wire->beginTransmission(i2caddr);
+    wire->write((uint8_t)0x00);
+    while (n--)
+        wire->write(*c++);
+    wire->endTransmission();
+}
+
+void Adafruit_SSD1306::ssd1306_command(uint8_t c)
+{
+    commandList(&c, 1);
+}
+
+bool Adafruit_SSD1306::begin(uint8_t, uint8_t addr, bool, bool periphBegin)
+{
+    if (!buffer && !(buffer = (uint8_t *)malloc(WIDTH * ((HEIGHT + 7) / 8))))
+        return false;
+    clearDisplay();
+    i2caddr = addr ? addr : 0x3C;
+    if (periphBegin)
+        wire->begin();
+
+    wire->setClock(wireClk);
+    static const uint8_t init[] = {
+        SSD1306_DISPLAYOFF, SSD1306_SETDISPLAYCLOCKDIV, 0x80,
+        SSD1306_SETMULTIPLEX, (uint8_t)(HEIGHT - 1), SSD1306_SETDISPLAYOFFSET, 0x00,
+        SSD1306_SETSTARTLINE | 0x0, SSD1306_CHARGEPUMP, 0x14,
+        SSD1306_MEMORYMODE, 0x00, SSD1306_SEGREMAP | 0x1, SSD1306_COMSCANDEC,
+        SSD1306_SETCOMPINS, 0x12, SSD1306_SETCONTRAST, 0xCF,
+        SSD1306_SETPRECHARGE, 0xF1, SSD1306_SETVCOMDETECT, 0x40,
+        SSD1306_DISPLAYALLON_RESUME, SSD1306_NORMALDISPLAY,
+        SSD1306_DEACTIVATE_SCROLL, SSD1306_DISPLAYON};
+    commandList(init, sizeof(init));
+    wire->setClock(restoreClk);
+    return true;
+}
+
+void Adafruit_SSD1306::display()
+{
+    wire->setClock(wireClk);
+    static const uint8_t window[] = {SSD1306_PAGEADDR, 0, 0xFF, SSD1306_COLUMNADDR, 0};
+    commandList(window, sizeof(window));
+    ssd1306_command((uint8_t)(WIDTH - 1));
+
+    const uint16_t count = WIDTH * ((HEIGHT + 7) / 8);
+    const uint8_t *ptr = buffer;
+    uint16_t left = count;
+    while (left)
+    {
+        wire->beginTransmission(i2caddr);
+        wire->write((uint8_t)0x40);
+        uint16_t n = 1;
+        while (left && n < I2C_BUFFER_LENGTH)
+        {
+            wire->write(*ptr++);
+            left--;
+            n++;
+        }
+        wire->endTransmission();
+    }
+    wire->setClock(restoreClk);
+}
+
+void Adafruit_SSD1306::clearDisplay()
+{
+    memset(buffer, 0, WIDTH * ((HEIGHT + 7) / 8));
+}
+
+void Adafruit_SSD1306::invertDisplay(bool i)
+{
+    ssd1306_command(i ? SSD1306_INVERTDISPLAY : SSD1306_NORMALDISPLAY);
+}
+
+void Adafruit_SSD1306::dim(bool dim)
+{
+    const uint8_t c[] = {SSD1306_SETCONTRAST, (uint8_t)(dim ? 0 : 0xCF)};
+    commandList(c, sizeof(c));
+}
+
+void Adafruit_SSD1306::drawPixel(int16_t x, int16_t y, uint16_t color)
+{
+    if (x < 0 || x >= width() || y < 0 || y >= height())
+        return;
+    switch (getRotation())
+    {
+    case 1:
+        std::swap(x, y);
+        x = WIDTH - x - 1;
+        break;
+    case 2:
+        x = WIDTH - x - 1;
+        y = HEIGHT - y - 1;
+        break;
+    case 3:
+        std::swap(x, y);
+        y = HEIGHT - y - 1;
+        break;
+    }
+    uint8_t &b = buffer[x + (y / 8) * WIDTH];
+    const uint8_t bit = (uint8_t)(1 << (y & 7));
+    switch (color)
+    {
+    case SSD1306_WHITE:
+        b |= bit;
+        break;
+    case SSD1306_BLACK:
+        b &= (uint8_t)~bit;
+        break;
+    case SSD1306_INVERSE:
+        b ^= bit;
+        break;
+    }
+}
+
+bool Adafruit_SSD1306::getPixel(int16_t x, int16_t y)
+{
+    if (x < 0 || x >= width() || y < 0 || y >= height())
+        return false;
+    return buffer[x + (y / 8) * WIDTH] & (1 << (y & 7));
+}
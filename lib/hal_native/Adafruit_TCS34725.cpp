@@ -0,0 +1,101 @@
+#include "Adafruit_TCS34725.h"
+
+Adafruit_TCS34725::Adafruit_TCS34725(uint8_t it, tcs34725Gain_t gain)
+    : _integrationTime(it), _gain(gain) {}
+
+bool Adafruit_TCS34725::begin(uint8_t addr, TwoWire *theWire)
+{
+    _addr = addr;
+    _wire = theWire;
+    return init();
+}
+
+bool Adafruit_TCS34725::init()
+{
+    uint8_t x = read8(TCS34725_ID);
+    if (x != 0x4D && x != 0x44 && x != 0x10)
+        return false;
+    _initialised = true;
+    setIntegrationTime(_integrationTime);
+    setGain(_gain);
+    enable();
+    return true;
+}
+
+void Adafruit_TCS34725::write8(uint8_t reg, uint8_t value)
+{
+    _wire->beginTransmission(_addr);
+    _wire->write((uint8_t)(TCS34725_COMMAND_BIT | reg));
+    _wire->write(value);
+    _wire->endTransmission();
+}
+
+uint8_t Adafruit_TCS34725::read8(uint8_t reg)
+{
+    _wire->beginTransmission(_addr);
+    _wire->write((uint8_t)(TCS34725_COMMAND_BIT | reg));
+    if (_wire->endTransmission() != 0)
+        return 0;
+    if (_wire->requestFrom(_addr, (uint8_t)1) != 1)
+        return 0;
+    return (uint8_t)_wire->read();
+}
+
+uint16_t Adafruit_TCS34725::read16(uint8_t reg)
+{
+    _wire->beginTransmission(_addr);
+    _wire->write((uint8_t)(TCS34725_COMMAND_BIT | reg));
+    if (_wire->endTransmission() != 0)
+        return 0;
+    if (_wire->requestFrom(_addr, (uint8_t)2) != 2)
+        return 0;
+    uint16_t lo = (uint16_t)_wire->read();
+    uint16_t hi = (uint16_t)_wire->read();
+    return (uint16_t)(lo | (hi << 8));
+}
+
+void Adafruit_TCS34725::waitIntegration()
+{
+    delay((256 - _integrationTime) * 12 / 5 + 1);
+}
+
+void Adafruit_TCS34725::enable()
+{
+    write8(TCS34725_ENABLE, TCS34725_ENABLE_PON);
+    delay(3);
+    write8(TCS34725_ENABLE, TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN);
+    waitIntegration();
+}
+
+void Adafruit_TCS34725::disable()
+{
+    uint8_t reg = read8(TCS34725_ENABLE);
+    write8(TCS34725_ENABLE, reg & (uint8_t)~(TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN));
+}
+
+void Adafruit_TCS34725::setIntegrationTime(uint8_t it)
+{
+    if (!_initialised)
+        begin(_addr, _wire);
+    write8(TCS34725_ATIME, it);
+    _integrationTime = it;
+}
+
+void Adafruit_TCS34725::setGain(tcs34725Gain_t gain)
+{
+    if (!_initialised)
+        begin(_addr, _wire);
+    write8(TCS34725_CONTROL, gain);
+    _gain = gain;
+}
+
+void Adafruit_TCS34725::getRawData(uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c)
+{
+    if (!_initialised)
+        begin(_addr, _wire);
+    *c = read16(TCS34725_CDATAL);
+    *r = read16(TCS34725_RDATAL);
+    *g = read16(TCS34725_GDATAL);
+    *b = read16(TCS34725_BDATAL);
+    waitIntegration();
+}
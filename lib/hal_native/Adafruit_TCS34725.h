@@ -0,0 +1,78 @@
+#pragma once
+
+// Host build of the Adafruit TCS34725 driver (register names, integration
+// and gain constants, blocking getRawData()) talking over the fake Wire bus.
+
+#include <Wire.h>
+
+#define TCS34725_ADDRESS (0x29)
+#define TCS34725_COMMAND_BIT (0x80)
+#define TCS34725_ENABLE (0x00)
+#define TCS34725_ENABLE_AIEN (0x10)
+#define TCS34725_ENABLE_WEN (0x08)
+#define TCS34725_ENABLE_AEN (0x02)
+#define TCS34725_ENABLE_PON (0x01)
+#define TCS34725_ATIME (0x01)
+#define TCS34725_WTIME (0x03)
+#define TCS34725_CONTROL (0x0F)
+#define TCS34725_ID (0x12)
+#define TCS34725_STATUS (0x13)
+#define TCS34725_STATUS_AINT (0x10)
+#define TCS34725_STATUS_AVALID (0x01)
+#define TCS34725_CDATAL (0x14)
+#define TCS34725_CDATAH (0x15)
+#define TCS34725_RDATAL (0x16)
+#define TCS34725_RDATAH (0x17)
+#define TCS34725_GDATAL (0x18)
+#define TCS34725_GDATAH (0x19)
+#define TCS34725_BDATAL (0x1A)
+#define TCS34725_BDATAH (0x1B)
+
+#define TCS34725_INTEGRATIONTIME_2_4MS (0xFF)
+#define TCS34725_INTEGRATIONTIME_24MS (0xF6)
+#define TCS34725_INTEGRATIONTIME_50MS (0xEB)
+#define TCS34725_INTEGRATIONTIME_101MS (0xD6)
+#define TCS34725_INTEGRATIONTIME_154MS (0xC0)
+#define TCS34725_INTEGRATIONTIME_240MS (0x9C)
+#define TCS34725_INTEGRATIONTIME_300MS (0x83)
+#define TCS34725_INTEGRATIONTIME_401MS (0x59)
+#define TCS34725_INTEGRATIONTIME_499MS (0x30)
+#define TCS34725_INTEGRATIONTIME_600MS (0x06)
+#define TCS34725_INTEGRATIONTIME_614MS (0x00)
+
+typedef enum
+{
+    TCS34725_GAIN_1X = 0x00,
+    TCS34725_GAIN_4X = 0x01,
+    TCS34725_GAIN_16X = 0x02,
+    TCS34725_GAIN_60X = 0x03
+} tcs34725Gain_t;
+
+class Adafruit_TCS34725
+{
+public:
+    Adafruit_TCS34725(uint8_t it = TCS34725_INTEGRATIONTIME_2_4MS,
+                      tcs34725Gain_t gain = TCS34725_GAIN_1X);
+
+    bool begin(uint8_t addr = TCS34725_ADDRESS, TwoWire *theWire = &Wire);
+    bool init();
+
+    void setIntegrationTime(uint8_t it);
+    void setGain(tcs34725Gain_t gain);
+    void getRawData(uint16_t *r, uint16_t *g, uint16_t *b, uint16_t *c);
+    void enable();
+    void disable();
+
+    void write8(uint8_t reg, uint8_t value);
+    uint8_t read8(uint8_t reg);
+    uint16_t read16(uint8_t reg);
+
+private:
+    TwoWire *_wire = &Wire;
+    uint8_t _addr = TCS34725_ADDRESS;
+    bool _initialised = false;
+    uint8_t _integrationTime;
+    tcs34725Gain_t _gain;
+
+    void waitIntegration();
+};
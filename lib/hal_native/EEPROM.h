@@ -0,0 +1,52 @@
+#pragma once
+
+// RAM-backed EEPROM emulation. After begin(size) reads and writes only land
+// inside that size (ESP32 contract); without begin() the whole array is
+// usable, as on AVR, since the firmware only calls begin() on ESP32.
+
+#include "Arduino.h"
+
+class EEPROMClass
+{
+public:
+    EEPROMClass() { wipe(); }
+
+    bool begin(size_t size);
+    void end() {}
+
+    uint8_t read(int address);
+    void write(int address, uint8_t value);
+    bool commit();
+    size_t length() const { return _size; }
+
+    template <typename T>
+    T &get(int address, T &t)
+    {
+        uint8_t *p = (uint8_t *)&t;
+        for (size_t i = 0; i < sizeof(T); i++)
+            p[i] = read(address + (int)i);
+        return t;
+    }
+
+    template <typename T>
+    const T &put(int address, const T &t)
+    {
+        const uint8_t *p = (const uint8_t *)&t;
+        for (size_t i = 0; i < sizeof(T); i++)
+            write(address + (int)i, p[i]);
+        return t;
+    }
+
+    // host only: commits so far and the raw backing store
+    uint32_t commits() const { return _commits; }
+    uint8_t *data() { return _flash; }
+    void wipe();
+
+private:
+    static constexpr size_t FLASH_SIZE = 4096;
+    uint8_t _flash[FLASH_SIZE];
+    size_t _size = 0;
+    uint32_t _commits = 0;
+};
+
+extern EEPROMClass EEPROM;
@@ -0,0 +1,93 @@
+#pragma once
+
+// Host build of the arduino-esp32 fs::FS / fs::File surface, backed by RAM.
+// Only what the firmware uses: open/exists/remove/mkdir, sequential
+// read/write/append, size, flush and directory iteration.
+
+#include "Arduino.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#define FILE_READ "r"
+#define FILE_WRITE "w"
+#define FILE_APPEND "a"
+
+namespace fs
+{
+    struct FsNode
+    {
+        bool dir = false;
+        std::vector<uint8_t> data;
+    };
+
+    class FsImpl;
+
+    class File
+    {
+    public:
+        File() = default;
+
+        explicit operator bool() const { return _impl != nullptr; }
+
+        size_t write(uint8_t b) { return write(&b, 1); }
+        size_t write(const uint8_t *buf, size_t size);
+        int read();
+        size_t read(uint8_t *buf, size_t size);
+        int available();
+        size_t size() const;
+        size_t position() const { return _pos; }
+        bool seek(uint32_t pos);
+        void flush() {}
+        void close();
+
+        const char *name() const;
+        const char *path() const { return _path.c_str(); }
+        bool isDirectory() const;
+        File openNextFile(const char *mode = FILE_READ);
+        void rewindDirectory() { _dirPos = 0; }
+
+    private:
+        friend class FsImpl;
+
+        FsImpl *_impl = nullptr;
+        std::string _path;
+        std::shared_ptr<FsNode> _node;
+        size_t _pos = 0;
+        bool _writable = false;
+        size_t _dirPos = 0;
+    };
+
+    class FsImpl
+    {
+    public:
+        File open(const char *path, const char *mode = FILE_READ, bool create = false);
+        bool exists(const char *path) const;
+        bool remove(const char *path);
+        bool mkdir(const char *path);
+        bool rmdir(const char *path);
+
+        size_t totalBytes() const { return _capacity; }
+        size_t usedBytes() const;
+
+        // host only: drop every file (hal::reset()) and set the capacity
+        void wipe();
+        void setCapacity(size_t bytes) { _capacity = bytes; }
+
+    protected:
+        friend class File;
+
+        std::map<std::string, std::shared_ptr<FsNode>> _nodes;
+        size_t _capacity = 1441792; // default.csv spiffs partition
+        bool _mounted = false;
+    };
+
+    class FS : public FsImpl
+    {
+    };
+} // namespace fs
+
+using fs::File;
+using fs::FS;
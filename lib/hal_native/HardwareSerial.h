@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Stream.h"
+
+// Output goes to stdout (see hal::serialEcho) and a capture buffer; input
+// comes from hal::serialInject().
+class HardwareSerial : public Stream
+{
+public:
+    void begin(unsigned long baud) { (void)baud; }
+    void end() {}
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+    explicit operator bool() const { return true; }
+};
+
+extern HardwareSerial Serial;
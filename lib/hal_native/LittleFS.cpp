@@ -0,0 +1,194 @@
+#include "LittleFS.h"
+
+#include <string.h>
+
+fs::LittleFSFS LittleFS;
+
+namespace
+{
+    std::string normalise(const char *path)
+    {
+        std::string p = path ? path : "";
+        if (p.empty() || p[0] != '/')
+            p.insert(p.begin(), '/');
+        while (p.size() > 1 && p.back() == '/')
+            p.pop_back();
+        return p;
+    }
+
+    std::string parentOf(const std::string &p)
+    {
+        const size_t slash = p.rfind('/');
+        return slash == 0 ? "/" : p.substr(0, slash);
+    }
+} // namespace
+
+namespace fs
+{
+    // ---------- File ----------
+
+    size_t File::write(const uint8_t *buf, size_t size)
+    {
+        if (!_impl || !_writable || _node->dir)
+            return 0;
+        const size_t used = _impl->usedBytes();
+        if (used + size > _impl->_capacity)
+            size = used < _impl->_capacity ? _impl->_capacity - used : 0;
+        if (_pos + size > _node->data.size())
+            _node->data.resize(_pos + size);
+        memcpy(_node->data.data() + _pos, buf, size);
+        _pos += size;
+        return size;
+    }
+
+    int File::read()
+    {
+        uint8_t b;
+        return read(&b, 1) == 1 ? b : -1;
+    }
+
+    size_t File::read(uint8_t *buf, size_t size)
+    {
+        if (!_impl || _node->dir || _pos >= _node->data.size())
+            return 0;
+        const size_t n = std::min(size, _node->data.size() - _pos);
+        memcpy(buf, _node->data.data() + _pos, n);
+        _pos += n;
+        return n;
+    }
+
+    int File::available()
+    {
+        return (_impl && !_node->dir) ? (int)(_node->data.size() - _pos) : 0;
+    }
+
+    size_t File::size() const
+    {
+        return (_impl && !_node->dir) ? _node->data.size() : 0;
+    }
+
+    bool File::seek(uint32_t pos)
+    {
+        if (!_impl || pos > size())
+            return false;
+        _pos = pos;
+        return true;
+    }
+
+    void File::close()
+    {
+        _impl = nullptr;
+        _node.reset();
+    }
+
+    const char *File::name() const
+    {
+        const size_t slash = _path.rfind('/');
+        return _path.c_str() + (slash == std::string::npos ? 0 : slash + 1);
+    }
+
+    bool File::isDirectory() const
+    {
+        return _impl && _node->dir;
+    }
+
+    File File::openNextFile(const char *mode)
+    {
+        if (!isDirectory())
+            return File();
+        size_t i = 0;
+        for (const auto &kv : _impl->_nodes)
+        {
+            if (kv.first == _path || parentOf(kv.first) != _path)
+                continue;
+            if (i++ == _dirPos)
+            {
+                _dirPos++;
+                return _impl->open(kv.first.c_str(), mode);
+            }
+        }
+        return File();
+    }
+
+    // ---------- FS ----------
+
+    File FsImpl::open(const char *path, const char *mode, bool create)
+    {
+        (void)create;
+        File f;
+        if (!_mounted)
+            return f;
+        const std::string p = normalise(path);
+        const char m = mode ? mode[0] : 'r';
+        auto it = _nodes.find(p);
+        if (it == _nodes.end())
+        {
+            if (m == 'r')
+                return f;
+            it = _nodes.emplace(p, std::make_shared<FsNode>()).first;
+        }
+        else if (m == 'w' && !it->second->dir)
+        {
+            it->second->data.clear();
+        }
+        f._impl = this;
+        f._path = p;
+        f._node = it->second;
+        f._writable = m != 'r' || (mode && strchr(mode, '+'));
+        f._pos = m == 'a' ? it->second->data.size() : 0;
+        return f;
+    }
+
+    bool FsImpl::exists(const char *path) const
+    {
+        return _mounted && _nodes.count(normalise(path)) != 0;
+    }
+
+    bool FsImpl::remove(const char *path)
+    {
+        auto it = _nodes.find(normalise(path));
+        if (!_mounted || it == _nodes.end() || it->second->dir)
+            return false;
+        _nodes.erase(it);
+        return true;
+    }
+
+    bool FsImpl::mkdir(const char *path)
+    {
+        if (!_mounted)
+            return false;
+        auto &node = _nodes[normalise(path)];
+        if (!node)
+        {
+            node = std::make_shared<FsNode>();
+            node->dir = true;
+        }
+        return node->dir;
+    }
+
+    bool FsImpl::rmdir(const char *path)
+    {
+        const std::string p = normalise(path);
+        auto it = _nodes.find(p);
+        if (!_mounted || it == _nodes.end() || !it->second->dir)
+            return false;
+        for (const auto &kv : _nodes)
+            if (kv.first != p && parentOf(kv.first) == p)
+                return false; // not empty
+        _nodes.erase(it);
+        return true;
+    }
+
+    size_t FsImpl::usedBytes() const
+    {
+        size_t n = 0;
+        for (const auto &kv : _nodes)
+            n += kv.second->data.size();
+        return n;
+    }
+
+    void FsImpl::wipe()
+    {
+        _nodes.clear();
+    }
+} // namespace fs
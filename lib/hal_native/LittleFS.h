@@ -0,0 +1,33 @@
+#pragma once
+
+// Host build of the arduino-esp32 LittleFS object over the RAM filesystem
+// in FS.h. begin() mounts (formatting is a no-op); contents survive until
+// hal::reset() or format().
+
+#include "FS.h"
+
+namespace fs
+{
+    class LittleFSFS : public FS
+    {
+    public:
+        bool begin(bool formatOnFail = false, const char *basePath = "/littlefs",
+                   uint8_t maxOpenFiles = 10, const char *partitionLabel = "spiffs")
+        {
+            (void)formatOnFail;
+            (void)basePath;
+            (void)maxOpenFiles;
+            (void)partitionLabel;
+            _mounted = true;
+            return true;
+        }
+        void end() { _mounted = false; }
+        bool format()
+        {
+            wipe();
+            return true;
+        }
+    };
+} // namespace fs
+
+extern fs::LittleFSFS LittleFS;
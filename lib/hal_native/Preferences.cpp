@@ -0,0 +1,86 @@
+#include "Preferences.h"
+
+namespace
+{
+    // NVS limits namespace and key names to 15 characters
+    constexpr size_t NAME_MAX_LEN = 15;
+
+    std::map<std::string, std::map<std::string, std::vector<uint8_t>>> store;
+    uint32_t writeCount = 0;
+} // namespace
+
+bool Preferences::begin(const char *name, bool readOnly, const char *partitionLabel)
+{
+    (void)partitionLabel;
+    if (!name || !*name || strlen(name) > NAME_MAX_LEN)
+        return false;
+    _ns = name;
+    _readOnly = readOnly;
+    store[_ns];
+    return true;
+}
+
+bool Preferences::clear()
+{
+    if (_ns.empty() || _readOnly)
+        return false;
+    store[_ns].clear();
+    return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+    if (_ns.empty() || _readOnly)
+        return false;
+    return store[_ns].erase(key) != 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+    return !_ns.empty() && store[_ns].count(key) != 0;
+}
+
+size_t Preferences::putBytes(const char *key, const void *value, size_t len)
+{
+    if (_ns.empty() || _readOnly || !key || strlen(key) > NAME_MAX_LEN || !value || !len)
+        return 0;
+    const uint8_t *p = (const uint8_t *)value;
+    store[_ns][key].assign(p, p + len);
+    writeCount++;
+    return len;
+}
+
+size_t Preferences::getBytesLength(const char *key)
+{
+    if (_ns.empty())
+        return 0;
+    auto &ns = store[_ns];
+    auto it = ns.find(key);
+    return it == ns.end() ? 0 : it->second.size();
+}
+
+size_t Preferences::getBytes(const char *key, void *buf, size_t maxLen)
+{
+    const size_t len = getBytesLength(key);
+    if (!len || !buf || len > maxLen)
+        return 0;
+    memcpy(buf, store[_ns][key].data(), len);
+    return len;
+}
+
+uint32_t Preferences::writes() { return writeCount; }
+
+std::vector<uint8_t> *Preferences::raw(const char *name, const char *key)
+{
+    auto ns = store.find(name);
+    if (ns == store.end())
+        return nullptr;
+    auto it = ns->second.find(key);
+    return it == ns->second.end() ? nullptr : &it->second;
+}
+
+void Preferences::wipe()
+{
+    store.clear();
+    writeCount = 0;
+}
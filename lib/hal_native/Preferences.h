@@ -0,0 +1,37 @@
+#pragma once
+
+// Host build of the arduino-esp32 Preferences (NVS) surface, backed by RAM.
+// Only what the firmware uses: blobs and removal. Every namespace survives
+// until hal::reset(); a putBytes() replaces the old value whole, as NVS
+// does.
+
+#include "Arduino.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+class Preferences
+{
+public:
+    bool begin(const char *name, bool readOnly = false, const char *partitionLabel = nullptr);
+    void end() { _ns.clear(); }
+
+    bool clear();
+    bool remove(const char *key);
+    bool isKey(const char *key);
+
+    size_t putBytes(const char *key, const void *value, size_t len);
+    size_t getBytesLength(const char *key);
+    size_t getBytes(const char *key, void *buf, size_t maxLen);
+
+    // host only: writes so far, the stored bytes of a key (to corrupt them),
+    // and wiping every namespace
+    static uint32_t writes();
+    static std::vector<uint8_t> *raw(const char *name, const char *key);
+    static void wipe();
+
+private:
+    std::string _ns;
+    bool _readOnly = false;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+// Nothing on the board uses SPI; this only satisfies library includes.
+
+#include "Arduino.h"
+
+#define SPI_MODE0 0x00
+#define MSBFIRST 1
+#define LSBFIRST 0
+
+class SPISettings
+{
+public:
+    SPISettings() = default;
+    SPISettings(uint32_t, uint8_t, uint8_t) {}
+};
+
+class SPIClass
+{
+public:
+    void begin() {}
+    void end() {}
+    void beginTransaction(SPISettings) {}
+    void endTransaction() {}
+    uint8_t transfer(uint8_t) { return 0xFF; }
+};
+
+extern SPIClass SPI;
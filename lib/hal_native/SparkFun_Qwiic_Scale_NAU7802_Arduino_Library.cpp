@@ -0,0 +1,245 @@
+#include "SparkFun_Qwiic_Scale_NAU7802_Arduino_Library.h"
+
+bool NAU7802::begin(TwoWire &wirePort, bool initialize)
+{
+    _i2cPort = &wirePort;
+    if (!isConnected())
+    {
+        if (!isConnected())
+            return false;
+    }
+
+    bool result = true;
+    if (initialize)
+    {
+        result &= reset();
+        result &= powerUp();
+        result &= setLDO(NAU7802_LDO_3V3);
+        result &= setGain(NAU7802_GAIN_128);
+        result &= setSampleRate(NAU7802_SPS_80);
+        result &= setRegister(NAU7802_ADC, 0x30); // turn off CLK_CHP
+        result &= setBit(7, NAU7802_PGA_PWR);     // PGA output cap
+        result &= calibrateAFE();
+    }
+    return result;
+}
+
+bool NAU7802::isConnected()
+{
+    _i2cPort->beginTransmission(_deviceAddress);
+    return _i2cPort->endTransmission() == 0;
+}
+
+bool NAU7802::available()
+{
+    return getBit(NAU7802_PU_CTRL_CR, NAU7802_PU_CTRL);
+}
+
+int32_t NAU7802::getReading()
+{
+    _i2cPort->beginTransmission(_deviceAddress);
+    _i2cPort->write(NAU7802_ADCO_B2);
+    if (_i2cPort->endTransmission() != 0)
+        return 0;
+    if (_i2cPort->requestFrom(_deviceAddress, (uint8_t)3) != 3)
+        return 0;
+
+    uint32_t msb = (uint8_t)_i2cPort->read();
+    uint32_t mid = (uint8_t)_i2cPort->read();
+    uint32_t lsb = (uint8_t)_i2cPort->read();
+    uint32_t value = (msb << 16) | (mid << 8) | lsb;
+
+    // sign-extend the 24-bit two's complement value
+    if (value & 0x00800000)
+        value |= 0xFF000000;
+    return (int32_t)value;
+}
+
+int32_t NAU7802::getAverage(uint8_t averageAmount, unsigned long timeout_ms)
+{
+    long total = 0;
+    uint8_t samplesAquired = 0;
+    unsigned long startTime = millis();
+    while (1)
+    {
+        if (available())
+        {
+            total += getReading();
+            if (++samplesAquired == averageAmount)
+                break;
+        }
+        if (millis() - startTime > timeout_ms)
+            return 0;
+        delay(1);
+    }
+    total /= averageAmount;
+    return (int32_t)total;
+}
+
+void NAU7802::calculateZeroOffset(uint8_t averageAmount, unsigned long timeout_ms)
+{
+    setZeroOffset(getAverage(averageAmount, timeout_ms));
+}
+
+void NAU7802::calculateCalibrationFactor(float weightOnScale, uint8_t averageAmount,
+                                         unsigned long timeout_ms)
+{
+    int32_t onScale = getAverage(averageAmount, timeout_ms);
+    setCalibrationFactor((onScale - _zeroOffset) / weightOnScale);
+}
+
+float NAU7802::getWeight(bool allowNegativeWeights, uint8_t samplesToTake,
+                         unsigned long timeout_ms)
+{
+    int32_t onScale = getAverage(samplesToTake, timeout_ms);
+    if (!allowNegativeWeights && onScale < _zeroOffset)
+        onScale = _zeroOffset;
+    return ((float)onScale - _zeroOffset) / _calibrationFactor;
+}
+
+bool NAU7802::setGain(uint8_t gainValue)
+{
+    if (gainValue > 0b111)
+        gainValue = 0b111;
+    uint8_t value = getRegister(NAU7802_CTRL1);
+    value &= 0b11111000;
+    value |= gainValue;
+    return setRegister(NAU7802_CTRL1, value);
+}
+
+bool NAU7802::setLDO(uint8_t ldoValue)
+{
+    if (ldoValue > 0b111)
+        ldoValue = 0b111;
+    uint8_t value = getRegister(NAU7802_CTRL1);
+    value &= 0b11000111;
+    value |= ldoValue << 3;
+    setRegister(NAU7802_CTRL1, value);
+    return setBit(NAU7802_PU_CTRL_AVDDS, NAU7802_PU_CTRL);
+}
+
+bool NAU7802::setSampleRate(uint8_t rate)
+{
+    if (rate > 0b111)
+        rate = 0b111;
+    uint8_t value = getRegister(NAU7802_CTRL2);
+    value &= 0b10001111;
+    value |= rate << 4;
+    return setRegister(NAU7802_CTRL2, value);
+}
+
+bool NAU7802::setChannel(uint8_t channelNumber)
+{
+    if (channelNumber == 0)
+        return clearBit(NAU7802_CTRL2_CHS, NAU7802_CTRL2);
+    return setBit(NAU7802_CTRL2_CHS, NAU7802_CTRL2);
+}
+
+bool NAU7802::calibrateAFE()
+{
+    beginCalibrateAFE();
+    return waitForCalibrateAFE(1000);
+}
+
+void NAU7802::beginCalibrateAFE()
+{
+    setBit(NAU7802_CTRL2_CALS, NAU7802_CTRL2);
+}
+
+NAU7802_Cal_Status NAU7802::calAFEStatus()
+{
+    if (getBit(NAU7802_CTRL2_CALS, NAU7802_CTRL2))
+        return NAU7802_CAL_IN_PROGRESS;
+    if (getBit(NAU7802_CTRL2_CAL_ERROR, NAU7802_CTRL2))
+        return NAU7802_CAL_FAILURE;
+    return NAU7802_CAL_SUCCESS;
+}
+
+bool NAU7802::waitForCalibrateAFE(unsigned long timeout_ms)
+{
+    unsigned long begin = millis();
+    NAU7802_Cal_Status cal_ready;
+    while ((cal_ready = calAFEStatus()) == NAU7802_CAL_IN_PROGRESS)
+    {
+        if (timeout_ms > 0 && millis() - begin > timeout_ms)
+            break;
+        delay(1);
+    }
+    return cal_ready == NAU7802_CAL_SUCCESS;
+}
+
+bool NAU7802::reset()
+{
+    setBit(NAU7802_PU_CTRL_RR, NAU7802_PU_CTRL);
+    delay(1);
+    return clearBit(NAU7802_PU_CTRL_RR, NAU7802_PU_CTRL);
+}
+
+bool NAU7802::powerUp()
+{
+    setBit(NAU7802_PU_CTRL_PUD, NAU7802_PU_CTRL);
+    setBit(NAU7802_PU_CTRL_PUA, NAU7802_PU_CTRL);
+
+    uint8_t counter = 0;
+    while (!getBit(NAU7802_PU_CTRL_PUR, NAU7802_PU_CTRL))
+    {
+        delay(1);
+        if (counter++ > 100)
+            return false;
+    }
+    return setBit(NAU7802_PU_CTRL_CS, NAU7802_PU_CTRL);
+}
+
+bool NAU7802::powerDown()
+{
+    clearBit(NAU7802_PU_CTRL_PUD, NAU7802_PU_CTRL);
+    return clearBit(NAU7802_PU_CTRL_PUA, NAU7802_PU_CTRL);
+}
+
+bool NAU7802::setIntPolarityHigh() { return clearBit(NAU7802_CTRL1_CRP, NAU7802_CTRL1); }
+bool NAU7802::setIntPolarityLow() { return setBit(NAU7802_CTRL1_CRP, NAU7802_CTRL1); }
+
+uint8_t NAU7802::getRevisionCode()
+{
+    return getRegister(NAU7802_DEVICE_REV) & 0x0F;
+}
+
+bool NAU7802::setBit(uint8_t bitNumber, uint8_t registerAddress)
+{
+    uint8_t value = getRegister(registerAddress);
+    value |= (1 << bitNumber);
+    return setRegister(registerAddress, value);
+}
+
+bool NAU7802::clearBit(uint8_t bitNumber, uint8_t registerAddress)
+{
+    uint8_t value = getRegister(registerAddress);
+    value &= ~(1 << bitNumber);
+    return setRegister(registerAddress, value);
+}
+
+bool NAU7802::getBit(uint8_t bitNumber, uint8_t registerAddress)
+{
+    uint8_t value = getRegister(registerAddress);
+    value &= (1 << bitNumber);
+    return value;
+}
+
+uint8_t NAU7802::getRegister(uint8_t registerAddress)
+{
+    _i2cPort->beginTransmission(_deviceAddress);
+    _i2cPort->write(registerAddress);
+    if (_i2cPort->endTransmission() != 0)
+        return 0xFF;
+    if (_i2cPort->requestFrom(_deviceAddress, (uint8_t)1) != 1)
+        return 0xFF;
+    return (uint8_t)_i2cPort->read();
+}
+
+bool NAU7802::setRegister(uint8_t registerAddress, uint8_t value)
+{
+    _i2cPort->beginTransmission(_deviceAddress);
+    _i2cPort->write(registerAddress);
+    _i2cPort->write(value);
+    return _i2cPort->endTransmission() == 0;
+}
@@ -0,0 +1,145 @@
+#pragma once
+
+// Host build of the SparkFun NAU7802 driver surface the firmware uses, talking
+// over the fake Wire bus with the same register protocol.
+
+#include <Wire.h>
+
+typedef enum
+{
+    NAU7802_PU_CTRL = 0x00,
+    NAU7802_CTRL1,
+    NAU7802_CTRL2,
+    NAU7802_OCAL1_B2,
+    NAU7802_ADCO_B2 = 0x12,
+    NAU7802_ADCO_B1,
+    NAU7802_ADCO_B0,
+    NAU7802_ADC = 0x15,
+    NAU7802_OTP_B1,
+    NAU7802_OTP_B0,
+    NAU7802_PGA = 0x1B,
+    NAU7802_PGA_PWR = 0x1C,
+    NAU7802_DEVICE_REV = 0x1F,
+} Scale_Registers;
+
+typedef enum
+{
+    NAU7802_PU_CTRL_RR = 0,
+    NAU7802_PU_CTRL_PUD,
+    NAU7802_PU_CTRL_PUA,
+    NAU7802_PU_CTRL_PUR,
+    NAU7802_PU_CTRL_CS,
+    NAU7802_PU_CTRL_CR,
+    NAU7802_PU_CTRL_OSCS,
+    NAU7802_PU_CTRL_AVDDS,
+} PU_CTRL_Bits;
+
+typedef enum
+{
+    NAU7802_CTRL1_GAIN = 2,
+    NAU7802_CTRL1_VLDO = 5,
+    NAU7802_CTRL1_DRDY_SEL = 6,
+    NAU7802_CTRL1_CRP = 7,
+} CTRL1_Bits;
+
+typedef enum
+{
+    NAU7802_CTRL2_CALMOD = 0,
+    NAU7802_CTRL2_CALS = 2,
+    NAU7802_CTRL2_CAL_ERROR = 3,
+    NAU7802_CTRL2_CRS = 4,
+    NAU7802_CTRL2_CHS = 7,
+} CTRL2_Bits;
+
+typedef enum
+{
+    NAU7802_LDO_2V4 = 0b111,
+    NAU7802_LDO_2V7 = 0b110,
+    NAU7802_LDO_3V0 = 0b101,
+    NAU7802_LDO_3V3 = 0b100,
+    NAU7802_LDO_3V6 = 0b011,
+    NAU7802_LDO_3V9 = 0b010,
+    NAU7802_LDO_4V2 = 0b001,
+    NAU7802_LDO_4V5 = 0b000,
+} NAU7802_LDO_Values;
+
+typedef enum
+{
+    NAU7802_GAIN_128 = 0b111,
+    NAU7802_GAIN_64 = 0b110,
+    NAU7802_GAIN_32 = 0b101,
+    NAU7802_GAIN_16 = 0b100,
+    NAU7802_GAIN_8 = 0b011,
+    NAU7802_GAIN_4 = 0b010,
+    NAU7802_GAIN_2 = 0b001,
+    NAU7802_GAIN_1 = 0b000,
+} NAU7802_Gain_Values;
+
+typedef enum
+{
+    NAU7802_SPS_320 = 0b111,
+    NAU7802_SPS_80 = 0b011,
+    NAU7802_SPS_40 = 0b010,
+    NAU7802_SPS_20 = 0b001,
+    NAU7802_SPS_10 = 0b000,
+} NAU7802_SPS_Values;
+
+typedef enum
+{
+    NAU7802_CAL_SUCCESS = 0,
+    NAU7802_CAL_IN_PROGRESS = 1,
+    NAU7802_CAL_FAILURE = 2,
+} NAU7802_Cal_Status;
+
+class NAU7802
+{
+public:
+    bool begin(TwoWire &wirePort = Wire, bool reset = true);
+    bool isConnected();
+
+    bool available();
+    int32_t getReading();
+    int32_t getAverage(uint8_t samplesToTake, unsigned long timeout_ms = 1000);
+
+    void calculateZeroOffset(uint8_t averageAmount = 8, unsigned long timeout_ms = 1000);
+    void setZeroOffset(int32_t newZeroOffset) { _zeroOffset = newZeroOffset; }
+    int32_t getZeroOffset() { return _zeroOffset; }
+
+    void calculateCalibrationFactor(float weightOnScale, uint8_t averageAmount = 8,
+                                    unsigned long timeout_ms = 1000);
+    void setCalibrationFactor(float calFactor) { _calibrationFactor = calFactor; }
+    float getCalibrationFactor() { return _calibrationFactor; }
+
+    float getWeight(bool allowNegativeWeights = false, uint8_t samplesToTake = 8,
+                    unsigned long timeout_ms = 1000);
+
+    bool setGain(uint8_t gainValue);
+    bool setLDO(uint8_t ldoValue);
+    bool setSampleRate(uint8_t rate);
+    bool setChannel(uint8_t channelNumber);
+
+    bool calibrateAFE();
+    void beginCalibrateAFE();
+    bool waitForCalibrateAFE(unsigned long timeout_ms = 0);
+    NAU7802_Cal_Status calAFEStatus();
+
+    bool reset();
+    bool powerUp();
+    bool powerDown();
+
+    bool setIntPolarityHigh();
+    bool setIntPolarityLow();
+    uint8_t getRevisionCode();
+
+    bool setBit(uint8_t bitNumber, uint8_t registerAddress);
+    bool clearBit(uint8_t bitNumber, uint8_t registerAddress);
+    bool getBit(uint8_t bitNumber, uint8_t registerAddress);
+    uint8_t getRegister(uint8_t registerAddress);
+    bool setRegister(uint8_t registerAddress, uint8_t value);
+
+private:
+    TwoWire *_i2cPort = &Wire;
+    const uint8_t _deviceAddress = 0x2A;
+    int32_t _zeroOffset = 0;
+    float _calibrationFactor = 1.0f;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+
+class __FlashStringHelper;
+
+// Just enough of Arduino's String for libraries that take one by reference
+class String
+{
+public:
+    String() = default;
+    String(const char *s) : _s(s ? s : "") {}
+    String(const std::string &s) : _s(s) {}
+    String(const __FlashStringHelper *s) : _s(reinterpret_cast<const char *>(s)) {}
+
+    const char *c_str() const { return _s.c_str(); }
+    unsigned int length() const { return (unsigned int)_s.size(); }
+    char operator[](unsigned int i) const { return _s[i]; }
+    String &operator+=(const String &o)
+    {
+        _s += o._s;
+        return *this;
+    }
+    bool operator==(const String &o) const { return _s == o._s; }
+
+private:
+    std::string _s;
+};
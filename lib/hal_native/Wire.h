@@ -0,0 +1,52 @@
+#pragma once
+
+// Fake I2C master. Transactions are routed to hal::I2CDevice models by
+// address, honouring a built-in TCA9548A at 0x70, and advance the virtual
+// clock by their on-the-wire duration at the current SCL rate.
+
+#include "Arduino.h"
+
+#ifndef I2C_BUFFER_LENGTH
+#define I2C_BUFFER_LENGTH 128
+#endif
+
+class TwoWire : public Stream
+{
+public:
+    bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0);
+    bool end() { return true; }
+    bool setClock(uint32_t frequency);
+    uint32_t getClock() const { return _clock; }
+    void setTimeOut(uint16_t) {}
+
+    void beginTransmission(uint8_t address);
+    void beginTransmission(int address) { beginTransmission((uint8_t)address); }
+    uint8_t endTransmission(bool sendStop = true);
+
+    uint8_t requestFrom(uint8_t address, uint8_t quantity, uint8_t sendStop = 1);
+    uint8_t requestFrom(int address, int quantity) { return requestFrom((uint8_t)address, (uint8_t)quantity); }
+    uint8_t requestFrom(int address, int quantity, int sendStop)
+    {
+        return requestFrom((uint8_t)address, (uint8_t)quantity, (uint8_t)sendStop);
+    }
+
+    size_t write(uint8_t c) override;
+    size_t write(const uint8_t *data, size_t n) override;
+    using Print::write;
+
+    int available() override;
+    int read() override;
+    int peek() override;
+
+private:
+    uint32_t _clock = 100000;
+    uint8_t _txAddr = 0;
+    uint8_t _tx[I2C_BUFFER_LENGTH];
+    size_t _txLen = 0;
+    uint8_t _rx[I2C_BUFFER_LENGTH];
+    size_t _rxLen = 0, _rxPos = 0;
+
+    void spend(size_t bytes);
+};
+
+extern TwoWire Wire;
@@ -0,0 +1,9 @@
+#pragma once
+
+// ESP-IDF high-resolution timer: microseconds since boot. On the host this
+// reads the virtual clock without advancing it, so tracing does not
+// perturb the timing it records.
+
+#include <stdint.h>
+
+int64_t esp_timer_get_time();
@@ -0,0 +1,365 @@
+#include "fake_devices.h"
+
+#include <math.h>
+#include <string.h>
+
+namespace hal
+{
+    // ================= SSD1306 =================
+
+    namespace
+    {
+        uint8_t ssd1306ArgCount(uint8_t cmd)
+        {
+            switch (cmd)
+            {
+            case 0x21: // COLUMNADDR
+            case 0x22: // PAGEADDR
+                return 2;
+            case 0x20: // MEMORYMODE
+            case 0x81: // SETCONTRAST
+            case 0x8D: // CHARGEPUMP
+            case 0xA8: // SETMULTIPLEX
+            case 0xD3: // SETDISPLAYOFFSET
+            case 0xD5: // SETDISPLAYCLOCKDIV
+            case 0xD9: // SETPRECHARGE
+            case 0xDA: // SETCOMPINS
+            case 0xDB: // SETVCOMDETECT
+                return 1;
+            default:
+                return 0;
+            }
+        }
+    }
+
+    bool FakeSsd1306::onWrite(const uint8_t *data, size_t n)
+    {
+        if (n == 0)
+            return true;
+        const uint8_t control = data[0];
+        for (size_t i = 1; i < n; i++)
+        {
+            if (control & 0x40)
+                this->data(data[i]);
+            else
+                command(data[i]);
+        }
+        return true;
+    }
+
+    bool FakeSsd1306::onRead(uint8_t *data, size_t n)
+    {
+        memset(data, 0, n); // status byte: display on, not busy
+        return true;
+    }
+
+    void FakeSsd1306::command(uint8_t b)
+    {
+        if (_argsLeft == 0)
+        {
+            _cmd = b;
+            _argIdx = 0;
+            _argsLeft = ssd1306ArgCount(b);
+            if (b >= 0xB0 && b <= 0xB7) // page start (page addressing mode)
+                _page = b & 0x07;
+            return;
+        }
+
+        if (_cmd == 0x21)
+        {
+            if (_argIdx == 0)
+                _col0 = _col = b & 0x7F;
+            else
+                _col1 = b & 0x7F;
+        }
+        else if (_cmd == 0x22)
+        {
+            if (_argIdx == 0)
+                _page0 = _page = b & 0x07;
+            else
+                _page1 = b & 0x07;
+        }
+        _argIdx++;
+        _argsLeft--;
+    }
+
+    void FakeSsd1306::data(uint8_t b)
+    {
+        _gram[_page * W + _col] = b;
+        _dataBytes++;
+        if (_col++ >= _col1)
+        {
+            _col = _col0;
+            _page = _page >= _page1 ? _page0 : _page + 1;
+        }
+    }
+
+    // ================= TCS34725 =================
+
+    namespace
+    {
+        constexpr uint8_t TCS_ENABLE = 0x00, TCS_ATIME = 0x01, TCS_CONTROL = 0x0F;
+        constexpr uint8_t TCS_ID = 0x12, TCS_STATUS = 0x13, TCS_CDATAL = 0x14;
+        constexpr uint8_t TCS_PON = 0x01, TCS_AEN = 0x02, TCS_AVALID = 0x01;
+        constexpr float TCS_GAIN[4] = {1.0f, 4.0f, 16.0f, 60.0f};
+    }
+
+    void FakeTcs34725::setScene(float r, float g, float b, float c)
+    {
+        _scene[0] = c;
+        _scene[1] = r;
+        _scene[2] = g;
+        _scene[3] = b;
+    }
+
+    uint64_t FakeTcs34725::integrationUs() const
+    {
+        return (uint64_t)(256 - _reg[TCS_ATIME]) * 2400u;
+    }
+
+    void FakeTcs34725::latch()
+    {
+        const uint8_t en = _reg[TCS_ENABLE];
+        if ((en & (TCS_PON | TCS_AEN)) != (TCS_PON | TCS_AEN))
+            return;
+        if (nowUs() - _aenSinceUs < integrationUs())
+            return;
+
+        const uint32_t cycles = 256u - _reg[TCS_ATIME];
+        const uint32_t maxCount = cycles >= 64 ? 65535u : cycles * 1024u;
+        const float scale = (float)cycles / 256.0f * TCS_GAIN[gainBits()];
+        for (int i = 0; i < 4; i++)
+        {
+            float v = _scene[i] * scale;
+            uint32_t counts = v <= 0.0f ? 0u : (v >= (float)maxCount ? maxCount : (uint32_t)v);
+            _reg[TCS_CDATAL + 2 * i] = (uint8_t)(counts & 0xFF);
+            _reg[TCS_CDATAL + 2 * i + 1] = (uint8_t)(counts >> 8);
+        }
+        _reg[TCS_STATUS] |= TCS_AVALID;
+    }
+
+    bool FakeTcs34725::onWrite(const uint8_t *data, size_t n)
+    {
+        if (n == 0)
+            return true;
+        if (!(data[0] & 0x80))
+            return false; // every transfer starts with a command byte
+        _ptr = data[0] & 0x1F;
+        _autoInc = (data[0] & 0x60) == 0x20;
+
+        for (size_t i = 1; i < n; i++)
+        {
+            const uint8_t reg = _ptr;
+            if (reg == TCS_ENABLE)
+            {
+                const bool wasRunning = (_reg[TCS_ENABLE] & TCS_AEN) != 0;
+                const bool running = (data[i] & (TCS_PON | TCS_AEN)) == (TCS_PON | TCS_AEN);
+                if (running && !wasRunning)
+                    _aenSinceUs = nowUs();
+                if (!running)
+                    _reg[TCS_STATUS] &= (uint8_t)~TCS_AVALID;
+            }
+            if (reg != TCS_ID && reg != TCS_STATUS && reg < sizeof(_reg))
+                _reg[reg] = data[i];
+            if (_autoInc)
+                _ptr++;
+        }
+        return true;
+    }
+
+    bool FakeTcs34725::onRead(uint8_t *data, size_t n)
+    {
+        _reg[TCS_ID] = 0x44;
+        latch();
+        for (size_t i = 0; i < n; i++)
+            data[i] = _reg[(_ptr + i) & 0x1F];
+        _ptr = (uint8_t)(_ptr + n);
+        return true;
+    }
+
+    // ================= MLX90614 =================
+
+    namespace
+    {
+        uint8_t crc8(const uint8_t *p, size_t n)
+        {
+            uint8_t crc = 0;
+            while (n--)
+            {
+                crc ^= *p++;
+                for (int i = 0; i < 8; i++)
+                    crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x07) : (uint8_t)(crc << 1);
+            }
+            return crc;
+        }
+    }
+
+    void FakeMlx90614::setTemps(float ambientC, float objectC)
+    {
+        _ambC = ambientC;
+        _objC = objectC;
+    }
+
+    bool FakeMlx90614::onWrite(const uint8_t *data, size_t n)
+    {
+        if (n > 0)
+            _cmd = data[0];
+        return true;
+    }
+
+    bool FakeMlx90614::onRead(uint8_t *data, size_t n)
+    {
+        float c = _cmd == 0x06 ? _ambC : (_cmd == 0x07 ? _objC : -273.15f);
+        uint16_t raw = (uint16_t)lroundf((c + 273.15f) / 0.02f) & 0x7FFF;
+        uint8_t frame[5] = {0x5A << 1, _cmd, (0x5A << 1) | 1, (uint8_t)(raw & 0xFF), (uint8_t)(raw >> 8)};
+        uint8_t out[3] = {frame[3], frame[4], crc8(frame, sizeof(frame))};
+        for (size_t i = 0; i < n; i++)
+            data[i] = i < 3 ? out[i] : 0xFF;
+        return true;
+    }
+
+    // ================= NAU7802 =================
+
+    namespace
+    {
+        constexpr uint8_t NAU_PU_CTRL = 0x00, NAU_CTRL2 = 0x02;
+        constexpr uint8_t NAU_ADCO_B2 = 0x12, NAU_REVISION = 0x1F;
+        constexpr uint8_t PU_RR = 0x01, PU_PUD = 0x02, PU_PUA = 0x04, PU_PUR = 0x08;
+        constexpr uint8_t PU_CS = 0x10, PU_CR = 0x20;
+        constexpr uint8_t CTRL2_CALS = 0x04;
+        constexpr uint16_t NAU_SPS[8] = {10, 20, 40, 80, 80, 80, 80, 320};
+        constexpr uint64_t SPIN_GAP_US = 1000; // polls closer than this are a busy-wait
+        constexpr uint8_t SPIN_POLLS = 8;
+    }
+
+    uint32_t FakeNau7802::samplesPerSecond() const
+    {
+        return NAU_SPS[(_reg[NAU_CTRL2] >> 4) & 0x07];
+    }
+
+    uint64_t FakeNau7802::periodUs() const
+    {
+        return 1000000u / samplesPerSecond();
+    }
+
+    float FakeNau7802::gauss()
+    {
+        auto uni = [this]() {
+            _rng ^= _rng << 13;
+            _rng ^= _rng >> 17;
+            _rng ^= _rng << 5;
+            return ((_rng >> 8) + 0.5f) / 16777216.0f;
+        };
+        float u1 = uni(), u2 = uni();
+        return sqrtf(-2.0f * logf(u1)) * cosf(6.2831853f * u2);
+    }
+
+    bool FakeNau7802::conversionReady()
+    {
+        if ((_reg[NAU_PU_CTRL] & (PU_PUD | PU_PUA | PU_CS)) != (PU_PUD | PU_PUA | PU_CS))
+            return false;
+        const uint64_t now = nowUs();
+        const uint64_t period = periodUs();
+        const uint64_t latest = now - (now - _lastConvUs) % period;
+        return latest > _readConvUs;
+    }
+
+    void FakeNau7802::attachDrdy(uint8_t pin)
+    {
+        _drdyPin = pin;
+        addTickHook([this](uint64_t) { updateDrdy(); });
+        updateDrdy();
+    }
+
+    void FakeNau7802::updateDrdy()
+    {
+        if (_drdyPin >= 0)
+            setPin((uint8_t)_drdyPin, conversionReady() ? 1 : 0);
+    }
+
+    bool FakeNau7802::onWrite(const uint8_t *data, size_t n)
+    {
+        if (n == 0)
+            return true;
+        _ptr = data[0] & 0x1F;
+        for (size_t i = 1; i < n; i++, _ptr = (_ptr + 1) & 0x1F)
+        {
+            uint8_t v = data[i];
+            if (_ptr == NAU_PU_CTRL)
+            {
+                if (v & PU_RR)
+                {
+                    memset(_reg, 0, sizeof(_reg));
+                    continue;
+                }
+                if (v & PU_PUD)
+                    v |= PU_PUR; // analog powers up instantly here
+                if ((v & PU_CS) && !(_reg[NAU_PU_CTRL] & PU_CS))
+                    _lastConvUs = _readConvUs = nowUs();
+                v = (uint8_t)((v & ~PU_CR) | (_reg[NAU_PU_CTRL] & PU_CR));
+            }
+            else if (_ptr == NAU_CTRL2)
+            {
+                v &= (uint8_t)~CTRL2_CALS; // AFE calibration completes at once
+            }
+            _reg[_ptr] = v;
+        }
+        return true;
+    }
+
+    bool FakeNau7802::onRead(uint8_t *data, size_t n)
+    {
+        for (size_t i = 0; i < n; i++, _ptr = (_ptr + 1) & 0x1F)
+        {
+            if (_ptr == NAU_PU_CTRL)
+            {
+                bool ready = conversionReady();
+                if (!ready)
+                {
+                    // Firmware spinning on CR: skip ahead to the next sample
+                    _spinPolls = (nowUs() - _lastPollUs < SPIN_GAP_US) ? _spinPolls + 1 : 0;
+                    _lastPollUs = nowUs();
+                    if (_spinPolls >= SPIN_POLLS)
+                    {
+                        const uint64_t now = nowUs(), period = periodUs();
+                        idleUntilUs(now - (now - _lastConvUs) % period + period);
+                        ready = conversionReady();
+                    }
+                }
+                if (ready)
+                    _spinPolls = 0;
+                _reg[NAU_PU_CTRL] = (uint8_t)((_reg[NAU_PU_CTRL] & ~PU_CR) | (ready ? PU_CR : 0));
+                data[i] = _reg[NAU_PU_CTRL];
+            }
+            else if (_ptr == NAU_ADCO_B2)
+            {
+                const uint64_t now = nowUs();
+                _readConvUs = now - (now - _lastConvUs) % periodUs();
+                updateDrdy();
+                _latched = _counts + (int32_t)lroundf(gauss() * _noise);
+                if (_latched > 0x7FFFFF)
+                    _latched = 0x7FFFFF;
+                if (_latched < -0x800000)
+                    _latched = -0x800000;
+                data[i] = (uint8_t)((uint32_t)_latched >> 16);
+            }
+            else if (_ptr == NAU_ADCO_B2 + 1)
+            {
+                data[i] = (uint8_t)((uint32_t)_latched >> 8);
+            }
+            else if (_ptr == NAU_ADCO_B2 + 2)
+            {
+                data[i] = (uint8_t)_latched;
+            }
+            else if (_ptr == NAU_REVISION)
+            {
+                data[i] = 0x0F;
+            }
+            else
+            {
+                data[i] = _reg[_ptr];
+            }
+        }
+        return true;
+    }
+} // namespace hal
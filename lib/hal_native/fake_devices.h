@@ -0,0 +1,110 @@
+#pragma once
+
+// Register-level models of the parts on the toaster's I2C bus. Host programs
+// attach them with hal::attachI2C() and steer what they measure; the
+// firmware talks to them through the normal drivers.
+
+#include "hal_native.h"
+
+#include <stdint.h>
+
+namespace hal
+{
+    // SSD1306 128x64: command/data streams, column/page windows, GRAM.
+    class FakeSsd1306 : public I2CDevice
+    {
+    public:
+        static constexpr int W = 128, PAGES = 8;
+
+        bool onWrite(const uint8_t *data, size_t n) override;
+        bool onRead(uint8_t *data, size_t n) override;
+
+        const uint8_t *gram() const { return _gram; }
+        bool pixel(int x, int y) const { return _gram[(y / 8) * W + x] & (1 << (y & 7)); }
+        uint32_t dataBytes() const { return _dataBytes; }
+
+    private:
+        uint8_t _gram[W * PAGES] = {};
+        uint8_t _col0 = 0, _col1 = W - 1, _page0 = 0, _page1 = PAGES - 1;
+        uint8_t _col = 0, _page = 0;
+        uint8_t _cmd = 0, _argsLeft = 0, _argIdx = 0;
+        uint32_t _dataBytes = 0;
+
+        void command(uint8_t b);
+        void data(uint8_t b);
+    };
+
+    // TCS34725: ENABLE/ATIME/CONTROL, free-running RGBC integration with
+    // AVALID, counts scaled by integration time and gain, saturation.
+    class FakeTcs34725 : public I2CDevice
+    {
+    public:
+        // Scene as the sensor would see it at 614 ms / 1x gain
+        void setScene(float r, float g, float b, float c);
+
+        bool onWrite(const uint8_t *data, size_t n) override;
+        bool onRead(uint8_t *data, size_t n) override;
+
+        uint8_t atime() const { return _reg[0x01]; }
+        uint8_t gainBits() const { return _reg[0x0F] & 0x03; }
+
+    private:
+        uint8_t _reg[0x20] = {};
+        uint8_t _ptr = 0;
+        bool _autoInc = false;
+        uint64_t _aenSinceUs = 0;
+        float _scene[4] = {0, 0, 0, 0}; // C, R, G, B
+
+        uint64_t integrationUs() const;
+        void latch();
+    };
+
+    // MLX90614: RAM reads of Ta (0x06) / Tobj1 (0x07) with PEC byte.
+    class FakeMlx90614 : public I2CDevice
+    {
+    public:
+        void setTemps(float ambientC, float objectC);
+
+        bool onWrite(const uint8_t *data, size_t n) override;
+        bool onRead(uint8_t *data, size_t n) override;
+
+    private:
+        uint8_t _cmd = 0;
+        float _ambC = 25.0f, _objC = 25.0f;
+    };
+
+    // NAU7802: power-up handshake, CTRL1/CTRL2, conversions at the
+    // configured sample rate with the CR (cycle ready) bit, 24-bit ADCO.
+    // Optionally drives a DRDY pin that mirrors CR.
+    class FakeNau7802 : public I2CDevice
+    {
+    public:
+        void setCounts(int32_t counts) { _counts = counts; }
+        void setNoise(float countsRms) { _noise = countsRms; }
+        uint32_t samplesPerSecond() const;
+
+        // Wire DRDY to a GPIO (after hal::reset(); installs a tick hook)
+        void attachDrdy(uint8_t pin);
+
+        bool onWrite(const uint8_t *data, size_t n) override;
+        bool onRead(uint8_t *data, size_t n) override;
+
+    private:
+        uint8_t _reg[0x20] = {};
+        uint8_t _ptr = 0;
+        int32_t _counts = 0;
+        float _noise = 0.0f;
+        uint32_t _rng = 0x12345678u;
+        uint64_t _lastConvUs = 0;
+        uint64_t _readConvUs = 0;
+        int32_t _latched = 0;
+        uint8_t _spinPolls = 0;
+        uint64_t _lastPollUs = 0;
+        int _drdyPin = -1;
+
+        uint64_t periodUs() const;
+        bool conversionReady();
+        void updateDrdy();
+        float gauss();
+    };
+} // namespace hal
@@ -0,0 +1,611 @@
+#include "hal_native.h"
+
+#include <Arduino.h>
+#include <Wire.h>
+#include <EEPROM.h>
+#include <LittleFS.h>
+#include <Preferences.h>
+#include <SPI.h>
+#include <esp_timer.h>
+
+#include <stdio.h>
+#include <deque>
+#include <map>
+#include <utility>
+#include <vector>
+
+HardwareSerial Serial;
+TwoWire Wire;
+EEPROMClass EEPROM;
+SPIClass SPI;
+
+struct hw_timer_s
+{
+    bool used = false;
+    bool armed = false;
+    bool autoreload = false;
+    uint16_t divider = 80;
+    uint64_t periodUs = 0;
+    uint64_t dueUs = 0;
+    void (*fn)() = nullptr;
+};
+
+namespace
+{
+    constexpr uint8_t PIN_COUNT = 64;
+    constexpr uint8_t LEDC_COUNT = 16;
+    constexpr uint8_t TCA_ADDR = 0x70;
+    constexpr uint64_t POLL_COST_US = 1; // what a millis()/micros() call "costs"
+
+    struct PinState
+    {
+        uint8_t mode = INPUT;
+        int level = HIGH;
+        void (*isr)() = nullptr;
+        int isrMode = 0;
+    };
+
+    constexpr uint8_t TIMER_COUNT = 4;
+
+    struct I2CSlot
+    {
+        int8_t muxCh;
+        hal::I2CDevice *dev;
+    };
+
+    uint64_t clockUs = 0;
+    bool inHooks = false;
+    bool inTimers = false;
+    int nextHookId = 1;
+    std::vector<std::pair<int, hal::TickHook>> hooks;
+
+    PinState pins[PIN_COUNT];
+    hw_timer_s timers[TIMER_COUNT];
+    uint32_t ledc[LEDC_COUNT];
+
+    bool echo = true;
+    std::string serialOut;
+    std::deque<uint8_t> serialIn;
+
+    std::multimap<uint8_t, I2CSlot> i2cDevices;
+    uint8_t tcaMask = 0;
+    hal::I2CCounters i2cStats = {};
+    hal::I2CDevice *lastTarget = nullptr;
+
+    void runHooks()
+    {
+        // Hooks may wait themselves (e.g. a scripted button press); don't
+        // recurse into them from their own delays.
+        if (inHooks)
+            return;
+        inHooks = true;
+        auto snapshot = hooks;
+        for (auto &h : snapshot)
+            h.second(clockUs);
+        inHooks = false;
+    }
+
+    // Fire every armed alarm due by t in time order, the clock stepping to
+    // each due time so the ISR sees it
+    void runTimers(uint64_t t)
+    {
+        if (inTimers)
+            return;
+        inTimers = true;
+        for (;;)
+        {
+            hw_timer_s *next = nullptr;
+            for (hw_timer_s &tm : timers)
+                if (tm.used && tm.armed && tm.fn && tm.dueUs <= t && (!next || tm.dueUs < next->dueUs))
+                    next = &tm;
+            if (!next)
+                break;
+            clockUs = next->dueUs;
+            if (next->autoreload)
+                next->dueUs += next->periodUs;
+            else
+                next->armed = false;
+            next->fn();
+        }
+        inTimers = false;
+    }
+
+    hal::I2CDevice *route(uint8_t addr)
+    {
+        auto range = i2cDevices.equal_range(addr);
+        for (auto it = range.first; it != range.second; ++it)
+        {
+            const I2CSlot &s = it->second;
+            if (s.muxCh < 0 || (tcaMask & (1u << s.muxCh)))
+                return s.dev;
+        }
+        return nullptr;
+    }
+
+    void writeOut(const uint8_t *p, size_t n)
+    {
+        serialOut.append((const char *)p, n);
+        if (echo)
+            fwrite(p, 1, n, stdout);
+    }
+}
+
+// ================= hal =================
+
+namespace hal
+{
+    uint64_t nowUs() { return clockUs; }
+
+    void advanceUs(uint64_t us)
+    {
+        if (us == 0)
+            return;
+        const uint64_t t = clockUs + us;
+        runTimers(t);
+        clockUs = t;
+        runHooks();
+    }
+
+    void idleUntilUs(uint64_t t)
+    {
+        if (t > clockUs)
+            advanceUs(t - clockUs);
+    }
+
+    int addTickHook(TickHook hook)
+    {
+        hooks.emplace_back(nextHookId, std::move(hook));
+        return nextHookId++;
+    }
+
+    void removeTickHook(int handle)
+    {
+        for (auto it = hooks.begin(); it != hooks.end(); ++it)
+        {
+            if (it->first == handle)
+            {
+                hooks.erase(it);
+                return;
+            }
+        }
+    }
+
+    void setPin(uint8_t pin, int level)
+    {
+        if (pin >= PIN_COUNT)
+            return;
+        PinState &p = pins[pin];
+        int old = p.level;
+        p.level = level ? HIGH : LOW;
+        if (!p.isr || old == p.level)
+            return;
+        bool rising = p.level == HIGH;
+        if (p.isrMode == CHANGE || (p.isrMode == RISING && rising) || (p.isrMode == FALLING && !rising))
+            p.isr();
+    }
+
+    int pinLevel(uint8_t pin)
+    {
+        return pin < PIN_COUNT ? pins[pin].level : LOW;
+    }
+
+    uint32_t ledcDuty(uint8_t channel)
+    {
+        return channel < LEDC_COUNT ? ledc[channel] : 0;
+    }
+
+    void serialEcho(bool on) { echo = on; }
+
+    void serialInject(const std::string &bytes)
+    {
+        serialIn.insert(serialIn.end(), bytes.begin(), bytes.end());
+    }
+
+    std::string serialTakeOutput()
+    {
+        std::string out;
+        out.swap(serialOut);
+        return out;
+    }
+
+    void attachI2C(uint8_t addr, I2CDevice *dev, int8_t muxCh)
+    {
+        i2cDevices.insert({addr, I2CSlot{muxCh, dev}});
+    }
+
+    void detachAllI2C()
+    {
+        i2cDevices.clear();
+        lastTarget = nullptr;
+    }
+
+    uint8_t muxMask() { return tcaMask; }
+
+    I2CCounters i2cCounters() { return i2cStats; }
+
+    void reset()
+    {
+        clockUs = 0;
+        hooks.clear();
+        for (auto &p : pins)
+            p = PinState{};
+        for (auto &tm : timers)
+            tm = hw_timer_s{};
+        memset(ledc, 0, sizeof(ledc));
+        serialOut.clear();
+        serialIn.clear();
+        detachAllI2C();
+        tcaMask = 0;
+        i2cStats = {};
+        EEPROM.wipe();
+        LittleFS.wipe();
+        LittleFS.end();
+        Preferences::wipe();
+    }
+} // namespace hal
+
+// ================= Arduino core =================
+
+unsigned long millis()
+{
+    hal::advanceUs(POLL_COST_US);
+    return (unsigned long)(clockUs / 1000u);
+}
+
+unsigned long micros()
+{
+    hal::advanceUs(POLL_COST_US);
+    return (unsigned long)clockUs;
+}
+
+int64_t esp_timer_get_time() { return (int64_t)clockUs; }
+
+void delay(uint32_t ms) { hal::advanceUs((uint64_t)ms * 1000u); }
+void delayMicroseconds(uint32_t us) { hal::advanceUs(us); }
+void yield() { hal::advanceUs(POLL_COST_US); }
+
+void pinMode(uint8_t pin, uint8_t mode)
+{
+    if (pin >= PIN_COUNT)
+        return;
+    pins[pin].mode = mode;
+    if (mode == INPUT_PULLUP)
+        pins[pin].level = HIGH;
+    else if (mode == INPUT_PULLDOWN)
+        pins[pin].level = LOW;
+}
+
+void digitalWrite(uint8_t pin, uint8_t val)
+{
+    if (pin < PIN_COUNT)
+        pins[pin].level = val ? HIGH : LOW;
+}
+
+int digitalRead(uint8_t pin) { return hal::pinLevel(pin); }
+
+void attachInterrupt(uint8_t pin, void (*isr)(), int mode)
+{
+    if (pin >= PIN_COUNT)
+        return;
+    pins[pin].isr = isr;
+    pins[pin].isrMode = mode;
+}
+
+void detachInterrupt(uint8_t pin)
+{
+    if (pin < PIN_COUNT)
+        pins[pin].isr = nullptr;
+}
+
+void noInterrupts() {}
+void interrupts() {}
+
+double ledcSetup(uint8_t channel, double freq, uint8_t)
+{
+    if (channel < LEDC_COUNT)
+        ledc[channel] = 0;
+    return freq;
+}
+
+void ledcAttachPin(uint8_t, uint8_t) {}
+
+void ledcWrite(uint8_t channel, uint32_t duty)
+{
+    if (channel < LEDC_COUNT)
+        ledc[channel] = duty;
+}
+
+hw_timer_t *timerBegin(uint8_t num, uint16_t divider, bool)
+{
+    if (num >= TIMER_COUNT || timers[num].used)
+        return nullptr;
+    timers[num] = hw_timer_s{};
+    timers[num].used = true;
+    timers[num].divider = divider ? divider : 1;
+    return &timers[num];
+}
+
+void timerEnd(hw_timer_t *timer)
+{
+    if (timer)
+        *timer = hw_timer_s{};
+}
+
+void timerAttachInterrupt(hw_timer_t *timer, void (*fn)(), bool)
+{
+    if (timer)
+        timer->fn = fn;
+}
+
+void timerDetachInterrupt(hw_timer_t *timer)
+{
+    if (timer)
+        timer->fn = nullptr;
+}
+
+void timerAlarmWrite(hw_timer_t *timer, uint64_t alarmValue, bool autoreload)
+{
+    if (!timer)
+        return;
+    const uint64_t us = alarmValue * timer->divider / 80u;
+    timer->periodUs = us ? us : 1;
+    timer->autoreload = autoreload;
+}
+
+void timerAlarmEnable(hw_timer_t *timer)
+{
+    if (!timer)
+        return;
+    timer->armed = true;
+    timer->dueUs = clockUs + timer->periodUs;
+}
+
+void timerAlarmDisable(hw_timer_t *timer)
+{
+    if (timer)
+        timer->armed = false;
+}
+
+// ================= Print / Serial =================
+
+size_t Print::write(const uint8_t *buffer, size_t size)
+{
+    size_t n = 0;
+    while (size--)
+        n += write(*buffer++);
+    return n;
+}
+
+size_t Print::write(const char *str)
+{
+    return str ? write((const uint8_t *)str, strlen(str)) : 0;
+}
+
+size_t Print::print(const __FlashStringHelper *s) { return write(reinterpret_cast<const char *>(s)); }
+size_t Print::print(const String &s) { return write(s.c_str()); }
+size_t Print::print(const char *s) { return write(s); }
+size_t Print::print(char c) { return write((uint8_t)c); }
+
+size_t Print::print(long n, int base)
+{
+    if (base == DEC)
+        return printf("%ld", n);
+    if (n < 0)
+        return print('-') + print((unsigned long)-n, base);
+    return print((unsigned long)n, base);
+}
+
+size_t Print::print(unsigned long n, int base)
+{
+    if (base == DEC)
+        return printf("%lu", n);
+    if (base == HEX)
+        return printf("%lX", n);
+    char buf[8 * sizeof(long) + 1];
+    char *p = &buf[sizeof(buf) - 1];
+    *p = '\0';
+    if (base < 2)
+        base = 10;
+    do
+    {
+        unsigned long d = n % (unsigned long)base;
+        *--p = (char)(d < 10 ? '0' + d : 'A' + d - 10);
+        n /= (unsigned long)base;
+    } while (n);
+    return write(p);
+}
+
+size_t Print::print(double n, int digits)
+{
+    return printf("%.*f", digits, n);
+}
+
+size_t Print::println() { return write("\r\n"); }
+
+size_t Print::printf(const char *fmt, ...)
+{
+    va_list ap;
+    va_start(ap, fmt);
+    size_t n = vprintf(fmt, ap);
+    va_end(ap);
+    return n;
+}
+
+size_t Print::vprintf(const char *fmt, va_list ap)
+{
+    char small[128];
+    va_list copy;
+    va_copy(copy, ap);
+    int len = vsnprintf(small, sizeof(small), fmt, copy);
+    va_end(copy);
+    if (len < 0)
+        return 0;
+    if ((size_t)len < sizeof(small))
+        return write((const uint8_t *)small, (size_t)len);
+    std::vector<char> big((size_t)len + 1);
+    vsnprintf(big.data(), big.size(), fmt, ap);
+    return write((const uint8_t *)big.data(), (size_t)len);
+}
+
+size_t HardwareSerial::write(uint8_t c)
+{
+    writeOut(&c, 1);
+    return 1;
+}
+
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size)
+{
+    writeOut(buffer, size);
+    return size;
+}
+
+int HardwareSerial::available() { return (int)serialIn.size(); }
+
+int HardwareSerial::read()
+{
+    if (serialIn.empty())
+        return -1;
+    int c = serialIn.front();
+    serialIn.pop_front();
+    return c;
+}
+
+int HardwareSerial::peek() { return serialIn.empty() ? -1 : serialIn.front(); }
+
+// ================= Wire =================
+
+bool TwoWire::begin(int, int, uint32_t frequency)
+{
+    if (frequency)
+        _clock = frequency;
+    return true;
+}
+
+bool TwoWire::setClock(uint32_t frequency)
+{
+    if (frequency)
+        _clock = frequency;
+    return true;
+}
+
+void TwoWire::spend(size_t bytes)
+{
+    // START + address byte + data bytes, 9 clocks each (ACK included), + STOP
+    uint64_t bits = 2 + 9 * (1 + (uint64_t)bytes);
+    hal::advanceUs((bits * 1000000u + _clock - 1) / _clock);
+}
+
+void TwoWire::beginTransmission(uint8_t address)
+{
+    _txAddr = address;
+    _txLen = 0;
+}
+
+uint8_t TwoWire::endTransmission(bool)
+{
+    i2cStats.txns++;
+    i2cStats.bytes += _txLen;
+    spend(_txLen);
+
+    if (_txAddr == TCA_ADDR)
+    {
+        if (_txLen > 0)
+            tcaMask = _tx[_txLen - 1];
+        return 0;
+    }
+
+    hal::I2CDevice *dev = route(_txAddr);
+    if (!dev || !dev->onWrite(_tx, _txLen))
+    {
+        i2cStats.nacks++;
+        lastTarget = nullptr;
+        return 2; // address NACK
+    }
+    lastTarget = dev;
+    return 0;
+}
+
+uint8_t TwoWire::requestFrom(uint8_t address, uint8_t quantity, uint8_t)
+{
+    _rxLen = _rxPos = 0;
+    if (quantity > I2C_BUFFER_LENGTH)
+        quantity = I2C_BUFFER_LENGTH;
+
+    i2cStats.txns++;
+    i2cStats.bytes += quantity;
+    spend(quantity);
+
+    if (address == TCA_ADDR)
+    {
+        for (uint8_t i = 0; i < quantity; i++)
+            _rx[i] = tcaMask;
+        _rxLen = quantity;
+        return quantity;
+    }
+
+    hal::I2CDevice *dev = route(address);
+    if (!dev || !dev->onRead(_rx, quantity))
+    {
+        i2cStats.nacks++;
+        return 0;
+    }
+    _rxLen = quantity;
+    return quantity;
+}
+
+size_t TwoWire::write(uint8_t c)
+{
+    if (_txLen >= I2C_BUFFER_LENGTH)
+        return 0;
+    _tx[_txLen++] = c;
+    return 1;
+}
+
+size_t TwoWire::write(const uint8_t *data, size_t n)
+{
+    size_t w = 0;
+    while (w < n && write(data[w]))
+        w++;
+    return w;
+}
+
+int TwoWire::available() { return (int)(_rxLen - _rxPos); }
+int TwoWire::read() { return _rxPos < _rxLen ? _rx[_rxPos++] : -1; }
+int TwoWire::peek() { return _rxPos < _rxLen ? _rx[_rxPos] : -1; }
+
+// ================= EEPROM =================
+
+bool EEPROMClass::begin(size_t size)
+{
+    if (size > FLASH_SIZE)
+        return false;
+    _size = size;
+    return true;
+}
+
+uint8_t EEPROMClass::read(int address)
+{
+    if (address < 0 || (size_t)address >= _size)
+        return 0;
+    return _flash[address];
+}
+
+void EEPROMClass::write(int address, uint8_t value)
+{
+    if (address < 0 || (size_t)address >= _size)
+        return;
+    _flash[address] = value;
+}
+
+bool EEPROMClass::commit()
+{
+    _commits++;
+    return _size > 0;
+}
+
+void EEPROMClass::wipe()
+{
+    memset(_flash, 0xFF, sizeof(_flash));
+    _size = FLASH_SIZE;
+    _commits = 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+// Host-side control surface of the native HAL. Firmware code never includes
+// this; host programs (host/*.cpp) use it to drive time, pins and devices.
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include <string>
+
+namespace hal
+{
+    // ---------- Virtual clock ----------
+    // Time only moves when the firmware waits: delay(), I2C transfers (at the
+    // current SCL rate) and a small per-call cost for millis()/micros() so
+    // busy-wait loops always make progress. Hardware timer alarms fire at
+    // their own due times inside an advance.
+    uint64_t nowUs();
+    void advanceUs(uint64_t us);
+
+    // Jump straight to t (if in the future). Fake chips call this when the
+    // firmware spins on a not-ready status bit, so polling loops cost no
+    // host time.
+    void idleUntilUs(uint64_t t);
+
+    // Called after every clock advance with the new time. Used to step plant
+    // models and scripted input. Returns a handle for removeTickHook().
+    using TickHook = std::function<void(uint64_t nowUs)>;
+    int addTickHook(TickHook hook);
+    void removeTickHook(int handle);
+
+    // ---------- GPIO ----------
+    // Drive an input pin from the outside; fires attached interrupts.
+    void setPin(uint8_t pin, int level);
+    int pinLevel(uint8_t pin);
+
+    // ---------- LEDC ----------
+    uint32_t ledcDuty(uint8_t channel);
+
+    // ---------- Serial ----------
+    void serialEcho(bool on);           // mirror Serial output to stdout (default on)
+    void serialInject(const std::string &bytes); // queue bytes for Serial.read()
+    std::string serialTakeOutput();     // drain captured Serial output
+
+    // ---------- I2C ----------
+    class I2CDevice
+    {
+    public:
+        virtual ~I2CDevice() = default;
+        // One write (data phase only). Return false to NACK.
+        virtual bool onWrite(const uint8_t *data, size_t n) = 0;
+        // One read of n bytes following the last write.
+        virtual bool onRead(uint8_t *data, size_t n) = 0;
+    };
+
+    // muxCh < 0: on the main bus. Otherwise behind that TCA9548A channel.
+    void attachI2C(uint8_t addr, I2CDevice *dev, int8_t muxCh = -1);
+    void detachAllI2C();
+    uint8_t muxMask(); // channels currently enabled on the TCA9548A
+
+    struct I2CCounters
+    {
+        uint64_t txns, bytes, nacks;
+    };
+    I2CCounters i2cCounters();
+
+    // ---------- Whole-board reset ----------
+    // Clock back to 0, pins released, hooks/devices/EEPROM/LittleFS/
+    // Preferences/Serial cleared.
+    void reset();
+} // namespace hal
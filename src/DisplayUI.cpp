@@ -1,10 +1,17 @@
 #include "DisplayUI.h"
+#include "i2c_bus.h"
+#include "trace.h"
 #include <Wire.h>
 #include <Fonts/FreeSans9pt7b.h>
 
+#include <atomic>
+
 namespace
 {
-    Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET);
+    // Keep the driver's own during/after clocks at the bus manager's OLED
+    // rate so it never leaves the bus at a clock the manager doesn't know.
+    Adafruit_SSD1306 display(SCREEN_WIDTH, SCREEN_HEIGHT, &Wire, OLED_RESET,
+                             I2C_CLK_FAST, I2C_CLK_FAST);
 
     // Bitmaps taken from the provided sketch
     
@@ -35,6 +42,223 @@ namespace
     constexpr uint8_t selectToggleY[3] = {24, 36, 48};
     constexpr uint8_t yesNoToggleX[2] = {54, 96};
 
+    // ---------- Partial flush ----------
+    // shadow[] holds what the panel currently shows. Each flush diffs the
+    // GFX buffer against it one 8-row page at a time and only sends the
+    // changed column runs, using SSD1306 column/page addressing.
+    constexpr uint16_t FRAME_BYTES = SCREEN_WIDTH * SCREEN_HEIGHT / 8;
+    constexpr uint8_t PAGE_COUNT = SCREEN_HEIGHT / 8;
+    constexpr uint8_t DATA_CHUNK = 127; // I2C_BUFFER_LENGTH minus control byte
+    constexpr uint8_t RUN_GAP = 8;      // merge runs closer than a window header
+
+    uint8_t shadow[FRAME_BYTES];
+    // Set by invalidate() (any task) and after a failed send; the sender
+    // takes it with exchange(), so a request made mid-frame is never lost
+    std::atomic<bool> resendAll{true};
+
+    // Written by the sender and by flush() (coalesced frames), read by
+    // flushStats(): all under pendingLock once the flush task exists
+    DisplayUI::FlushStats stats = {};
+#if DISPLAY_ASYNC_EN && defined(ESP32)
+    SemaphoreHandle_t pendingLock = nullptr;
+#endif
+
+    inline void statsLock()
+    {
+#if DISPLAY_ASYNC_EN && defined(ESP32)
+        if (pendingLock)
+            xSemaphoreTake(pendingLock, portMAX_DELAY);
+#endif
+    }
+
+    inline void statsUnlock()
+    {
+#if DISPLAY_ASYNC_EN && defined(ESP32)
+        if (pendingLock)
+            xSemaphoreGive(pendingLock);
+#endif
+    }
+
+    // Set the GRAM window and stream the data into it. Returns bytes sent.
+    uint16_t sendWindow(uint8_t page, uint8_t x0, uint8_t x1, const uint8_t *data, bool &ok)
+    {
+        const uint8_t cmd[7] = {0x00, // Co = 0, D/C = 0: command stream
+                                SSD1306_COLUMNADDR, x0, x1,
+                                SSD1306_PAGEADDR, page, page};
+        ok &= I2CBus::write(I2CDev::Oled, OLED_ADDR, cmd, sizeof(cmd));
+        uint16_t sent = sizeof(cmd);
+
+        uint8_t chunk[DATA_CHUNK + 1];
+        chunk[0] = 0x40; // Co = 0, D/C = 1: data stream
+        uint16_t len = (uint16_t)(x1 - x0 + 1);
+        while (len > 0)
+        {
+            uint8_t n = len > DATA_CHUNK ? DATA_CHUNK : (uint8_t)len;
+            memcpy(chunk + 1, data, n);
+            ok &= I2CBus::write(I2CDev::Oled, OLED_ADDR, chunk, n + 1);
+            sent += n + 1;
+            data += n;
+            len -= n;
+        }
+        return sent;
+    }
+
+    void sendFrame(const uint8_t *buf)
+    {
+        TRACE_SCOPE("oled.send_frame");
+        const bool full = resendAll.exchange(false);
+        uint16_t sent = 0;
+        bool ok = true;
+
+        I2CLease lease(I2CDev::Oled);
+        for (uint8_t page = 0; page < PAGE_COUNT; page++)
+        {
+            const uint8_t *row = buf + page * SCREEN_WIDTH;
+            uint8_t *old = shadow + page * SCREEN_WIDTH;
+
+            int x = 0;
+            while (x < SCREEN_WIDTH)
+            {
+                // start of the next changed run
+                while (x < SCREEN_WIDTH && !full && row[x] == old[x])
+                    x++;
+                if (x >= SCREEN_WIDTH)
+                    break;
+
+                // extend it until RUN_GAP unchanged columns in a row
+                int x0 = x, x1 = x, same = 0;
+                for (++x; x < SCREEN_WIDTH && same < RUN_GAP; x++)
+                {
+                    if (full || row[x] != old[x])
+                    {
+                        x1 = x;
+                        same = 0;
+                    }
+                    else
+                    {
+                        same++;
+                    }
+                }
+
+                sent += sendWindow(page, (uint8_t)x0, (uint8_t)x1, row + x0, ok);
+                memcpy(old + x0, row + x0, x1 - x0 + 1);
+            }
+        }
+
+        // A failed write leaves the panel unknown: resend everything next time
+        if (!ok)
+            resendAll.store(true);
+
+        statsLock();
+        stats.frames++;
+        stats.totalBytes += sent;
+        stats.lastBytes = sent;
+        if (sent > stats.maxBytes)
+            stats.maxBytes = sent;
+        statsUnlock();
+    }
+
+    // ---------- Asynchronous flush ----------
+    // The GFX buffer is the back buffer. present() copies it into pending[]
+    // and wakes the flush task, which sends pending[] no faster than the
+    // frame-rate cap. A newer frame simply overwrites an unsent one.
+    volatile uint32_t minFrameMs = 1000 / DISPLAY_MAX_FPS;
+
+#if DISPLAY_ASYNC_EN && defined(ESP32)
+    uint8_t pending[FRAME_BYTES];
+    uint8_t front[FRAME_BYTES];
+    bool pendingFull = false;
+    TaskHandle_t flushTask = nullptr;
+
+    void flushTaskMain(void *)
+    {
+        uint32_t lastMs = 0;
+        for (;;)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+            uint32_t since = millis() - lastMs;
+            if (since < minFrameMs)
+                vTaskDelay(pdMS_TO_TICKS(minFrameMs - since));
+
+            xSemaphoreTake(pendingLock, portMAX_DELAY);
+            bool have = pendingFull;
+            if (have)
+                memcpy(front, pending, FRAME_BYTES);
+            pendingFull = false;
+            xSemaphoreGive(pendingLock);
+
+            if (have)
+            {
+                lastMs = millis();
+                sendFrame(front);
+            }
+        }
+    }
+#endif
+
+    bool flushHeld = false;
+
+    void flush()
+    {
+        TRACE_SCOPE("ui.flush");
+        if (flushHeld)
+            return;
+#if DISPLAY_ASYNC_EN && defined(ESP32)
+        if (flushTask)
+        {
+            xSemaphoreTake(pendingLock, portMAX_DELAY);
+            if (pendingFull)
+                stats.coalesced++;
+            memcpy(pending, display.getBuffer(), FRAME_BYTES);
+            pendingFull = true;
+            xSemaphoreGive(pendingLock);
+            xTaskNotifyGive(flushTask);
+            return;
+        }
+#endif
+        sendFrame(display.getBuffer());
+    }
+
+    // Yes/No question: up to two centred lines above the buttons, broken
+    // at the last space that fits (a longer second line is cut)
+    constexpr uint8_t QUESTION_LINE_CHARS = SCREEN_WIDTH / 6; // default 6x8 font
+    constexpr uint8_t questionLineY[2] = {5, 16};
+
+    void printCentredLine(uint8_t row, const char *text, size_t len)
+    {
+        if (len > QUESTION_LINE_CHARS)
+            len = QUESTION_LINE_CHARS;
+        display.setCursor((SCREEN_WIDTH - 6 * (int)len) / 2 + 1, questionLineY[row]);
+        for (size_t i = 0; i < len; i++)
+            display.write(text[i]);
+    }
+
+    void printQuestion(const __FlashStringHelper *question)
+    {
+        char text[2 * QUESTION_LINE_CHARS + 2];
+        strncpy_P(text, (const char *)question, sizeof(text) - 1);
+        text[sizeof(text) - 1] = '\0';
+        size_t len = strlen(text);
+
+        if (len <= QUESTION_LINE_CHARS)
+        {
+            printCentredLine(1, text, len); // one line sits next to the buttons
+            return;
+        }
+        size_t brk = QUESTION_LINE_CHARS;
+        while (brk > 0 && text[brk] != ' ')
+            brk--;
+        if (brk == 0)
+            brk = QUESTION_LINE_CHARS; // one long word: hard break
+        printCentredLine(0, text, brk);
+
+        const char *rest = text + brk;
+        while (*rest == ' ')
+            rest++;
+        printCentredLine(1, rest, strlen(rest));
+    }
+
     inline int clampIndex(int idx, int max)
     {
         if (idx < 0) return 0;
@@ -48,9 +272,9 @@ namespace DisplayUI
 
     bool begin()
     {
-        Wire.begin(OLED_SDA_PIN, OLED_SCL_PIN);
-        Wire.setClock(100000);
+        I2CBus::begin(OLED_SDA_PIN, OLED_SCL_PIN);
 
+        I2CLease lease(I2CDev::Oled);
         if (!display.begin(SSD1306_SWITCHCAPVCC, OLED_ADDR))
         {
             return false;
@@ -60,7 +284,16 @@ namespace DisplayUI
         display.setTextColor(SSD1306_WHITE);
         display.setTextSize(1);
         display.setTextWrap(false);
-        display.display();
+        flush();
+
+#if DISPLAY_ASYNC_EN && defined(ESP32)
+        if (!flushTask)
+        {
+            pendingLock = xSemaphoreCreateMutex();
+            xTaskCreatePinnedToCore(flushTaskMain, "oled", DISPLAY_TASK_STACK, nullptr,
+                                    DISPLAY_TASK_PRIO, &flushTask, DISPLAY_TASK_CORE);
+        }
+#endif
         return true;
     }
 
@@ -69,24 +302,50 @@ namespace DisplayUI
         return display;
     }
 
+    void invalidate()
+    {
+        resendAll.store(true);
+    }
+
+    void holdFlush(bool hold)
+    {
+        flushHeld = hold;
+    }
+
+    void setMaxFrameRate(uint8_t fps)
+    {
+        minFrameMs = fps ? 1000u / fps : 0;
+    }
+
+    FlushStats flushStats()
+    {
+        statsLock();
+        const FlushStats s = stats;
+        statsUnlock();
+        return s;
+    }
+
     void showInitError(const __FlashStringHelper *msg)
     {
+        TRACE_SCOPE("ui.init_error");
         display.clearDisplay();
         display.setCursor(0, 0);
         display.setTextSize(1);
         display.println(msg);
-        display.display();
+        flush();
     }
 
     void showSplash()
     {
+        TRACE_SCOPE("ui.splash");
         display.clearDisplay();
         display.drawBitmap(0, -1, logoBit, 128, 64, 1);
-        display.display();
+        flush();
     }
 
     void showModeSelection(int selectionIndex)
     {
+        TRACE_SCOPE("ui.mode_selection");
         selectionIndex = clampIndex(selectionIndex, 2);
 
         display.clearDisplay();
@@ -109,7 +368,7 @@ namespace DisplayUI
 
         display.drawBitmap(3, selectToggleY[selectionIndex], selectBit, 16, 9, 1);
 
-        display.display();
+        flush();
     }
 
     void showSensorShowcase(float tempC,
@@ -119,6 +378,7 @@ namespace DisplayUI
                             uint8_t b8,
                             float brightness)
     {
+        TRACE_SCOPE("ui.sensor_showcase");
         display.clearDisplay();
 
         display.drawLine(0, 12, 127, 12, 0);
@@ -155,11 +415,12 @@ namespace DisplayUI
         display.setCursor(34, 51);
         display.printf("%.1f%%", brightness * 100.0f);
 
-        display.display();
+        flush();
     }
 
-    void showToastingProcess(float progress01)
+    void showToastingProcess(float progress01, int32_t etaS)
     {
+        TRACE_SCOPE("ui.toasting");
         if (progress01 < 0.0f)
             progress01 = 0.0f;
         if (progress01 > 1.0f)
@@ -174,6 +435,11 @@ namespace DisplayUI
         display.setTextWrap(false);
         display.setCursor(21, 24);
         display.print(F("TOASTING"));
+        if (etaS >= 0)
+        {
+            display.setCursor(21, 12);
+            display.printf("%ld:%02ld", (long)(etaS / 60), (long)(etaS % 60));
+        }
 
         const int barXStart = 22;
         const int barWidth = 6;
@@ -190,11 +456,12 @@ namespace DisplayUI
             display.fillRect(x, 37, barWidth, barHeight, 1);
         }
 
-        display.display();
+        flush();
     }
 
     void showToastReady()
     {
+        TRACE_SCOPE("ui.toast_ready");
         display.clearDisplay();
 
         display.drawBitmap(44, 18, toasterBit, 40, 32, 1);
@@ -207,11 +474,12 @@ namespace DisplayUI
         display.setCursor(41, 52);
         display.print(F("IS READY"));
 
-        display.display();
+        flush();
     }
 
     void showPlaceBread(bool showFrozen, float extraPercent)
     {
+        TRACE_SCOPE("ui.place_bread");
         display.clearDisplay();
 
         display.drawBitmap(45, 29, image_download_bits, 38, 32, 1);
@@ -240,11 +508,12 @@ namespace DisplayUI
             display.drawRect(2, 46, 41, 13, 1);
         }
 
-        display.display();
+        flush();
     }
 
     void showCalibrating(float weightG)
     {
+        TRACE_SCOPE("ui.calibrating");
         display.clearDisplay();
 
         display.drawBitmap(45, 18, image_OLED_Screens__Smart_Toaster__10__bits, 38, 32, 1);
@@ -260,12 +529,13 @@ namespace DisplayUI
         display.setCursor(93, 54);
         display.printf("%.1fg", weightG);
 
-        display.display();
+        flush();
     }
 
     void showYesNo(int yesOrNoIndex,
                    const __FlashStringHelper *question)
     {
+        TRACE_SCOPE("ui.yes_no");
         yesOrNoIndex = clampIndex(yesOrNoIndex, 1);
 
         display.clearDisplay();
@@ -274,12 +544,7 @@ namespace DisplayUI
 
         display.setTextColor(1);
         display.setTextWrap(false);
-        display.setCursor(11, 5);
-        display.print(F("Is the Temperature"));
-        display.setCursor(6, 22);
-        display.print(F(""));
-        display.setCursor(35, 16);
-        display.print(F("Jig Setup?"));
+        printQuestion(question);
 
         display.setCursor(33, 38);
         display.print(F("YES"));
@@ -290,7 +555,7 @@ namespace DisplayUI
         display.drawLine(64, 31, 64, 51, 1);
         display.drawBitmap(yesNoToggleX[yesOrNoIndex], 36, clickIcon, 7, 16, 1);
 
-        display.display();
+        flush();
     }
 
 } // namespace DisplayUI
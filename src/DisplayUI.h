@@ -12,12 +12,42 @@ constexpr int OLED_SDA_PIN  = 21;      // ESP32 SDA
 constexpr int OLED_SCL_PIN  = 22;      // ESP32 SCL
 constexpr int OLED_ADDR     = 0x3C;    // 0x3C or 0x3D
 constexpr int OLED_RESET    = -1;      // -1 if reset not on a GPIO
+
+// Rendering only fills the back buffer; a flush task pushes frames to the
+// panel so show*() never waits on I2C. Set to 0 to flush inline.
+#define DISPLAY_ASYNC_EN      1
+#define DISPLAY_MAX_FPS       25      // default cap, see setMaxFrameRate()
+#define DISPLAY_TASK_CORE     0
+#define DISPLAY_TASK_PRIO     1       // below the sensor task
+#define DISPLAY_TASK_STACK    3072
 // ---------------------------------
 
 namespace DisplayUI {
 
   bool begin();
+
+  // Drawing through this directly and calling display() bypasses the
+  // partial-flush shadow; call invalidate() afterwards.
   Adafruit_SSD1306 &getDisplay();
+  void invalidate(); // next flush resends the whole frame
+
+  // Render-only mode: show*() still compose into the back buffer but
+  // nothing is sent to the panel (host benchmarks, headless runs).
+  void holdFlush(bool hold);
+
+  // Frames submitted faster than this are coalesced (latest frame wins)
+  void setMaxFrameRate(uint8_t fps);
+
+  // Bytes written to the panel (command + data, control bytes included)
+  struct FlushStats
+  {
+    uint32_t frames;
+    uint32_t totalBytes;
+    uint16_t lastBytes; // last frame; 0 = nothing changed
+    uint16_t maxBytes;
+    uint32_t coalesced; // submitted frames replaced before being sent
+  };
+  FlushStats flushStats();
 
   void showInitError(const __FlashStringHelper *msg = F("Display init failed"));
 
@@ -34,8 +64,8 @@ namespace DisplayUI {
                           uint8_t b8,
                           float brightness);
 
-  // Toasting progress: 0..1
-  void showToastingProcess(float progress01);
+  // Toasting progress: 0..1, and the estimated time left (< 0 = unknown)
+  void showToastingProcess(float progress01, int32_t etaS = -1);
 
   // Toast done screen
   void showToastReady();
@@ -46,7 +76,7 @@ namespace DisplayUI {
   // Calibrating added weight (shows current grams)
   void showCalibrating(float weightG);
 
-  // Yes/No dialog
+  // Yes/No dialog; the question is centred, wrapped over two lines at most
   void showYesNo(int yesOrNoIndex,
                  const __FlashStringHelper *question = F("Start toasting?"));
 
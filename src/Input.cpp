@@ -1,14 +1,138 @@
 #include "Input.h"
 
+#include <esp_timer.h>
+#if ENC_PCNT_EN && defined(ESP32)
+#include <driver/pcnt.h>
+#endif
+
+#include "spsc_queue.h"
+#include "trace.h"
+
 namespace
 {
     volatile int encoderPos = 0;
     volatile int lastA = 0;
-    int lastReported = 0;
 
-    bool buttonPressed = false;
-    unsigned long lastDebounce = 0;
-    bool lastButtonState = HIGH;
+    // Timer ISR state
+    int emittedPos = 0;
+    uint32_t lastClickUs = 0;
+    uint32_t avgClickUs = 0; // smoothed time per click, 0 = from rest
+    int8_t lastDir = 0;
+    uint8_t stableLevel = HIGH;
+    uint8_t diffTicks = 0;
+    uint32_t pressedAtUs = 0;
+    bool longSent = false;
+
+    SpscQueue<InputEvent, INPUT_QUEUE_EVENTS> queue;
+    volatile bool buttonDown = false;
+    volatile uint32_t dropped = 0;
+
+#if defined(ESP32)
+    TaskHandle_t consumer = nullptr;
+#endif
+
+#if ENC_PCNT_EN && defined(ESP32)
+    // The unit counts in (-PCNT_WRAP, PCNT_WRAP) and drops to 0 at either
+    // limit, so its value is the position mod PCNT_WRAP; the tick folds
+    // the difference into encoderPos long before that matters.
+    constexpr int16_t PCNT_WRAP = 16384;
+    constexpr pcnt_unit_t PCNT_UNIT = (pcnt_unit_t)ENC_PCNT_UNIT;
+    bool pcntOn = false;
+    int16_t lastCount = 0;
+
+    bool pcntBegin()
+    {
+        pcnt_config_t cfg = {};
+        cfg.pulse_gpio_num = ENC_PIN_A;
+        cfg.ctrl_gpio_num = ENC_PIN_B;
+        cfg.unit = PCNT_UNIT;
+        cfg.channel = PCNT_CHANNEL_0;
+        // Same sense as handleEncoder(): +1 when A == B after an A edge
+        cfg.pos_mode = PCNT_COUNT_INC;
+        cfg.neg_mode = PCNT_COUNT_DEC;
+        cfg.hctrl_mode = PCNT_MODE_KEEP;
+        cfg.lctrl_mode = PCNT_MODE_REVERSE;
+        cfg.counter_h_lim = PCNT_WRAP;
+        cfg.counter_l_lim = -PCNT_WRAP;
+        if (pcnt_unit_config(&cfg) != ESP_OK || pcnt_set_filter_value(PCNT_UNIT, ENC_PCNT_FILTER) != ESP_OK ||
+            pcnt_filter_enable(PCNT_UNIT) != ESP_OK)
+            return false;
+        pcnt_counter_pause(PCNT_UNIT);
+        pcnt_counter_clear(PCNT_UNIT);
+        pcnt_counter_resume(PCNT_UNIT);
+        lastCount = 0;
+        return true;
+    }
+#endif
+
+    int IRAM_ATTR readPosition()
+    {
+#if ENC_PCNT_EN && defined(ESP32)
+        if (pcntOn)
+        {
+            int16_t count = 0;
+            pcnt_get_counter_value(PCNT_UNIT, &count);
+            int d = (count - lastCount) & (PCNT_WRAP - 1);
+            if (d >= PCNT_WRAP / 2)
+                d -= PCNT_WRAP;
+            lastCount = count;
+            encoderPos = encoderPos + d;
+        }
+#endif
+        return encoderPos;
+    }
+
+    // Clicks -> steps. Integer only: the FPU is off limits in an ISR.
+    int IRAM_ATTR accelerate(uint32_t now, int clicks)
+    {
+#if ENC_ACCEL_EN
+        const int8_t dir = clicks > 0 ? 1 : -1;
+        const uint32_t n = clicks > 0 ? clicks : -clicks;
+        const uint32_t per = (now - lastClickUs) / n;
+        lastClickUs = now;
+        if (dir != lastDir || per >= 1000000u / ENC_ACCEL_START_HZ)
+            avgClickUs = 0; // reversed, or slow enough to count as a fresh start
+        else
+            avgClickUs = avgClickUs ? (3 * avgClickUs + per) / 4 : per;
+        lastDir = dir;
+
+        const uint32_t hz = avgClickUs ? 1000000u / avgClickUs : 0;
+        uint32_t mult = 1;
+        if (hz > ENC_ACCEL_START_HZ)
+            mult += (hz - ENC_ACCEL_START_HZ) / ENC_ACCEL_HZ_PER_X;
+        if (mult > ENC_ACCEL_MAX)
+            mult = ENC_ACCEL_MAX;
+        return clicks * (int)mult;
+#else
+        (void)now;
+        return clicks;
+#endif
+    }
+
+    inline int16_t IRAM_ATTR clamp16(int v)
+    {
+        return v > INT16_MAX ? INT16_MAX : (v < INT16_MIN ? INT16_MIN : v);
+    }
+
+    bool IRAM_ATTR emit(uint32_t tUs, InputEventType type, int16_t steps = 0, int16_t detents = 0)
+    {
+        if (!queue.push({tUs, type, steps, detents}))
+            return false;
+#if defined(ESP32)
+        BaseType_t woken = pdFALSE;
+        if (consumer)
+            vTaskNotifyGiveFromISR(consumer, &woken);
+        if (woken)
+            portYIELD_FROM_ISR();
+#endif
+        return true;
+    }
+
+    void IRAM_ATTR emitOrDrop(uint32_t tUs, InputEventType type)
+    {
+        if (!emit(tUs, type))
+            dropped = dropped + 1;
+    }
 }
 
 void IRAM_ATTR handleEncoder()
@@ -28,6 +152,44 @@ void IRAM_ATTR handleEncoder()
         }
         lastA = a;
     }
+    TRACE_INSTANT("isr.encoder", encoderPos);
+}
+
+void IRAM_ATTR handleInputTick()
+{
+    const uint32_t now = (uint32_t)esp_timer_get_time();
+
+    // Rotation: the whole clicks since the last event. If the queue is
+    // full they just carry over to a later tick.
+    const int clicks = clamp16((readPosition() - emittedPos) / ENC_COUNTS_PER_DETENT);
+    if (clicks != 0 && emit(now, InputEventType::Rotate, clamp16(accelerate(now, clicks)), (int16_t)clicks))
+        emittedPos += clicks * ENC_COUNTS_PER_DETENT;
+
+    // Button: a new level counts once it has held for the debounce window
+    const uint8_t level = digitalRead(ENC_PIN_SW) ? HIGH : LOW;
+    if (level == stableLevel)
+        diffTicks = 0;
+    else if (++diffTicks >= INPUT_DEBOUNCE_TICKS)
+    {
+        stableLevel = level;
+        diffTicks = 0;
+        buttonDown = level == LOW;
+        if (buttonDown)
+        {
+            pressedAtUs = now;
+            longSent = false;
+            emitOrDrop(now, InputEventType::Press);
+        }
+        else
+            emitOrDrop(now, InputEventType::Release);
+        TRACE_INSTANT("isr.button", buttonDown);
+    }
+
+    if (buttonDown && !longSent && now - pressedAtUs >= INPUT_LONG_PRESS_MS * 1000u)
+    {
+        longSent = true;
+        emitOrDrop(now, InputEventType::LongPress);
+    }
 }
 
 namespace Input
@@ -41,54 +203,89 @@ namespace Input
         pinMode(ENC_PIN_SW, INPUT_PULLUP);
 
         lastA = digitalRead(ENC_PIN_A);
+        emittedPos = encoderPos;
+        avgClickUs = 0;
+        lastDir = 0;
+        diffTicks = 0;
+        longSent = false;
+        queue.clear();
+        stableLevel = digitalRead(ENC_PIN_SW) ? HIGH : LOW;
+        buttonDown = stableLevel == LOW;
 
-        attachInterrupt(digitalPinToInterrupt(ENC_PIN_A), handleEncoder, CHANGE);
-        attachInterrupt(digitalPinToInterrupt(ENC_PIN_B), handleEncoder, CHANGE);
-    }
+        bool decoded = false;
+#if ENC_PCNT_EN && defined(ESP32)
+        pcntOn = decoded = pcntBegin();
+        if (!pcntOn)
+            Serial.println(F("[IN] PCNT unavailable, encoder on interrupts"));
+#endif
+        if (!decoded)
+        {
+            attachInterrupt(digitalPinToInterrupt(ENC_PIN_A), handleEncoder, CHANGE);
+            attachInterrupt(digitalPinToInterrupt(ENC_PIN_B), handleEncoder, CHANGE);
+        }
 
-    int getEncoderDelta()
-    {
-        int current = encoderPos;
-        int delta = current - lastReported;
-        lastReported = current;
-        return delta;
+#if defined(ESP32)
+        consumer = xTaskGetCurrentTaskHandle();
+#endif
+        // 1 us ticks; the ISR is allocated on this core, next to the encoder's.
+        // Core 2.x timer API (platformio.ini pins the platform).
+        hw_timer_t *t = timerBegin(INPUT_TIMER_NUM, 80, true);
+        if (!t)
+        {
+            Serial.println(F("[IN] timer unavailable, no button events"));
+            return;
+        }
+        timerAttachInterrupt(t, handleInputTick, false); // level: 2.x has no edge timer interrupts
+        timerAlarmWrite(t, INPUT_TICK_US, true);
+        timerAlarmEnable(t);
     }
 
-    void resetEncoder()
+    bool pending()
     {
-        lastReported = encoderPos;
+        return !queue.empty();
     }
 
-    void updateButton()
+    bool waitPending(uint32_t timeoutMs)
     {
-        const unsigned long debounceMs = 20;
-        bool reading = digitalRead(ENC_PIN_SW);
-        unsigned long now = millis();
-
-        if (reading != lastButtonState && (now - lastDebounce) > debounceMs)
+        const uint32_t start = millis();
+        for (;;)
         {
-            lastDebounce = now;
-            lastButtonState = reading;
-            if (reading == LOW)
-            {
-                buttonPressed = true; // only on falling edge
-            }
+            if (!queue.empty())
+                return true;
+            const uint32_t waited = millis() - start;
+            if (timeoutMs != INPUT_WAIT_FOREVER && waited >= timeoutMs)
+                return false;
+#if defined(ESP32)
+            // A push between the check and here leaves the notification
+            // pending, so this returns at once
+            ulTaskNotifyTake(pdTRUE, timeoutMs == INPUT_WAIT_FOREVER ? portMAX_DELAY
+                                                                     : pdMS_TO_TICKS(timeoutMs - waited) + 1);
+#else
+            delay(1);
+#endif
         }
     }
 
-    bool consumeButtonPress()
+    bool nextEvent(InputEvent &ev, uint32_t timeoutMs)
     {
-        if (buttonPressed)
-        {
-            buttonPressed = false;
+        if (queue.pop(ev))
             return true;
-        }
-        return false;
+        return timeoutMs && waitPending(timeoutMs) && queue.pop(ev);
+    }
+
+    void flush()
+    {
+        queue.clear();
     }
 
     bool isButtonDown()
     {
-        return digitalRead(ENC_PIN_SW) == LOW;
+        return buttonDown;
+    }
+
+    uint32_t droppedEvents()
+    {
+        return dropped;
     }
 
 } // namespace Input
@@ -6,12 +6,74 @@ constexpr int ENC_PIN_A = 35;
 constexpr int ENC_PIN_B = 34;
 constexpr int ENC_PIN_SW = 32;
 
+// =============== User knobs ===============
+#define INPUT_TIMER_NUM 0          // ESP32 hardware timer that samples the button
+#define INPUT_TICK_US 1000         // sampling period
+#define INPUT_DEBOUNCE_TICKS 8     // button level must hold this many ticks to count
+#define INPUT_LONG_PRESS_MS 800    // held this long: one LongPress after the Press
+#define INPUT_QUEUE_EVENTS 32      // power of two
+
+#define ENC_PCNT_EN 1              // ESP32: quadrature in the pulse counter, no encoder interrupts
+#define ENC_PCNT_UNIT 0
+#define ENC_PCNT_FILTER 1023       // glitch filter in 80 MHz APB cycles (max 1023 = 12.8 us)
+#define ENC_COUNTS_PER_DETENT 1    // A edges per click
+#define ENC_ACCEL_EN 1             // scale Rotate steps with spin speed
+#define ENC_ACCEL_START_HZ 8       // clicks/s below which a click is one step
+#define ENC_ACCEL_HZ_PER_X 6       // every this much faster adds one step per click
+#define ENC_ACCEL_MAX 10           // steps per click at most
+// =========================================
+
+#define INPUT_WAIT_FOREVER 0xffffffffu
+
+// Input arrives as timestamped events instead of polled state. On the
+// ESP32 the encoder is decoded by a PCNT unit behind its glitch filter, so
+// turning it costs no CPU (without PCNT, or on the host, a pin ISR on A/B
+// does the same decode). A hardware timer every INPUT_TICK_US is the
+// single producer for the event queue: it turns position changes into
+// one Rotate per tick (a fast spin is never lost, only coalesced),
+// applies the speed-dependent acceleration, debounces the
+// button by requiring INPUT_DEBOUNCE_TICKS equal samples, and times long
+// presses. The task that called Input::begin() is notified on every push,
+// so UI loops sleep in nextEvent() instead of spinning on delay().
+
+enum class InputEventType : uint8_t
+{
+    Rotate,   // detents = +n clockwise / -n; steps = the same, accelerated
+    Press,    // debounced falling edge
+    Release,
+    LongPress // still held INPUT_LONG_PRESS_MS after the Press
+};
+
+struct InputEvent
+{
+    uint32_t tUs; // esp_timer time the timer tick saw it
+    InputEventType type;
+    int16_t steps;   // Rotate: clicks times the acceleration; lists and numbers scroll by this
+    int16_t detents; // Rotate: clicks as turned; pick-one-of-few menus move by the sign
+};
+
 namespace Input
 {
+    // Pins, ISRs and the sampling timer. Call from the task that will
+    // consume events (the Arduino loop task).
     void begin();
-    int getEncoderDelta();
-    void resetEncoder();
-    void updateButton();
-    bool consumeButtonPress();
+
+    // Next event, waiting up to timeoutMs (0 = don't wait,
+    // INPUT_WAIT_FOREVER). False on timeout.
+    bool nextEvent(InputEvent &ev, uint32_t timeoutMs);
+
+    // An event is queued
+    bool pending();
+
+    // Sleep until an event is queued (true, left queued) or timeoutMs passes
+    bool waitPending(uint32_t timeoutMs);
+
+    // Drop everything queued, e.g. the tail of the click that opened a screen
+    void flush();
+
+    // Debounced level
     bool isButtonDown();
+
+    // Events lost to a full queue since boot (rotation is never lost)
+    uint32_t droppedEvents();
 } // namespace Input
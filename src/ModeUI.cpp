@@ -2,272 +2,587 @@
 #include "DisplayUI.h"
 #include "Input.h"
 #include "sensorManager.h"
+#include "i2c_bus.h"
+#include "browning.h"
+#include "cycle_log.h"
+#include "loss_fit.h"
+#include "settle_detector.h"
+#include "boot.h"
+#include "scheduler.h"
 
 namespace
 {
-    int selectionIndex = 0;
-    int yesOrNoIndex = 0;
-}
+    // Start temperature -> moisture-loss target (see lossFractionForStartTemp)
+    constexpr float COLD_TEMP_C = 12.5f;
+    constexpr float WARM_TEMP_C = 20.0f;
+    constexpr float COLD_LOSS_FRAC = 0.15f;
+    constexpr float WARM_LOSS_FRAC = 0.10f;
 
-namespace ModeUI
-{
+    // Placement / settling: 8 samples at 50 ms = 400 ms window
+    constexpr uint8_t WEIGHT_WINDOW = 8;
+    constexpr unsigned long WEIGHT_PERIOD_MS = 50;
+    constexpr unsigned long WAIT_FOR_BREAD_MS = 15000; // then take whatever is on the scale
+    constexpr unsigned long MAX_SETTLE_MS = 5000;      // then take the current reading
 
-    void begin()
+    // Toasting: fixed 10 Hz control tick, 5-minute fail-safe
+    constexpr unsigned long CONTROL_PERIOD_MS = 100;
+    constexpr unsigned long MAX_TOAST_MS = 5UL * 60UL * 1000UL;
+
+    // Temperature guide: hold this long once the jig reads at least
+    // TEMP_STABLE_C and statistically flat
+    constexpr float TEMP_STABLE_C = 120.0f;
+    constexpr unsigned long POST_STABLE_HOLD_MS = 150000;
+
+    // Sensor showcase refresh; a mode picked before the sensors are up
+    // re-checks this often
+    constexpr uint32_t SHOWCASE_PERIOD_MS = 10;
+    constexpr uint32_t SENSORS_POLL_MS = 5;
+
+    // Stop this far ahead of the predicted crossing, for whatever keeps
+    // drying the slice after the cycle ends (element and crust heat)
+    constexpr float STOP_LEAD_S = 0.0f;
+
+    // Colour-guided cycles still stop on weight, but only once this many
+    // times the usual moisture loss has gone (a slice that will not brown)
+    constexpr float COLOUR_BACKSTOP_LOSS_X = 1.5f;
+
+    // Noise floor is learned; this is the quietest the scale can claim and
+    // the smallest change that counts as bread placed
+    SettleConfig weightSettleConfig()
     {
-        selectionIndex = 0;
-        yesOrNoIndex = 0;
-        Input::resetEncoder();
-        DisplayUI::showModeSelection(selectionIndex);
+        SettleConfig c;
+        c.minNoise = 0.02f;
+        c.minStep = 3.0f;
+        return c;
     }
 
-    bool mainMenuStep(Mode &selectedMode)
+#if SENSOR_TASK_EN && defined(ESP32)
+    constexpr bool sensorTaskOn = true;
+#else
+    constexpr bool sensorTaskOn = false;
+#endif
+
+    // Encoder picks yes/no, a click answers
+    class YesNoDialog : public Coroutine
     {
-        int delta = Input::getEncoderDelta();
-        if (delta != 0)
+    public:
+        void start(const __FlashStringHelper *question)
         {
-            selectionIndex += (delta > 0 ? 1 : -1);
-            if (selectionIndex < 0)
-                selectionIndex = 2;
-            if (selectionIndex > 2)
-                selectionIndex = 0;
-            DisplayUI::showModeSelection(selectionIndex);
+            _question = question;
+            _index = 0;
+            restart();
         }
 
-        Input::updateButton();
-        if (!Input::consumeButtonPress())
-        {
-            return false;
-        }
+        bool yes() const { return _index == 0; }
 
-        switch (selectionIndex)
+        CoStatus step() override
         {
-        case 0:
-            selectedMode = Mode::Toast;
-            break;
-        case 1:
-            selectedMode = Mode::Sensors;
-            break;
-        case 2:
-            selectedMode = Mode::Logo;
-            break;
-        default:
-            selectedMode = Mode::Toast;
-            break;
+            CO_BEGIN();
+            Input::flush();
+            DisplayUI::showYesNo(_index, _question);
+            for (;;)
+            {
+                CO_WAIT_INPUT(_ev);
+                if (_ev.type == InputEventType::Press)
+                    break;
+                if (_ev.type == InputEventType::Rotate)
+                {
+                    _index += (_ev.detents > 0 ? 1 : -1);
+                    if (_index < 0)
+                        _index = 1;
+                    if (_index > 1)
+                        _index = 0;
+                    DisplayUI::showYesNo(_index, _question);
+                }
+            }
+            while (Input::isButtonDown())
+                CO_WAIT_INPUT(_ev);
+            CO_END();
         }
 
-        return true;
-    }
+    private:
+        const __FlashStringHelper *_question = nullptr;
+        int _index = 0;
+        InputEvent _ev{};
+    };
 
-    bool runYesNoDialog()
+    // Place the slice, wait for the weight to settle, toast until a stop
+    // condition, then hold "Toast Ready" until a click
+    class ToastFlow : public Coroutine
     {
-        yesOrNoIndex = 0;
-        Input::resetEncoder();
-        DisplayUI::showYesNo(yesOrNoIndex, F("Is the Temperature Jig Setup?"));
+    public:
+        void start(ToastGuide guide)
+        {
+            _guide = guide;
+            restart();
+        }
 
-        for (;;)
+        const ToastResult &result() const { return _result; }
+
+        CoStatus step() override
         {
-            int delta = Input::getEncoderDelta();
-            if (delta != 0)
+            CO_BEGIN();
+            beginPlacement();
+            _placeRate.start(WEIGHT_PERIOD_MS);
+            for (;;)
             {
-                yesOrNoIndex += (delta > 0 ? 1 : -1);
-                if (yesOrNoIndex < 0)
-                    yesOrNoIndex = 1;
-                if (yesOrNoIndex > 1)
-                    yesOrNoIndex = 0;
-                DisplayUI::showYesNo(yesOrNoIndex, F("Is the Temperature Jig Setup?"));
+                _placeRate.beginTick();
+                _tickDone = placementTick();
+                _placeRate.endTick();
+                if (_tickDone)
+                    break;
+                CO_SLEEP_UNTIL(_placeRate.nextMs());
             }
 
-            Input::updateButton();
-            if (Input::consumeButtonPress())
+            beginToasting();
+            _controlRate.start(CONTROL_PERIOD_MS);
+            for (;;)
             {
-                while (Input::isButtonDown())
-                {
-                    delay(10);
-                }
-                return (yesOrNoIndex == 0); // true = temp-guided, false = weight-only
+                _controlRate.beginTick();
+                _tickDone = toastTick();
+                _controlRate.endTick();
+                if (_tickDone)
+                    break;
+                CO_SLEEP_UNTIL(_controlRate.nextMs());
             }
+            finish();
 
-            delay(5);
+            // Hold on the "Toast Ready" screen until user clicks to exit;
+            // clicks made during the cycle don't count
+            Input::flush();
+            do
+            {
+                CO_WAIT_INPUT(_ev);
+            } while (_ev.type != InputEventType::Press);
+            while (Input::isButtonDown())
+                CO_WAIT_INPUT(_ev);
+            CO_END();
         }
-    }
 
-    void runToastingFlow(bool tempGuided)
+    private:
+        void beginPlacement();
+        bool placementTick(); // true once the starting weight is taken
+        void beginToasting();
+        bool toastTick(); // true once a stop condition fired
+        void finish();
+
+        ToastGuide _guide = ToastGuide::Weight;
+        bool _tempGuided = false;
+        bool _colourGuided = false;
+        FixedRate _placeRate{"place"};
+        FixedRate _controlRate{"control"};
+        bool _tickDone = false;
+        InputEvent _ev{};
+
+        // Placement and settling
+        float _breadStartTempC = 0.0f;
+        float _lossFrac = 0.0f;
+        SettleDetector<WEIGHT_WINDOW> _weightDet;
+        float _baseline = 0.0f;
+        float _startWeight = 0.0f;
+        bool _placed = false;
+        unsigned long _waitStart = 0;
+        unsigned long _placedAt = 0;
+        unsigned long _settledAt = 0;
+
+        // Toasting
+        float _targetWeight = 0.0f;
+        float _stopWeight = 0.0f;
+        float _requiredLoss = 0.0f;
+        unsigned long _startMs = 0;
+        bool _tempStable = false;
+        unsigned long _tempStableStart = 0;
+        LossCurveFit _lossFit;
+        float _weightLagS = 0.0f;
+        float _stopLeadS = 0.0f;
+        float _shownProgress = 0.0f;
+        BrowningTracker _browning;
+        uint32_t _brownSinceMs = 0;
+        bool _brownAtTarget = false;
+        ToastResult _result{};
+    };
+
+    void ToastFlow::beginPlacement()
     {
+        _tempGuided = _guide == ToastGuide::Temp;
+        _colourGuided = _guide == ToastGuide::Colour;
+
         // --- Capture initial bread temperature for loss adjustment ---
         sensorsUpdate();
         SensorSnapshot initialSnap = getSensorSnapshot();
-        float breadStartTempC = initialSnap.tempC;
-
-        // Map temp to loss fraction: <=12.5C -> 15% loss, >=20C -> 10% loss, linear in between
-        const float coldTempC = 12.5f;
-        const float warmTempC = 20.0f;
-        const float coldLossFrac = 0.15f;
-        const float warmLossFrac = 0.10f;
-        float lossFrac = warmLossFrac;
-        if (breadStartTempC <= coldTempC)
-        {
-            lossFrac = coldLossFrac;
-        }
-        else if (breadStartTempC >= warmTempC)
-        {
-            lossFrac = warmLossFrac;
-        }
-        else
-        {
-            float t = (breadStartTempC - coldTempC) / (warmTempC - coldTempC); // 0..1
-            lossFrac = coldLossFrac - t * (coldLossFrac - warmLossFrac);
-        }
-        bool showFrozen = breadStartTempC < warmTempC;
-        float extraPercent = (lossFrac - warmLossFrac) * 100.0f;
+        _breadStartTempC = initialSnap.tempC;
+
+        _lossFrac = ModeUI::lossFractionForStartTemp(_breadStartTempC);
+        bool showFrozen = _breadStartTempC < WARM_TEMP_C;
+        float extraPercent = (_lossFrac - WARM_LOSS_FRAC) * 100.0f;
         if (extraPercent < 0.0f)
             extraPercent = 0.0f;
 
-        // --- Determine starting weight (detect bread placement) ---
-        float baseline = initialSnap.weightG;
-        float startWeight = baseline;
-        const float addedThresholdG = 5.0f;     // change to detect bread
-        const unsigned long waitForBreadMs = 15000; // max wait 15s
-        unsigned long waitStart = millis();
+        // --- Detect bread placement, then wait for the reading to settle ---
+        // Placement is a positive step out of the empty-scale trend; the
+        // baseline is where that trend stood. Both phases end as soon as the
+        // window is quiet relative to the learned noise floor.
+        _weightDet = SettleDetector<WEIGHT_WINDOW>(weightSettleConfig());
+        _baseline = initialSnap.weightG;
+        _startWeight = _baseline;
+        _placed = false;
+        _waitStart = millis();
+        _placedAt = 0;
+        _settledAt = 0;
 
         DisplayUI::showPlaceBread(showFrozen, extraPercent);
+    }
 
-        for (;;)
+    bool ToastFlow::placementTick()
+    {
+        sensorsUpdate();
+        SensorSnapshot s = getSensorSnapshot();
+        float w = s.weightG;
+        SettleEvent ev = _weightDet.push(w);
+        unsigned long now = millis();
+
+        if (!_placed)
         {
-            sensorsUpdate();
-            SensorSnapshot s = getSensorSnapshot();
-            float w = s.weightG;
-            if (fabsf(w - baseline) > addedThresholdG)
+            if (ev == SettleEvent::Step && _weightDet.stepSize() > 0.0f)
             {
-                startWeight = w;
-                break;
+                _baseline = _weightDet.stepFrom();
+                _placed = true;
+                _placedAt = now;
             }
-            if (millis() - waitStart > waitForBreadMs)
+            else if (now - _waitStart > WAIT_FOR_BREAD_MS)
             {
-                startWeight = w; // fallback to whatever is on the scale
-                break;
+                _placed = true; // fallback to whatever is on the scale
+                _placedAt = now;
             }
-            delay(50);
+            else if (_weightDet.settled())
+            {
+                _baseline = _weightDet.stats().mean();
+            }
+            return false;
         }
 
-        // --- Show calibrating screen until weight stabilizes ---
-        const float stableDeltaG = 0.5f;
-        const unsigned long stableWindowMs = 1000;
-        unsigned long stableStart = millis();
-        float lastW = startWeight;
-        for (;;)
+        DisplayUI::showCalibrating(w - _baseline);
+        if (_weightDet.settled())
         {
-            sensorsUpdate();
-            SensorSnapshot s = getSensorSnapshot();
-            float w = s.weightG;
-            DisplayUI::showCalibrating(w - baseline);
+            _startWeight = _weightDet.stats().mean();
+            _settledAt = now;
+            return true;
+        }
+        if (now - _placedAt > MAX_SETTLE_MS)
+        {
+            _startWeight = w;
+            _settledAt = now;
+            return true;
+        }
+        return false;
+    }
 
-            if (fabsf(w - lastW) < stableDeltaG)
+    void ToastFlow::beginToasting()
+    {
+        // --- Toast until target weight loss achieved ---
+        _targetWeight = _startWeight * (1.0f - _lossFrac);
+        _stopWeight = _colourGuided ? _startWeight * (1.0f - _lossFrac * COLOUR_BACKSTOP_LOSS_X) : _targetWeight;
+        _requiredLoss = _startWeight - _stopWeight;
+        _startMs = millis();
+
+        // --- Optional temperature stabilization ---
+        // Stable = filtered reading above threshold and its rate statistically
+        // flat (the sensor task's estimator), however long that took
+        _tempStable = false;
+        _tempStableStart = 0;
+
+        // Predictive weight stop: fit the loss curve, and stop on the tick
+        // nearest the moment the load (not the lagging reading) crosses
+        // the target
+        _lossFit = LossCurveFit(CONTROL_PERIOD_MS / 1000.0f);
+        _lossFit.reset(_startWeight);
+        _weightLagS = sensorsWeightLagS();
+        _stopLeadS = STOP_LEAD_S + CONTROL_PERIOD_MS / 2000.0f;
+        _shownProgress = 0.0f;
+
+        // Colour stop: the fused index holds the target for BROWN_CONFIRM_MS
+        _browning = BrowningTracker();
+        _browning.begin();
+        _brownSinceMs = 0;
+        _brownAtTarget = false;
+
+        _result = ToastResult{};
+        _result.breadStartTempC = _breadStartTempC;
+        _result.startWeightG = _startWeight;
+        _result.targetWeightG = _targetWeight;
+        _result.lossFrac = _lossFrac;
+        _result.settleMs = _settledAt - _placedAt;
+
+        CycleLog::startCycle(_guide, CONTROL_PERIOD_MS, _startWeight, _targetWeight, _lossFrac, _breadStartTempC);
+    }
+
+    bool ToastFlow::toastTick()
+    {
+        sensorsUpdate();
+        SensorSnapshot s = getSensorSnapshot();
+        CycleLog::sample(s);
+        float w = s.weightG;
+
+        // Track temperature stabilization if enabled
+        if (_tempGuided)
+        {
+            if (s.tempFiltC >= TEMP_STABLE_C && s.tempFlat)
             {
-                if (millis() - stableStart > stableWindowMs)
+                if (!_tempStable)
                 {
-                    startWeight = w;
-                    break;
+                    _tempStable = true;
+                    _tempStableStart = millis();
                 }
             }
             else
             {
-                stableStart = millis();
+                _tempStable = false;
+                _tempStableStart = 0;
             }
-            lastW = w;
-            delay(100);
         }
 
-        // --- Toast until target weight loss achieved ---
-        const float targetWeight = startWeight * (1.0f - lossFrac);
-        const float requiredLoss = startWeight - targetWeight;
-        const unsigned long maxToastMs = 5UL * 60UL * 1000UL; // 5-minute fail-safe
-        unsigned long startMs = millis();
+        if (_browning.update())
+        {
+            const bool at = _browning.valid() && _browning.index() >= BROWN_TARGET;
+            if (at && !_brownAtTarget)
+                _brownSinceMs = millis();
+            _brownAtTarget = at;
+        }
 
-        // --- Optional temperature stabilization ---
-        bool tempStable = false;
-        unsigned long tempStableStart = 0;
-        const float tempThresholdC = 120.0f;       // reach at least ~120C
-        const float tempDeltaStable = 0.5f;        // change within 0.5C
-        const unsigned long tempStableWindow = 20000; // 20 seconds within band
-        const unsigned long postStableHoldMs = 150000; // 2.5 minutes after stable
-        float lastTemp = 0.0f;
-
-        for (;;)
+        // Seconds from now until the load reaches the target, <0 unknown
+        _lossFit.push(w);
+        float weightEtaS = _lossFit.timeTo(_stopWeight);
+        if (weightEtaS > 0.0f)
+            weightEtaS = fmaxf(weightEtaS - _weightLagS, 0.0f);
+
+        unsigned long elapsed = millis() - _startMs;
+        float weightProgress = 0.0f;
+        if (weightEtaS >= 0.0f)
         {
-            sensorsUpdate();
-            SensorSnapshot s = getSensorSnapshot();
-            float w = s.weightG;
-            float t = s.tempC;
+            weightProgress = elapsed / (elapsed + weightEtaS * 1000.0f + 1.0f);
+        }
+        else if (_requiredLoss > 0.01f)
+        {
+            weightProgress = (_startWeight - w) / _requiredLoss;
+        }
+        if (weightProgress < 0.0f)
+            weightProgress = 0.0f;
+        if (weightProgress > 1.0f)
+            weightProgress = 1.0f;
+
+        // Shown ETA: whichever stop comes first
+        float etaS = weightEtaS;
+        if (_colourGuided && _browning.valid())
+        {
+            weightProgress = max(weightProgress, (float)_browning.index() / BROWN_TARGET);
+            float colourEtaS = _browning.timeTo(BROWN_TARGET);
+            if (colourEtaS >= 0.0f && (etaS < 0.0f || colourEtaS < etaS))
+                etaS = colourEtaS;
+        }
+        float timeProgress = 0.0f;
+        if (_tempGuided && _tempStable && _tempStableStart > 0)
+        {
+            unsigned long sinceStable = millis() - _tempStableStart;
+            timeProgress = (float)sinceStable / (float)POST_STABLE_HOLD_MS;
+            if (timeProgress > 1.0f)
+                timeProgress = 1.0f;
+            float holdLeftS = (1.0f - timeProgress) * POST_STABLE_HOLD_MS / 1000.0f;
+            if (etaS < 0.0f || holdLeftS < etaS)
+                etaS = holdLeftS;
+        }
+
+        // The fitted ETA can move either way; the bar only fills
+        float progress = _tempGuided ? max(weightProgress, timeProgress) : weightProgress;
+        _shownProgress = max(_shownProgress, progress);
+
+        DisplayUI::showToastingProcess(_shownProgress, etaS >= 0.0f ? (int32_t)(etaS + 0.5f) : -1);
+
+        // Until the fit has a falling trend, the plain reading decides
+        bool weightDone = _lossFit.valid() ? (weightEtaS >= 0.0f && weightEtaS <= _stopLeadS)
+                                           : (w <= _stopWeight);
+        bool colourDone = _colourGuided && _brownAtTarget && (millis() - _brownSinceMs >= BROWN_CONFIRM_MS);
+        bool tempHoldDone = _tempGuided && _tempStable && _tempStableStart > 0 &&
+                            (millis() - _tempStableStart >= POST_STABLE_HOLD_MS);
+        if (!(weightDone || tempHoldDone || colourDone || elapsed >= MAX_TOAST_MS))
+            return false;
+
+        _result.stopWeightG = w;
+        _result.toastMs = elapsed;
+        _result.stopAtMs = millis();
+        _result.brownIndex = _browning.index();
+        _result.reason = colourDone     ? ToastStop::Colour
+                         : weightDone   ? ToastStop::Weight
+                         : tempHoldDone ? ToastStop::TempHold
+                                        : ToastStop::Timeout;
+        return true;
+    }
+
+    void ToastFlow::finish()
+    {
+        CycleLog::endCycle(_result);
+
+        // Work time per control tick: compare SENSOR_TASK_EN 0 vs 1 to see
+        // what inline acquisition costs; the [RATE] lines show whether the
+        // 10 Hz held
+        const FixedRate::Stats &st = _controlRate.stats();
+        if (st.ticks)
+            Serial.printf("[TOAST] loop work avg=%luus max=%luus n=%lu (sensor task %s)\n",
+                          (unsigned long)(st.workSumUs / st.ticks), (unsigned long)st.workMaxUs,
+                          (unsigned long)st.ticks, sensorTaskOn ? "on" : "off");
+        _controlRate.print(Serial);
+        I2CBus::printStats(Serial);
+        DisplayUI::FlushStats fs = DisplayUI::flushStats();
+        if (fs.frames)
+            Serial.printf("[OLED] frames=%lu avg=%luB/frame max=%uB last=%uB coalesced=%lu\n",
+                          (unsigned long)fs.frames, (unsigned long)(fs.totalBytes / fs.frames),
+                          fs.maxBytes, fs.lastBytes, (unsigned long)fs.coalesced);
+        DisplayUI::showToastReady();
+    }
+
+    ToastFlow toastFlow;
 
-            // Track temperature stabilization if enabled
-            if (tempGuided)
+    // The whole UI, forever: menu, then the picked mode, then back
+    class MainUi : public Coroutine
+    {
+    public:
+        bool inMenu() const { return _inMenu; }
+
+        CoStatus step() override
+        {
+            CO_BEGIN();
+            for (;;)
             {
-                if (t >= tempThresholdC && fabsf(t - lastTemp) < tempDeltaStable)
+                DisplayUI::showModeSelection(_selection);
+                Input::flush();
+                _inMenu = true;
+                for (;;)
+                {
+                    CO_WAIT_INPUT(_ev);
+                    if (_ev.type == InputEventType::Press)
+                        break;
+                    if (_ev.type == InputEventType::Rotate)
+                    {
+                        _selection += (_ev.detents > 0 ? 1 : -1);
+                        if (_selection < 0)
+                            _selection = 2;
+                        if (_selection > 2)
+                            _selection = 0;
+                        DisplayUI::showModeSelection(_selection);
+                    }
+                }
+                _inMenu = false;
+
+                // A mode picked while the sensors are still coming up waits for them
+                CO_WAIT_UNTIL(Boot::sensorsReady(), SENSORS_POLL_MS);
+
+                if (_selection == (int)Mode::Toast)
+                {
+                    // Clear any residual press from the menu selection
+                    while (Input::isButtonDown())
+                        CO_WAIT_INPUT(_ev);
+
+                    _guide = ToastGuide::Weight;
+                    _dialog.start(F("Is the Temperature Jig Setup?"));
+                    CO_AWAIT(_dialog);
+                    if (_dialog.yes()) // jig set up: temperature-assisted
+                        _guide = ToastGuide::Temp;
+                    else
+                    {
+                        _dialog.start(F("Stop on toast colour?"));
+                        CO_AWAIT(_dialog);
+                        if (_dialog.yes())
+                            _guide = ToastGuide::Colour;
+                    }
+                    toastFlow.start(_guide);
+                    CO_AWAIT(toastFlow);
+                }
+                else if (_selection == (int)Mode::Sensors)
                 {
-                    if (!tempStable)
+                    I2CBus::resetStats();
+                    _showcaseRate.start(SHOWCASE_PERIOD_MS);
+                    while (!pressed())
                     {
-                        tempStable = true;
-                        tempStableStart = millis();
+                        _showcaseRate.beginTick();
+                        showSensors();
+                        _showcaseRate.endTick();
+                        CO_SLEEP_UNTIL(_showcaseRate.nextMs());
                     }
+                    I2CBus::printStats(Serial);
                 }
                 else
                 {
-                    tempStable = false;
-                    tempStableStart = 0;
+                    DisplayUI::showSplash();
+                    do
+                    {
+                        CO_WAIT_INPUT(_ev);
+                    } while (_ev.type != InputEventType::Press);
                 }
-                lastTemp = t;
-            }
 
-            float weightProgress = 0.0f;
-            if (requiredLoss > 0.01f)
-            {
-                weightProgress = (startWeight - w) / requiredLoss;
+                while (Input::isButtonDown())
+                    CO_WAIT_INPUT(_ev);
             }
-            if (weightProgress < 0.0f)
-                weightProgress = 0.0f;
-            if (weightProgress > 1.0f)
-                weightProgress = 1.0f;
+            CO_END();
+        }
 
-            float timeProgress = 0.0f;
-            if (tempGuided && tempStable && tempStableStart > 0)
-            {
-                unsigned long sinceStable = millis() - tempStableStart;
-                timeProgress = (float)sinceStable / (float)postStableHoldMs;
-                if (timeProgress > 1.0f)
-                    timeProgress = 1.0f;
-            }
+    private:
+        // A click queued since the last look
+        bool pressed()
+        {
+            InputEvent ev;
+            while (Input::nextEvent(ev, 0))
+                if (ev.type == InputEventType::Press)
+                    return true;
+            return false;
+        }
 
-            float progress = tempGuided ? max(weightProgress, timeProgress) : weightProgress;
+        void showSensors()
+        {
+            sensorsUpdate();
+            SensorSnapshot s = getSensorSnapshot();
+            DisplayUI::showSensorShowcase(s.tempC, s.weightG, s.r8, s.g8, s.b8, s.brightness);
+        }
 
-            DisplayUI::showToastingProcess(progress);
+        int _selection = 0;
+        bool _inMenu = false;
+        ToastGuide _guide = ToastGuide::Weight;
+        FixedRate _showcaseRate{"showcase"};
+        InputEvent _ev{};
+        YesNoDialog _dialog;
+    };
 
-            unsigned long elapsed = millis() - startMs;
-            bool weightDone = (w <= targetWeight);
-            bool tempHoldDone = tempGuided && tempStable && tempStableStart > 0 && (millis() - tempStableStart >= postStableHoldMs);
-            if (weightDone || tempHoldDone || elapsed >= maxToastMs)
-            {
-                break;
-            }
+    MainUi mainUi;
+}
 
-            delay(100);
-        }
+namespace ModeUI
+{
 
-        DisplayUI::showToastReady();
+    void begin()
+    {
+        // First step right away: the menu is on the panel when this returns
+        Sched::start("ui", mainUi);
+        mainUi.step();
+    }
 
-        // Hold on the "Toast Ready" screen until user clicks to exit
-        for (;;)
-        {
-            Input::updateButton();
-            if (Input::consumeButtonPress())
-            {
-                while (Input::isButtonDown())
-                {
-                    delay(2);
-                }
-                break;
-            }
-            delay(5);
-        }
+    bool inMenu()
+    {
+        return mainUi.inMenu();
+    }
+
+    float lossFractionForStartTemp(float breadStartTempC)
+    {
+        if (breadStartTempC <= COLD_TEMP_C)
+            return COLD_LOSS_FRAC;
+        if (breadStartTempC >= WARM_TEMP_C)
+            return WARM_LOSS_FRAC;
+        float t = (breadStartTempC - COLD_TEMP_C) / (WARM_TEMP_C - COLD_TEMP_C); // 0..1
+        return COLD_LOSS_FRAC - t * (COLD_LOSS_FRAC - WARM_LOSS_FRAC);
+    }
+
+    ToastResult runToastingFlow(ToastGuide guide)
+    {
+        toastFlow.start(guide);
+        Sched::runUntilDone(toastFlow);
+        return toastFlow.result();
     }
 
 } // namespace ModeUI
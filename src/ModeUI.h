@@ -8,10 +8,54 @@ enum class Mode : uint8_t
     Logo = 2
 };
 
+// What ends a toasting cycle (the 5-minute fail-safe always applies)
+enum class ToastGuide : uint8_t
+{
+    Weight = 0, // target moisture loss
+    Temp = 1,   // moisture loss, or a hold once the jig reads a stable temperature
+    Colour = 2  // fused browning index reaches BROWN_TARGET (moisture loss as a backstop)
+};
+
+// Why a toasting cycle ended
+enum class ToastStop : uint8_t
+{
+    Weight = 0,   // target moisture loss reached
+    TempHold = 1, // temperature-guided hold elapsed
+    Timeout = 2,  // 5-minute fail-safe
+    Colour = 3    // browning index reached the target
+};
+
+// Outcome of one runToastingFlow(), for logging and host tuning runs
+struct ToastResult
+{
+    float breadStartTempC;
+    float startWeightG;
+    float targetWeightG;
+    float stopWeightG;
+    float lossFrac;       // loss fraction the target was derived from
+    uint32_t settleMs;    // bread detected -> starting weight accepted
+    uint32_t toastMs;     // toasting phase only (after the weight settled)
+    uint32_t stopAtMs;    // millis() when the stop condition fired
+    int16_t brownIndex;   // fused browning index at the stop (0 = as it went in)
+    ToastStop reason;
+};
+
 namespace ModeUI
 {
+    // Start the UI as a scheduler activity (a coroutine): the mode menu,
+    // the picked mode's flow, back to the menu. Draws the menu before
+    // returning.
     void begin();
-    bool mainMenuStep(Mode &selectedMode);
-    bool runYesNoDialog();
-    void runToastingFlow(bool tempGuided);
+
+    // In the mode menu, i.e. no flow running
+    bool inMenu();
+
+    // One toasting cycle from "place bread" to the click on "Toast Ready",
+    // blocking: runs the scheduler until it is done, with the UI paused.
+    // For host runs; the device runs the same flow from the menu.
+    ToastResult runToastingFlow(ToastGuide guide);
+
+    // Target moisture-loss fraction for a slice starting at this
+    // temperature: <=12.5C -> 15%, >=20C -> 10%, linear in between
+    float lossFractionForStartTemp(float breadStartTempC);
 } // namespace ModeUI
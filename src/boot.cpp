@@ -0,0 +1,151 @@
+#include "boot.h"
+
+#include <atomic>
+
+#include "DisplayUI.h"
+#include "Input.h"
+#include "ModeUI.h"
+#include "cycle_log.h"
+#include "sensorManager.h"
+
+namespace
+{
+    struct Stage
+    {
+        const char *name;
+        uint32_t startUs;
+        uint32_t endUs; // 0 = still running
+        uint8_t core;
+    };
+
+    // Stages claim a slot with one atomic add; the report reads them only
+    // after both sides have finished
+    Stage stages[BOOT_MAX_STAGES];
+    std::atomic<uint8_t> stageCount{0};
+    std::atomic<bool> reported{false};
+    std::atomic<bool> sensorsUp{false};
+    std::atomic<uint8_t> sidesDone{0};
+    uint32_t menuReadyMs = 0;
+    uint32_t sensorsReadyMs = 0;
+
+    inline uint8_t coreId()
+    {
+#if defined(ESP32)
+        return (uint8_t)xPortGetCoreID();
+#else
+        return 0;
+#endif
+    }
+
+    void report()
+    {
+        reported.store(true);
+        const uint8_t n = stageCount.load() < BOOT_MAX_STAGES ? stageCount.load() : BOOT_MAX_STAGES;
+        for (uint8_t i = 0; i < n; i++)
+        {
+            const Stage &st = stages[i];
+            if (!st.endUs)
+                continue;
+            Serial.printf("[BOOT] %-10s %5lu .. %5lu ms  core %u\n", st.name, (unsigned long)(st.startUs / 1000),
+                          (unsigned long)(st.endUs / 1000), (unsigned)st.core);
+        }
+        Serial.printf("[BOOT] menu ready %lu ms, sensors ready %lu ms\n", (unsigned long)menuReadyMs,
+                      (unsigned long)sensorsReadyMs);
+    }
+
+    // The menu side and the sensor side each call this once; the later one
+    // prints the breakdown
+    void sideDone()
+    {
+        if (sidesDone.fetch_add(1) + 1 == 2)
+            report();
+    }
+
+    void bringUpSensors()
+    {
+        sensorsBegin();
+        {
+            BootStage stage("cyclelog");
+            CycleLog::begin();
+        }
+        sensorsReadyMs = millis();
+        sensorsUp.store(true, std::memory_order_release);
+        sideDone();
+    }
+
+#if BOOT_PARALLEL_EN && defined(ESP32)
+    void bootTaskMain(void *)
+    {
+        bringUpSensors();
+        vTaskDelete(nullptr);
+    }
+#endif
+} // namespace
+
+BootStage::BootStage(const char *name) : _slot(-1)
+{
+    if (reported.load(std::memory_order_relaxed))
+        return;
+    const uint8_t i = stageCount.fetch_add(1);
+    if (i >= BOOT_MAX_STAGES)
+        return;
+    _slot = (int8_t)i;
+    stages[i] = {name, (uint32_t)micros(), 0, coreId()};
+}
+
+BootStage::~BootStage()
+{
+    if (_slot >= 0)
+    {
+        const uint32_t now = micros();
+        stages[_slot].endUs = now ? now : 1;
+    }
+}
+
+namespace Boot
+{
+    bool run()
+    {
+        {
+            BootStage stage("display");
+            if (!DisplayUI::begin())
+            {
+                DisplayUI::showInitError(F("SSD1306 alloc failed"));
+                return false;
+            }
+            DisplayUI::showSplash();
+        }
+        const uint32_t splashAt = millis();
+
+        // The sensor side needs the bus DisplayUI::begin() just started
+#if BOOT_PARALLEL_EN && defined(ESP32)
+        if (xTaskCreatePinnedToCore(bootTaskMain, "boot", BOOT_TASK_STACK, nullptr, BOOT_TASK_PRIO, nullptr,
+                                    BOOT_TASK_CORE) != pdPASS)
+            bringUpSensors();
+#else
+        bringUpSensors();
+#endif
+
+        {
+            BootStage stage("input");
+            Input::begin();
+        }
+        {
+            BootStage stage("splash");
+            while (millis() - splashAt < BOOT_SPLASH_MIN_MS)
+                delay(5);
+        }
+        {
+            BootStage stage("menu");
+            ModeUI::begin();
+        }
+        menuReadyMs = millis();
+        sideDone();
+        return true;
+    }
+
+    bool sensorsReady()
+    {
+        return sensorsUp.load(std::memory_order_acquire);
+    }
+} // namespace Boot
@@ -0,0 +1,48 @@
+#pragma once
+#include <Arduino.h>
+
+// =============== User knobs ===============
+#define BOOT_SPLASH_MIN_MS 500  // the logo stays up at least this long
+#define BOOT_PARALLEL_EN 1      // ESP32: bring the sensors up on core 0 behind the splash
+#define BOOT_TASK_CORE 0
+#define BOOT_TASK_PRIO 2        // the sensor task it starts runs at SENSOR_TASK_PRIO
+#define BOOT_TASK_STACK 6144    // bytes; sensorsBegin() + LittleFS mount
+#define BOOT_MAX_STAGES 16
+// =========================================
+
+// setup() in one call: display and splash first, then the sensors (settings,
+// MLX, scale zero, colour probe, first snapshot) and the cycle log on core 0
+// while core 1 brings up input and the menu. The menu appears as soon as
+// the splash has had BOOT_SPLASH_MIN_MS; a flow that needs the sensors
+// waits on Boot::sensorsReady() first (a coroutine wait, normally already
+// true by then).
+//
+// Every stage is timed (BootStage) and the breakdown is printed once both
+// sides are done:
+//
+//   [BOOT] display       31 ..   71 ms  core 1
+//   [BOOT] scale         72 ..  124 ms  core 0
+//   ...
+//   [BOOT] menu ready 592 ms, sensors ready 175 ms
+
+namespace Boot
+{
+    // False if the display could not be started (the error is shown and
+    // setup() should go no further)
+    bool run();
+
+    // Sensors, settings and the cycle log are up
+    bool sensorsReady();
+} // namespace Boot
+
+// Times the enclosing scope as one boot stage (from either core); a no-op
+// once the boot report has been printed
+class BootStage
+{
+public:
+    explicit BootStage(const char *name);
+    ~BootStage();
+
+private:
+    int8_t _slot;
+};
@@ -0,0 +1,182 @@
+#include "browning.h"
+
+// round(4096 * log2(1 + i/32)), i = 0..32
+static const uint16_t LOG2_MANT_Q12[33] PROGMEM = {
+    0, 182, 358, 530, 696, 858, 1016, 1169, 1319, 1465, 1607,
+    1746, 1882, 2015, 2145, 2272, 2396, 2518, 2637, 2754, 2869, 2982,
+    3092, 3200, 3307, 3412, 3514, 3615, 3715, 3812, 3908, 4003, 4096};
+
+// round(L*(i/256)), i = 0..256: 116 cbrt(Y) - 16, linear below Y = 0.008856
+static const uint8_t LSTAR_Q8[257] PROGMEM = {
+    0, 4, 7, 10, 13, 15, 17, 19, 21, 22, 23, 25, 26, 27, 28, 29,
+    30, 31, 32, 33, 34, 34, 35, 36, 37, 37, 38, 39, 39, 40, 41, 41,
+    42, 43, 43, 44, 44, 45, 45, 46, 46, 47, 48, 48, 48, 49, 49, 50,
+    50, 51, 51, 52, 52, 53, 53, 53, 54, 54, 55, 55, 56, 56, 56, 57,
+    57, 57, 58, 58, 59, 59, 59, 60, 60, 60, 61, 61, 61, 62, 62, 62,
+    63, 63, 63, 64, 64, 64, 65, 65, 65, 66, 66, 66, 66, 67, 67, 67,
+    68, 68, 68, 69, 69, 69, 69, 70, 70, 70, 70, 71, 71, 71, 72, 72,
+    72, 72, 73, 73, 73, 73, 74, 74, 74, 74, 75, 75, 75, 75, 76, 76,
+    76, 76, 77, 77, 77, 77, 77, 78, 78, 78, 78, 79, 79, 79, 79, 80,
+    80, 80, 80, 80, 81, 81, 81, 81, 81, 82, 82, 82, 82, 83, 83, 83,
+    83, 83, 84, 84, 84, 84, 84, 85, 85, 85, 85, 85, 86, 86, 86, 86,
+    86, 87, 87, 87, 87, 87, 88, 88, 88, 88, 88, 88, 89, 89, 89, 89,
+    89, 90, 90, 90, 90, 90, 90, 91, 91, 91, 91, 91, 92, 92, 92, 92,
+    92, 92, 93, 93, 93, 93, 93, 93, 94, 94, 94, 94, 94, 94, 95, 95,
+    95, 95, 95, 95, 96, 96, 96, 96, 96, 96, 97, 97, 97, 97, 97, 97,
+    98, 98, 98, 98, 98, 98, 98, 99, 99, 99, 99, 99, 99, 100, 100, 100,
+    100};
+
+int32_t browningLog2Q12(uint32_t x)
+{
+    if (x == 0)
+        return 0;
+    // x = 2^e * (1 + f), f in Q16; table in 32 steps, linear in between
+    const int e = 31 - __builtin_clz(x);
+    const uint32_t m = e >= 16 ? x >> (e - 16) : x << (16 - e);
+    const uint32_t f = m - 65536u;
+    const uint32_t i = f >> 11, rem = f & 2047u;
+    const int32_t lo = pgm_read_word(&LOG2_MANT_Q12[i]);
+    const int32_t hi = pgm_read_word(&LOG2_MANT_Q12[i + 1]);
+    return ((int32_t)e << 12) + lo + (((hi - lo) * (int32_t)rem) >> 11);
+}
+
+uint8_t browningLightness(uint32_t yQ8)
+{
+    return pgm_read_byte(&LSTAR_Q8[yQ8 > 256u ? 256u : yQ8]);
+}
+
+// ---------- Tracker ----------
+
+bool BrowningTracker::usable(const ColourReading &r)
+{
+    return r.seq != 0 && r.c16 >= BROWN_MIN_CLEAR && r.c16 <= BROWN_MAX_CLEAR && r.r16 > 0 && r.b16 > 0;
+}
+
+void BrowningTracker::begin()
+{
+    _beganMs = millis();
+    for (uint8_t i = 0; i < CS_COUNT; i++)
+    {
+        ColourReading r{};
+        colourGetReading((ColourSensorIdx)i, r);
+        _ch[i] = Channel();
+        _ch[i].seqAtBegin = r.seq;
+        _ch[i].lastSeq = r.seq;
+        _ch[i].lastMs = _beganMs;
+    }
+    _index = 0;
+    _lightness = 100;
+    _inliers = 0;
+    _trendMs = _beganMs;
+    _idxTrend.reset();
+    _timeTrend.reset();
+}
+
+bool BrowningTracker::update()
+{
+    const uint32_t now = millis();
+    bool fresh = false;
+    for (uint8_t i = 0; i < CS_COUNT; i++)
+    {
+        Channel &ch = _ch[i];
+        ColourReading r{};
+        colourGetReading((ColourSensorIdx)i, r);
+        if (r.seq == ch.lastSeq)
+        {
+            if (ch.ok && now - ch.lastMs > BROWN_STALE_MS)
+            {
+                ch.ok = false;
+                fresh = true;
+            }
+            continue;
+        }
+        ch.lastSeq = r.seq;
+        ch.lastMs = now;
+
+        // The frame in flight at begin() may straddle the slice going in
+        if (r.seq < ch.seqAtBegin + 2)
+            continue;
+
+        fresh = true;
+        ch.ok = usable(r);
+        if (!ch.ok)
+            continue;
+
+        const int32_t logRB = browningLog2Q12(r.r16) - browningLog2Q12(r.b16);
+        if (!ch.hasRef)
+        {
+            ch.refLog = logRB;
+            ch.refC = r.cScaled ? r.cScaled : 1;
+            ch.hasRef = true;
+        }
+        ch.index = (int16_t)(((logRB - ch.refLog) * 100) / 4096);
+        ch.lightness = browningLightness((uint32_t)(((uint64_t)r.cScaled << 8) / ch.refC));
+    }
+
+    if (fresh)
+        fuse();
+    return fresh;
+}
+
+void BrowningTracker::fuse()
+{
+    int16_t idx[CS_COUNT];
+    uint8_t which[CS_COUNT];
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < CS_COUNT; i++)
+        if (_ch[i].ok)
+        {
+            idx[n] = _ch[i].index;
+            which[n] = i;
+            n++;
+        }
+
+    _inliers = 0;
+    if (n == 0)
+        return;
+
+    // Median of up to three; only a majority can outvote a sensor
+    int16_t med = idx[0];
+    if (n == 3)
+    {
+        const int16_t a = idx[0], b = idx[1], c = idx[2];
+        med = max(min(a, b), min(max(a, b), c));
+    }
+
+    int32_t sumIdx = 0, sumL = 0;
+    for (uint8_t k = 0; k < n; k++)
+    {
+        if (n == 3 && abs(idx[k] - med) > BROWN_OUTLIER)
+            continue;
+        sumIdx += idx[k];
+        sumL += _ch[which[k]].lightness;
+        _inliers++;
+    }
+    _index = (int16_t)(sumIdx / _inliers);
+    _lightness = (uint8_t)(sumL / _inliers);
+
+    const uint32_t now = millis();
+    if (_idxTrend.count() != 0 && now - _trendMs < BROWN_TREND_MS)
+        return;
+    _trendMs = now;
+    _idxTrend.push(_index);
+    _timeTrend.push((now - _beganMs) / 1000.0f);
+}
+
+float BrowningTracker::ratePerS() const
+{
+    if (_idxTrend.count() < 3)
+        return 0.0f;
+    const float dt = _timeTrend.slope();
+    return dt > 0.0f ? _idxTrend.slope() / dt : 0.0f;
+}
+
+float BrowningTracker::timeTo(int16_t target) const
+{
+    if (!valid())
+        return -1.0f;
+    if (_index >= target)
+        return 0.0f;
+    const float rate = ratePerS();
+    return rate > 0.0f ? (target - _index) / rate : -1.0f;
+}
@@ -0,0 +1,85 @@
+#pragma once
+#include <Arduino.h>
+
+#include "colour.h"
+#include "settle_detector.h"
+
+// =============== User knobs ===============
+#define BROWN_TARGET 90        // fused index that ends a colour-guided cycle (~golden)
+#define BROWN_CONFIRM_MS 1200  // fused index must hold at/over target this long before stopping
+#define BROWN_OUTLIER 20       // a sensor this far from the median is ignored
+#define BROWN_MIN_CLEAR 40     // clear counts below this: no usable light
+#define BROWN_MAX_CLEAR 60000  // ... above this: saturating
+#define BROWN_STALE_MS 2000    // a sensor without a new frame for this long drops out
+#define BROWN_TREND_MS 600     // rate trend takes one fused reading per this interval
+// =========================================
+
+// Browning metrics from raw RGBC, integer math and lookup tables only.
+//
+// Index: 100 x the change in log2(R/B) since the slice went in. Maillard
+// products absorb blue far more than red, so the ratio climbs steadily as
+// the crust browns, and as a ratio it ignores light level, gain and how far
+// the slice sits from the sensor. 0 = as it went in; ~100 is golden.
+//
+// Lightness: CIE L* of the clear channel relative to the slice's own start
+// (100 = as it went in), so it needs no white calibration either. It uses
+// the exposure-scaled clear count, so auto-exposure steps do not show up.
+
+// log2(x) in Q12 (4096 = one octave); x > 0
+int32_t browningLog2Q12(uint32_t x);
+
+// L* (0..100) of a relative luminance given in Q8 (256 = 1.0, clamped)
+uint8_t browningLightness(uint32_t yQ8);
+
+// Fuses the three sensors into one index per frame. Sensors that are
+// missing, stale, dark or saturated drop out, and with all three in play
+// one that strays more than BROWN_OUTLIER from the median is ignored.
+class BrowningTracker
+{
+public:
+    // New cycle: each sensor's next whole frame becomes its reference
+    void begin();
+
+    // Polls the colour readings; true when a new fused value was formed
+    bool update();
+
+    bool valid() const { return _inliers > 0; }
+    int16_t index() const { return _index; }
+    uint8_t lightness() const { return _lightness; }
+    uint8_t inliers() const { return _inliers; }
+    int16_t sensorIndex(ColourSensorIdx i) const { return i < CS_COUNT ? _ch[i].index : 0; }
+
+    // Index points per second over the last few trend points
+    float ratePerS() const;
+    // Seconds until the index reaches target at that rate; <0 unknown
+    float timeTo(int16_t target) const;
+
+private:
+    struct Channel
+    {
+        uint32_t seqAtBegin = 0;
+        uint32_t lastSeq = 0;
+        uint32_t lastMs = 0;
+        int32_t refLog = 0; // log2(R/B) of the reference frame, Q12
+        uint32_t refC = 0; // exposure-scaled clear of the reference frame
+        bool hasRef = false;
+        bool ok = false;
+        int16_t index = 0;
+        uint8_t lightness = 100;
+    };
+
+    static bool usable(const ColourReading &r);
+    void fuse();
+
+    Channel _ch[CS_COUNT];
+    int16_t _index = 0;
+    uint8_t _lightness = 100;
+    uint8_t _inliers = 0;
+    uint32_t _beganMs = 0;
+    uint32_t _trendMs = 0;
+
+    // fused index and its time, one point per BROWN_TREND_MS (rate = ratio
+    // of slopes), so the window spans the same time at any frame rate
+    SlidingStats<8> _idxTrend;
+    SlidingStats<8> _timeTrend;
+};
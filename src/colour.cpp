@@ -1,12 +1,15 @@
 #include <Arduino.h>
 #include <Wire.h>
-#include <EEPROM.h>
 #include <Adafruit_TCS34725.h>
 
+#include <atomic>
+
 #include "colour.h"
 
 // ---------- TCA helper ----------
 #include "tca_breakout.h" // must define: inline void tcaSelect(int8_t ch);
+#include "i2c_bus.h"
+#include "settings.h"
 
 // ---------- One shared TCS object (we switch channels via TCA) ----------
 static Adafruit_TCS34725 TCS_breakout(
@@ -33,62 +36,240 @@ static constexpr float BRIGHTNESS = 0.8f; // master scaling 0..1
 // ---------- Per-sensor white reference ----------
 static uint16_t C_ref[CS_COUNT] = {1200, 1200, 1200};
 
-// ---------- Optional EEPROM persistence (ESP32 needs EEPROM.begin) ----------
-static constexpr int EEPROM_BASE = 0x00;
-static constexpr uint8_t EEPROM_SIG = 0xA5;
-static bool eeprom_ready = false;
+// ---------- Last-read storage (seqlock per sensor) ----------
+// Written by the acquisition side only, read from any core (browning index,
+// cycle log, snapshot). Odd sequence = store in progress.
+static ColourReading lastReading[CS_COUNT] = {};
+static std::atomic<uint32_t> lastReadingSeq[CS_COUNT] = {};
+
+static void storeReading(ColourSensorIdx idx, const ColourReading &r)
+{
+    const uint32_t seq = lastReadingSeq[idx].load(std::memory_order_relaxed);
+    lastReadingSeq[idx].store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    lastReading[idx] = r;
+    std::atomic_thread_fence(std::memory_order_release);
+    lastReadingSeq[idx].store(seq + 2, std::memory_order_release);
+}
+
+// ---------- Small helpers ----------
+static inline uint8_t clamp255(int v) { return v < 0 ? 0 : (v > 255 ? 255 : v); }
+
+static inline void setRGB(uint8_t r, uint8_t g, uint8_t b)
+{
+    ledcWrite(CH_R, r);
+    ledcWrite(CH_G, g);
+    ledcWrite(CH_B, b);
+}
+
+// ---------- Exposure ----------
+static constexpr uint8_t GAIN_X[4] = {1, 4, 16, 60};
+static constexpr ColourExposure EXPOSURE_REF = {TCS34725_INTEGRATIONTIME_614MS, TCS34725_GAIN_1X};
+
+static inline uint32_t exposureCycles(ColourExposure e) { return 256u - e.atime; }
+
+// The clear counter tops out at 1024 per cycle below 64 cycles
+static inline uint32_t exposureMaxCount(uint32_t cycles)
+{
+    return cycles >= 64 ? 65535u : cycles * 1024u;
+}
 
-static inline void eepromBeginIfNeeded()
+// Integration window plus a tick of margin for the internal oscillator
+static inline uint32_t exposureMs(ColourExposure e)
 {
-#if defined(ESP32)
-    if (!eeprom_ready)
+    return exposureCycles(e) * 12u / 5u + 1u;
+}
+
+uint32_t colourScaled(ColourExposure e, uint16_t counts)
+{
+    return (uint32_t)(((uint64_t)counts * 256u) / (exposureCycles(e) * GAIN_X[e.again & 3]));
+}
+
+ColourExposure colourNextExposure(ColourExposure cur, uint16_t c16)
+{
+#if COLOUR_AE_EN
+    const uint32_t cycles = exposureCycles(cur);
+    const uint32_t gain = GAIN_X[cur.again & 3];
+
+    // Clear counts per cycle at 1x, Q8. A saturated frame only gives a
+    // lower bound, so step well down and let the next frame refine it.
+    uint32_t rateQ8 = ((uint32_t)(c16 ? c16 : 1) << 8) / (cycles * gain);
+    if (c16 >= exposureMaxCount(cycles) * 95u / 100u)
+        rateQ8 *= 4;
+    if (rateQ8 == 0)
+        rateQ8 = 1;
+
+    ColourExposure next = {(uint8_t)(256u - COLOUR_AE_MIN_CYCLES), TCS34725_GAIN_1X};
+    for (int8_t g = 3; g >= 0; g--)
     {
-        EEPROM.begin(32);
-        eeprom_ready = true;
+        const uint32_t perCycle = rateQ8 * GAIN_X[g];
+        uint32_t n = ((uint32_t)COLOUR_AE_MIN_COUNTS * 256u + perCycle - 1) / perCycle;
+        if (n < COLOUR_AE_MIN_CYCLES)
+            n = COLOUR_AE_MIN_CYCLES;
+        if (n > 256)
+            n = 256;
+        const uint64_t expected = ((uint64_t)perCycle * n) >> 8;
+        if (expected * 100u <= (uint64_t)exposureMaxCount(n) * COLOUR_AE_TARGET_PCT)
+        {
+            next = {(uint8_t)(256u - n), (uint8_t)g};
+            break;
+        }
     }
+
+    // Noise alone should not rewrite the registers every frame
+    const uint32_t nextCycles = exposureCycles(next);
+    if (next.again == cur.again && nextCycles * 4 >= cycles * 3 && nextCycles * 3 <= cycles * 4)
+        return cur;
+    return next;
+#else
+    (void)cur;
+    (void)c16;
+    return EXPOSURE_REF;
 #endif
 }
 
-static inline void eepromLoadCrefs()
+// ---------- Asynchronous acquisition engine ----------
+// All three sensors free-run on their own mux channel, so their
+// integrations overlap; colourTickAll() only harvests finished frames.
+// Each one keeps its own exposure, so a dim sensor does not hold back
+// the frame rate of the others.
+
+enum class EnginePhase : uint8_t
 {
-    eepromBeginIfNeeded();
-    if (EEPROM.read(EEPROM_BASE) != EEPROM_SIG)
-        return;
-    for (int i = 0; i < CS_COUNT; i++)
+    Idle,       // needs a (re)start
+    Integrating // cycle running since startedMs
+};
+
+struct EngineState
+{
+    bool present = false;
+    EnginePhase phase = EnginePhase::Idle;
+    uint32_t startedMs = 0;
+    ColourExposure exposure = EXPOSURE_REF;
+};
+
+static EngineState engine[CS_COUNT];
+
+// STATUS, CDATAL..BDATAH are contiguous (0x13..0x1B): one burst read
+static constexpr uint8_t TCS_FRAME_LEN = 9;
+static constexpr uint8_t TCS_CMD_AUTOINC = TCS34725_COMMAND_BIT | 0x20;
+
+static inline void tcsWrite8(uint8_t reg, uint8_t value)
+{
+    const uint8_t buf[2] = {(uint8_t)(TCS34725_COMMAND_BIT | reg), value};
+    I2CBus::write(I2CDev::Colour, TCS34725_ADDRESS, buf, sizeof(buf));
+}
+
+static inline bool tcsReadFrame(uint8_t *frame)
+{
+    const uint8_t cmd = TCS_CMD_AUTOINC | TCS34725_STATUS;
+    return I2CBus::writeRead(I2CDev::Colour, TCS34725_ADDRESS, &cmd, 1, frame, TCS_FRAME_LEN);
+}
+
+static inline void tcsWriteExposure(ColourExposure e)
+{
+    tcsWrite8(TCS34725_ATIME, e.atime);
+    tcsWrite8(TCS34725_CONTROL, e.again);
+}
+
+// Part present (TCS34725/7 ID) -> powered on, not yet integrating
+static inline bool tcsProbe()
+{
+    const uint8_t cmd = TCS34725_COMMAND_BIT | TCS34725_ID;
+    uint8_t id = 0;
+    if (!I2CBus::writeRead(I2CDev::Colour, TCS34725_ADDRESS, &cmd, 1, &id, 1))
+        return false;
+    if (id != 0x44 && id != 0x4D && id != 0x10)
+        return false;
+    tcsWrite8(TCS34725_ENABLE, TCS34725_ENABLE_PON);
+    return true;
+}
+
+// Dropping AEN resets the RGBC state machine (and AVALID); setting it again
+// starts a fresh integration. PON stays on so there is no warm-up delay.
+static inline void tcsRestartIntegration()
+{
+    tcsWrite8(TCS34725_ENABLE, TCS34725_ENABLE_PON);
+    tcsWrite8(TCS34725_ENABLE, TCS34725_ENABLE_PON | TCS34725_ENABLE_AEN);
+}
+
+void colourNormalize(uint16_t cref, ColourReading &r)
+{
+    r.cref = cref;
+    r.cScaled = colourScaled(r.exposure, r.c16);
+    if (r.c16 < 5)
     {
-        int off = EEPROM_BASE + 1 + i * 2;
-        uint16_t v = (uint16_t)EEPROM.read(off) | ((uint16_t)EEPROM.read(off + 1) << 8);
-        if (v >= 10 && v < 65535)
-            C_ref[i] = v;
+        r.r8 = r.g8 = r.b8 = 0;
+        r.r_out = r.g_out = r.b_out = 0;
+        r.brightness = 0.0f;
+        return;
     }
+
+    // Normalize by clear channel (preserve hue)
+    uint32_t rn = (uint32_t)r.r16 * 255u / r.c16;
+    uint32_t gn = (uint32_t)r.g16 * 255u / r.c16;
+    uint32_t bn = (uint32_t)r.b16 * 255u / r.c16;
+
+    r.r8 = rn > 255u ? 255u : (uint8_t)rn;
+    r.g8 = gn > 255u ? 255u : (uint8_t)gn;
+    r.b8 = bn > 255u ? 255u : (uint8_t)bn;
+
+    float brightness = (float)r.cScaled / (float)cref;
+    if (brightness > 1.0f)
+        brightness = 1.0f;
+    if (brightness < 0.0f)
+        brightness = 0.0f;
+    r.brightness = brightness;
+
+    r.r_out = (uint8_t)((float)r.r8 * brightness * BRIGHTNESS + 0.5f);
+    r.g_out = (uint8_t)((float)r.g8 * brightness * BRIGHTNESS + 0.5f);
+    r.b_out = (uint8_t)((float)r.b8 * brightness * BRIGHTNESS + 0.5f);
 }
 
-static inline void eepromSaveCrefs()
+// Normalize one raw frame, drive the LED and store it as the latest reading
+static void publishReading(ColourSensorIdx idx, ColourExposure exposure,
+                           uint16_t r16, uint16_t g16, uint16_t b16, uint16_t c16)
 {
-    eepromBeginIfNeeded();
-    EEPROM.write(EEPROM_BASE, EEPROM_SIG);
-    for (int i = 0; i < CS_COUNT; i++)
+    // Prepare snapshot
+    ColourReading r{};
+    r.r16 = r16;
+    r.g16 = g16;
+    r.b16 = b16;
+    r.c16 = c16;
+    r.exposure = exposure;
+    r.tMs = millis();
+    r.seq = lastReading[idx].seq + 1;
+
+    colourNormalize(C_ref[idx], r);
+    setRGB(r.r_out, r.g_out, r.b_out);
+    storeReading(idx, r);
+    if (c16 < 5)
+        return;
+
+    // Optional debug (comment out if noisy)
+    static uint32_t last = 0;
+    if (millis() - last > 300)
     {
-        int off = EEPROM_BASE + 1 + i * 2;
-        EEPROM.write(off, (uint8_t)(C_ref[i] & 0xFF));
-        EEPROM.write(off + 1, (uint8_t)(C_ref[i] >> 8));
+        last = millis();
+        Serial.printf("[CS%u CH%d] RGBC=%u,%u,%u,%u @%lums/%ux | norm=%3u,%3u,%3u | Cref=%u br=%.2f | LED=%3u,%3u,%3u\n",
+                      (unsigned)idx, COLOR_CH[idx],
+                      r16, g16, b16, c16,
+                      (unsigned long)(exposureCycles(exposure) * 12u / 5u), GAIN_X[exposure.again & 3],
+                      r.r8, r.g8, r.b8, r.cref, r.brightness,
+                      r.r_out, r.g_out, r.b_out);
     }
-#if defined(ESP32)
-    EEPROM.commit();
-#endif
 }
 
-// ---------- Last-read storage ----------
-static ColourReading lastReading[CS_COUNT] = {};
-
-// ---------- Small helpers ----------
-static inline uint8_t clamp255(int v) { return v < 0 ? 0 : (v > 255 ? 255 : v); }
+// Little-endian channel word at `off` in a STATUS..BDATAH burst
+static inline uint16_t frameWord(const uint8_t *frame, uint8_t off)
+{
+    return (uint16_t)frame[off] | ((uint16_t)frame[off + 1] << 8);
+}
 
-static inline void setRGB(uint8_t r, uint8_t g, uint8_t b)
+static inline void publishFrame(ColourSensorIdx idx, ColourExposure used, const uint8_t *frame)
 {
-    ledcWrite(CH_R, r);
-    ledcWrite(CH_G, g);
-    ledcWrite(CH_B, b);
+    publishReading(idx, used, frameWord(frame, 3), frameWord(frame, 5),
+                   frameWord(frame, 7), frameWord(frame, 1));
 }
 
 // ================= PUBLIC API =================
@@ -104,6 +285,11 @@ uint16_t colourGetCref(ColourSensorIdx idx)
     return (idx < CS_COUNT) ? C_ref[idx] : 0;
 }
 
+ColourExposure colourGetExposure(ColourSensorIdx idx)
+{
+    return (idx < CS_COUNT) ? engine[idx].exposure : EXPOSURE_REF;
+}
+
 void colourSetup()
 {
     // LEDC setup (attach pins elsewhere)
@@ -112,16 +298,25 @@ void colourSetup()
     ledcSetup(CH_B, 5000, 8);
     setRGB(0, 0, 0);
 
-    // Load saved C_refs if present
-    eepromLoadCrefs();
+    // Saved C_refs, where calibrated
+    for (int i = 0; i < CS_COUNT; i++)
+    {
+        uint16_t v;
+        if (Settings::get(Setting::ColourRef[i], v) && v >= 10 && v < 65535)
+            C_ref[i] = v;
+    }
 
-    // Probe each sensor on its TCA channel
+    // Probe each sensor on its TCA channel: ID register, then power on.
+    // The engine's first tick starts integrating (PON has had its 2.4 ms
+    // by then); begin() would sit out a 614 ms integration per sensor.
     bool ok_all = true;
     for (int i = 0; i < CS_COUNT; i++)
     {
-        tcaSelectChannel(COLOR_CH[i]);
-        bool ok = TCS_breakout.begin();
+        I2CLease lease(I2CDev::Colour, COLOR_CH[i]);
+        bool ok = tcsProbe();
         Serial.printf("TCS@CH%d: %s\n", COLOR_CH[i], ok ? "FOUND" : "NOT FOUND");
+        engine[i].present = ok;
+        engine[i].phase = EnginePhase::Idle;
         ok_all &= ok;
     }
     if (!ok_all)
@@ -133,7 +328,9 @@ bool colourCalibrateWhite(ColourSensorIdx idx, uint16_t samples)
     if (idx >= CS_COUNT)
         return false;
 
-    tcaSelectChannel(COLOR_CH[idx]);
+    // begin() restores the 614 ms / 1x reference exposure C_ref is defined
+    // at, whatever auto-exposure had picked for this sensor
+    I2CLease lease(I2CDev::Colour, COLOR_CH[idx]);
     if (!TCS_breakout.begin())
         return false; // ensure device up on this channel
 
@@ -154,11 +351,12 @@ bool colourCalibrateWhite(ColourSensorIdx idx, uint16_t samples)
     if (avg < 10)
         avg = 10;
     C_ref[idx] = avg;
-
-    eepromSaveCrefs();
+    Settings::set(Setting::ColourRef[idx], avg);
 
     Serial.printf("Calibrated C_ref[%u] = %u (CH%d)\n",
                   (unsigned)idx, avg, COLOR_CH[idx]);
+    engine[idx].present = true;
+    engine[idx].phase = EnginePhase::Idle;
     return true;
 }
 
@@ -167,76 +365,100 @@ void convertColourToRGB(ColourSensorIdx idx)
     if (idx >= CS_COUNT)
         return;
 
-    tcaSelectChannel(COLOR_CH[idx]);
-
-    uint16_t r16, g16, b16, c16;
-    TCS_breakout.getRawData(&r16, &g16, &b16, &c16);
-
-    // Prepare snapshot
-    ColourReading r{};
-    r.r16 = r16;
-    r.g16 = g16;
-    r.b16 = b16;
-    r.c16 = c16;
-    r.cref = C_ref[idx];
-
-    if (c16 < 5)
+    // One clean cycle at this sensor's own exposure, so the wait is as
+    // short as its light allows
+    EngineState &st = engine[idx];
+    const ColourExposure used = st.exposure;
     {
-        setRGB(0, 0, 0);
-        r.r8 = r.g8 = r.b8 = 0;
-        r.r_out = r.g_out = r.b_out = 0;
-        r.brightness = 0.0f;
-        lastReading[idx] = r;
-        return;
+        I2CLease lease(I2CDev::Colour, COLOR_CH[idx]);
+        tcsWriteExposure(used);
+        tcsRestartIntegration();
     }
+    delay(exposureMs(used));
 
-    // Normalize by clear channel (preserve hue)
-    uint32_t rn = (uint32_t)r16 * 255u / c16;
-    uint32_t gn = (uint32_t)g16 * 255u / c16;
-    uint32_t bn = (uint32_t)b16 * 255u / c16;
-
-    r.r8 = rn > 255u ? 255u : (uint8_t)rn;
-    r.g8 = gn > 255u ? 255u : (uint8_t)gn;
-    r.b8 = bn > 255u ? 255u : (uint8_t)bn;
-
-    float brightness = (float)c16 / (float)C_ref[idx];
-    if (brightness > 1.0f)
-        brightness = 1.0f;
-    if (brightness < 0.0f)
-        brightness = 0.0f;
-    r.brightness = brightness;
-
-    r.r_out = (uint8_t)((float)r.r8 * brightness * BRIGHTNESS + 0.5f);
-    r.g_out = (uint8_t)((float)r.g8 * brightness * BRIGHTNESS + 0.5f);
-    r.b_out = (uint8_t)((float)r.b8 * brightness * BRIGHTNESS + 0.5f);
-
-    setRGB(r.r_out, r.g_out, r.b_out);
-
-    lastReading[idx] = r;
-
-    // Optional debug (comment out if noisy)
-    static uint32_t last = 0;
-    if (millis() - last > 300)
+    uint8_t frame[TCS_FRAME_LEN];
+    bool ok = false;
+    for (uint8_t tries = 0; tries < 5 && !ok; tries++)
     {
-        last = millis();
-        Serial.printf("[CS%u CH%d] RGBC=%u,%u,%u,%u | norm=%3u,%3u,%3u | Cref=%u br=%.2f | LED=%3u,%3u,%3u\n",
-                      (unsigned)idx, COLOR_CH[idx],
-                      r16, g16, b16, c16, r.r8, r.g8, r.b8, r.cref, r.brightness,
-                      r.r_out, r.g_out, r.b_out);
+        if (tries)
+            delay(2);
+        I2CLease lease(I2CDev::Colour, COLOR_CH[idx]);
+        ok = tcsReadFrame(frame) && (frame[0] & TCS34725_STATUS_AVALID);
     }
+    if (ok)
+    {
+        st.exposure = colourNextExposure(used, frameWord(frame, 1));
+        publishFrame(idx, used, frame);
+    }
+
+    // The sensor kept integrating; let the engine start a clean cycle
+    st.phase = EnginePhase::Idle;
 }
 
 void colourTickAll()
 {
-    convertColourToRGB(CS_0);
-    convertColourToRGB(CS_1);
-    convertColourToRGB(CS_2);
+    const uint32_t now = millis();
+
+    // Sensors are polled in mux-channel order; each one costs no bus
+    // traffic until its integration window has elapsed.
+    for (int i = 0; i < CS_COUNT; i++)
+    {
+        EngineState &st = engine[i];
+        if (!st.present)
+            continue;
+
+        if (st.phase == EnginePhase::Idle)
+        {
+            I2CLease lease(I2CDev::Colour, COLOR_CH[i]);
+            tcsWriteExposure(st.exposure);
+            tcsRestartIntegration();
+            st.phase = EnginePhase::Integrating;
+            st.startedMs = now;
+            continue;
+        }
+
+        const uint32_t integMs = exposureMs(st.exposure);
+        if (now - st.startedMs < integMs)
+            continue;
+
+        uint8_t frame[TCS_FRAME_LEN];
+        ColourExposure used;
+        {
+            I2CLease lease(I2CDev::Colour, COLOR_CH[i]);
+            if (!tcsReadFrame(frame) || !(frame[0] & TCS34725_STATUS_AVALID))
+            {
+                // Not ready yet (or bus hiccup): poll again next tick, but
+                // kick the sensor if it has been silent for two windows.
+                if (now - st.startedMs > 2 * integMs)
+                    st.phase = EnginePhase::Idle;
+                continue;
+            }
+
+            // Start the next integration before the math so it overlaps;
+            // the exposure only changes on the rare frame that asks for it
+            used = st.exposure;
+            const ColourExposure next = colourNextExposure(used, frameWord(frame, 1));
+            if (next.atime != used.atime || next.again != used.again)
+                tcsWriteExposure(next);
+            tcsRestartIntegration();
+            st.startedMs = now;
+            st.exposure = next;
+        }
+        publishFrame((ColourSensorIdx)i, used, frame);
+    }
 }
 
 bool colourGetReading(ColourSensorIdx idx, ColourReading &out)
 {
     if (idx >= CS_COUNT)
         return false;
-    out = lastReading[idx];
+    uint32_t before, after;
+    do
+    {
+        before = lastReadingSeq[idx].load(std::memory_order_acquire);
+        out = lastReading[idx];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = lastReadingSeq[idx].load(std::memory_order_relaxed);
+    } while ((before & 1u) || before != after);
     return true;
 }
@@ -2,6 +2,13 @@
 #include <Arduino.h>
 #include <Adafruit_TCS34725.h>
 
+// =============== User knobs ===============
+#define COLOUR_AE_EN 1            // 0 = every sensor stays at 614 ms / 1x
+#define COLOUR_AE_TARGET_PCT 50   // aim the clear channel at this % of full scale
+#define COLOUR_AE_MIN_COUNTS 1000 // integrate at least long enough for this many clear counts
+#define COLOUR_AE_MIN_CYCLES 10   // 24 ms: shorter frames only add bus traffic
+// =========================================
+
 // Index your three sensors (SDA1, SDA3, SDA4)
 enum ColourSensorIdx : uint8_t
 {
@@ -11,13 +18,26 @@ enum ColourSensorIdx : uint8_t
     CS_COUNT = 3
 };
 
+// Integration (ATIME register: 256 - atime cycles of 2.4 ms) and gain
+// (CONTROL AGAIN bits: 1x/4x/16x/60x). Zero is 614 ms / 1x, the exposure
+// C_ref and the rest of the pipeline were defined at.
+struct ColourExposure
+{
+    uint8_t atime;
+    uint8_t again;
+};
+
 struct ColourReading
 {
-    uint16_t r16, g16, b16, c16; // raw channels
+    uint16_t r16, g16, b16, c16; // raw channels, at `exposure`
+    ColourExposure exposure;
+    uint32_t cScaled;            // c16 scaled to 614 ms / 1x
     uint8_t r8, g8, b8;          // normalized 0..255
     uint8_t r_out, g_out, b_out; // LED values written
     float brightness;            // 0..1 from C/C_ref
     uint16_t cref;               // calibration used
+    uint32_t tMs;                // millis() when the frame was harvested
+    uint32_t seq;                // completed frames on this sensor (0 = none yet)
 };
 
 // Call in setup()
@@ -26,15 +46,38 @@ void colourSetup();
 // Calibrate white for one sensor (place white target, steady light)
 bool colourCalibrateWhite(ColourSensorIdx idx, uint16_t samples = 16);
 
-// Update ONE sensor (selects TCA channel internally) and update LEDs
+// Update ONE sensor (selects TCA channel internally) and update LEDs.
+// Blocking: waits out a full integration on that sensor.
 void convertColourToRGB(ColourSensorIdx idx);
 
-// Update ALL sensors (convenience)
+// Non-blocking acquisition step for ALL sensors. Every sensor integrates
+// in parallel; a tick only touches the bus for sensors whose integration is
+// due, harvests the frame if AVALID is set and restarts the next cycle.
+// Call as often as you like (e.g. every loop).
 void colourTickAll();
 
-// Read back the latest computed values
+// Read back the freshest completed frame (seq == 0 until the first one).
+// Safe from any core: a whole frame, retried if it overlaps a publish.
 bool colourGetReading(ColourSensorIdx idx, ColourReading &out);
 
+// Pure normalisation behind every published reading (no bus, no LEDs):
+// fills r8/g8/b8 (hue over clear), brightness against cref and the LED
+// duty values from the raw channels already in `out`.
+void colourNormalize(uint16_t cref, ColourReading &out);
+
+// Auto-exposure step (pure): the exposure for the next frame after one
+// that read c16 clear counts at `cur`. Picks the highest gain that keeps
+// the clear channel under COLOUR_AE_TARGET_PCT, then the shortest
+// integration that still gives COLOUR_AE_MIN_COUNTS.
+ColourExposure colourNextExposure(ColourExposure cur, uint16_t c16);
+
+// Counts taken at `e` rescaled to 614 ms / 1x (what cScaled holds for
+// the clear channel)
+uint32_t colourScaled(ColourExposure e, uint16_t counts);
+
+// Current exposure of one sensor
+ColourExposure colourGetExposure(ColourSensorIdx idx);
+
 // Optional: tweak per-sensor white reference
 void colourSetCref(ColourSensorIdx idx, uint16_t cref);
 uint16_t colourGetCref(ColourSensorIdx idx);
@@ -0,0 +1,150 @@
+#pragma once
+
+// Stackless coroutines (protothread style). A coroutine is an object whose
+// step() runs until its next wait and returns; the next call resumes right
+// after that wait. No stack of its own, so any number of flows share the
+// loop task and cost only their member variables.
+//
+//   class Blink : public Coroutine {
+//       uint32_t _next;
+//       CoStatus step() override {
+//           CO_BEGIN();
+//           _next = millis();
+//           for (;;) { toggle(); _next += 500; CO_SLEEP_UNTIL(_next); }
+//           CO_END();
+//       }
+//   };
+//
+// Rules that come with resuming by switch/case:
+// - locals do not survive a wait; anything used across one is a member;
+// - no declaration with an initialiser between a wait and the end of its
+//   block (put the work in a helper function instead);
+// - one CO_ macro per source line, and none inside a switch statement.
+//
+// The scheduler (scheduler.h) steps a coroutine once its sleep has run out,
+// or as soon as input is queued while it waits for input.
+
+#include <Arduino.h>
+
+#include "Input.h"
+
+enum class CoStatus : uint8_t
+{
+    Running,
+    Done
+};
+
+class Coroutine
+{
+public:
+    virtual ~Coroutine() = default;
+
+    // Resume until the next wait (Running) or the end (Done)
+    virtual CoStatus step() = 0;
+
+    // Start over from the top on the next step()
+    void restart()
+    {
+        _line = 0;
+        _wakeMs = millis();
+        _waitInput = false;
+    }
+
+    bool done() const { return _line == DONE; }
+    uint32_t wakeMs() const { return _wakeMs; }
+    bool waitsInput() const { return _waitInput; }
+
+protected:
+    static constexpr uint16_t DONE = 0xffff;
+
+    uint16_t _line = DONE; // resume point; 0 = top, DONE = finished or never started
+    uint32_t _wakeMs = 0;  // not due before this (unless waiting for input)
+    bool _waitInput = false;
+};
+
+// Resume labels sit right after the statement that records them
+#if defined(__GNUC__) && __GNUC__ >= 7
+#define CO_FALLTHROUGH __attribute__((fallthrough))
+#else
+#define CO_FALLTHROUGH do {} while (0)
+#endif
+
+#define CO_BEGIN()          \
+    _waitInput = false;     \
+    switch (_line)          \
+    {                       \
+    case 0:
+
+#define CO_END()            \
+    default:                \
+        break;              \
+    }                       \
+    _line = DONE;           \
+    return CoStatus::Done
+
+// Give the other activities a turn; resume on the next pass
+#define CO_YIELD()                      \
+    do                                  \
+    {                                   \
+        _wakeMs = millis();             \
+        _line = __LINE__;               \
+        return CoStatus::Running;       \
+    case __LINE__:;                     \
+    } while (0)
+
+// Sleep to an absolute millis() deadline (always yields once, even if it
+// has passed)
+#define CO_SLEEP_UNTIL(ms)                              \
+    do                                                  \
+    {                                                   \
+        _wakeMs = (ms);                                 \
+        _line = __LINE__;                               \
+        return CoStatus::Running;                       \
+    case __LINE__:                                      \
+        if ((int32_t)(millis() - _wakeMs) < 0)          \
+            return CoStatus::Running;                   \
+    } while (0)
+
+// Re-check cond every pollMs
+#define CO_WAIT_UNTIL(cond, pollMs)                     \
+    do                                                  \
+    {                                                   \
+        _line = __LINE__;                               \
+        CO_FALLTHROUGH;                                 \
+    case __LINE__:                                      \
+        if (!(cond))                                    \
+        {                                               \
+            _wakeMs = millis() + (pollMs);              \
+            return CoStatus::Running;                   \
+        }                                               \
+    } while (0)
+
+// Take the next input event into ev, sleeping until there is one
+#define CO_WAIT_INPUT(ev)                               \
+    do                                                  \
+    {                                                   \
+        _line = __LINE__;                               \
+        CO_FALLTHROUGH;                                 \
+    case __LINE__:                                      \
+        if (!Input::nextEvent((ev), 0))                 \
+        {                                               \
+            _waitInput = true;                          \
+            return CoStatus::Running;                   \
+        }                                               \
+    } while (0)
+
+// Run a child coroutine (already restarted) to completion; its waits
+// become this one's
+#define CO_AWAIT(child)                                 \
+    do                                                  \
+    {                                                   \
+        _line = __LINE__;                               \
+        CO_FALLTHROUGH;                                 \
+    case __LINE__:                                      \
+        if ((child).step() == CoStatus::Running)        \
+        {                                               \
+            _wakeMs = (child).wakeMs();                 \
+            _waitInput = (child).waitsInput();          \
+            return CoStatus::Running;                   \
+        }                                               \
+    } while (0)
@@ -0,0 +1,333 @@
+#include "cycle_log.h"
+
+#if CYCLE_LOG_EN
+
+#include <LittleFS.h>
+#include <math.h>
+#include <string.h>
+#include <atomic>
+
+#include "colour.h"
+
+namespace
+{
+    constexpr const char *LOG_DIR = "/tlog";
+    constexpr size_t STAGE_BYTES = CYCLE_LOG_STAGE_RECORDS * sizeof(CycleLogSample);
+
+    enum StageFlags : uint8_t
+    {
+        StageOpen = 1, // first batch of a cycle: create the file
+        StageClose = 2 // last batch: close it
+    };
+
+    // Two staging buffers used alternately: the control loop fills one
+    // while the writer drains the other. `busy` hands a buffer over and
+    // back; the writer takes them in the order they were submitted.
+    struct Stage
+    {
+        uint8_t bytes[STAGE_BYTES];
+        uint16_t len = 0;
+        uint8_t flags = 0;
+        uint32_t cycle = 0;
+        std::atomic<bool> busy{false};
+    };
+
+    Stage stage[2];
+    uint8_t active = 0;
+    uint8_t writerNext = 0;
+
+    bool mounted = false;
+    bool inCycle = false;
+    uint32_t cycleNo = 0; // newest cycle number used
+    uint32_t samples = 0;
+    uint32_t droppedSamples = 0;
+
+    // Encoder: the track a decoder will have rebuilt so far
+    uint32_t lastMs = 0;
+    int32_t weightMg = 0, tempMc = 0;
+    uint8_t nextSensor = 0;
+
+    File file; // writer side only
+
+    void pathFor(char *buf, size_t n, uint32_t cycle)
+    {
+        snprintf(buf, n, "%s/%08lu.bin", LOG_DIR, (unsigned long)cycle);
+    }
+
+    uint32_t cycleFromName(const char *name)
+    {
+        const char *slash = strrchr(name, '/'); // older cores return the full path
+        return (uint32_t)strtoul(slash ? slash + 1 : name, nullptr, 10);
+    }
+
+    // ---------- Writer side ----------
+
+    void writeStage(Stage &st)
+    {
+        char path[32];
+        if (st.flags & StageOpen)
+        {
+            if (st.cycle > CYCLE_LOG_MAX_CYCLES)
+            {
+                pathFor(path, sizeof(path), st.cycle - CYCLE_LOG_MAX_CYCLES);
+                LittleFS.remove(path);
+            }
+            pathFor(path, sizeof(path), st.cycle);
+            file = LittleFS.open(path, FILE_WRITE);
+        }
+        if (file && st.len)
+        {
+            file.write(st.bytes, st.len);
+            file.flush(); // a reset mid-cycle keeps what was written
+        }
+        if ((st.flags & StageClose) && file)
+            file.close();
+        st.len = 0;
+        st.flags = 0;
+        st.busy.store(false, std::memory_order_release);
+    }
+
+#if defined(ESP32)
+    TaskHandle_t writerTask = nullptr;
+
+    void writerMain(void *)
+    {
+        for (;;)
+        {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            while (stage[writerNext].busy.load(std::memory_order_acquire))
+            {
+                writeStage(stage[writerNext]);
+                writerNext ^= 1;
+            }
+        }
+    }
+#endif
+
+    // ---------- Control-loop side ----------
+
+    void submit(uint8_t flags)
+    {
+        Stage &st = stage[active];
+        st.flags |= flags;
+        st.cycle = cycleNo;
+        st.busy.store(true, std::memory_order_release);
+        active ^= 1;
+#if defined(ESP32)
+        if (writerTask)
+        {
+            xTaskNotifyGive(writerTask);
+            return;
+        }
+#endif
+        writeStage(st);
+        writerNext ^= 1;
+    }
+
+    // Copy one record into the active buffer; false if it had to be dropped
+    bool append(const void *rec, size_t n)
+    {
+        Stage *st = &stage[active];
+        if (st->busy.load(std::memory_order_acquire))
+            return false; // writer still has it: drop rather than wait
+        if (st->len + n > STAGE_BYTES)
+        {
+            submit(0);
+            st = &stage[active];
+            if (st->busy.load(std::memory_order_acquire))
+                return false;
+        }
+        memcpy(st->bytes + st->len, rec, n);
+        st->len += n;
+        return true;
+    }
+
+    // Header and end record happen outside the control loop: wait for room
+    void appendWaiting(const void *rec, size_t n)
+    {
+        while (!append(rec, n))
+            delay(1);
+    }
+
+    int16_t carryDelta(int32_t target, int32_t track)
+    {
+        int32_t d = target - track;
+        d = d > 32767 ? 32767 : (d < -32768 ? -32768 : d);
+        return (int16_t)d;
+    }
+
+    uint16_t clamp16(uint32_t v) { return v > 65535u ? 65535u : (uint16_t)v; }
+} // namespace
+
+namespace CycleLog
+{
+    bool begin()
+    {
+        mounted = LittleFS.begin(true);
+        if (!mounted)
+        {
+            Serial.println(F("[LOG] LittleFS mount failed"));
+            return false;
+        }
+        LittleFS.mkdir(LOG_DIR);
+
+        // Newest cycle number, then drop anything that fell out of the ring
+        File dir = LittleFS.open(LOG_DIR);
+        for (File f = dir.openNextFile(); f; f = dir.openNextFile())
+        {
+            const uint32_t n = cycleFromName(f.name());
+            if (n > cycleNo)
+                cycleNo = n;
+        }
+        if (cycleNo > CYCLE_LOG_MAX_CYCLES)
+        {
+            char path[32];
+            dir.rewindDirectory();
+            for (File f = dir.openNextFile(); f; f = dir.openNextFile())
+            {
+                const uint32_t n = cycleFromName(f.name());
+                if (n + CYCLE_LOG_MAX_CYCLES <= cycleNo)
+                {
+                    pathFor(path, sizeof(path), n);
+                    f.close();
+                    LittleFS.remove(path);
+                }
+            }
+        }
+        dir.close();
+
+#if defined(ESP32)
+        if (!writerTask)
+            xTaskCreatePinnedToCore(writerMain, "tlog", CYCLE_LOG_TASK_STACK, nullptr,
+                                    CYCLE_LOG_TASK_PRIO, &writerTask, CYCLE_LOG_TASK_CORE);
+#endif
+        return true;
+    }
+
+    void startCycle(ToastGuide guide, uint16_t periodMs, float startWeightG,
+                    float targetWeightG, float lossFrac, float startTempC)
+    {
+        if (!mounted)
+            return;
+
+        CycleLogHeader h{};
+        memcpy(h.magic, "TLOG", 4);
+        h.version = 1;
+        h.guide = (uint8_t)guide;
+        h.periodMs = periodMs;
+        h.cycle = ++cycleNo;
+        h.startMs = millis();
+        h.startWeightMg = (int32_t)lroundf(startWeightG * 1000.0f);
+        h.targetWeightMg = (int32_t)lroundf(targetWeightG * 1000.0f);
+        h.startTempMc = (int32_t)lroundf(startTempC * 1000.0f);
+        h.lossFracQ4 = (uint16_t)lroundf(lossFrac * 10000.0f);
+
+        lastMs = h.startMs;
+        weightMg = h.startWeightMg;
+        tempMc = h.startTempMc;
+        nextSensor = 0;
+        samples = 0;
+        droppedSamples = 0;
+
+        // The previous cycle's last batch may still be on its way to flash;
+        // the header then opens a fresh buffer
+        while (stage[active].busy.load(std::memory_order_acquire))
+            delay(1);
+        stage[active].flags = StageOpen;
+        appendWaiting(&h, sizeof(h));
+        inCycle = true;
+    }
+
+    void sample(const SensorSnapshot &s)
+    {
+        if (!inCycle)
+            return;
+
+        CycleLogSample r{};
+        r.tag = 'S';
+        // A snapshot published just before startCycle() counts as time 0
+        const int32_t dt = (int32_t)(s.tMs - lastMs);
+        r.dtMs = dt < 0 ? 0 : (dt > 65535 ? 65535 : (uint16_t)dt);
+        r.dWeightMg = carryDelta((int32_t)lroundf(s.weightG * 1000.0f), weightMg);
+        r.dTempMc = carryDelta((int32_t)lroundf(s.tempC * 1000.0f), tempMc);
+
+        r.sensor = 3;
+        ColourReading cr{};
+        if (colourGetReading((ColourSensorIdx)nextSensor, cr) && cr.seq)
+        {
+            r.sensor = nextSensor;
+            r.r = clamp16(colourScaled(cr.exposure, cr.r16));
+            r.g = clamp16(colourScaled(cr.exposure, cr.g16));
+            r.b = clamp16(colourScaled(cr.exposure, cr.b16));
+            r.c = clamp16(cr.cScaled);
+        }
+        nextSensor = (nextSensor + 1) % CS_COUNT;
+
+        // A dropped sample leaves the track alone; the next one's deltas
+        // (and dtMs) simply span the gap
+        if (!append(&r, sizeof(r)))
+        {
+            droppedSamples++;
+            return;
+        }
+        lastMs += r.dtMs;
+        weightMg += r.dWeightMg;
+        tempMc += r.dTempMc;
+        samples++;
+    }
+
+    void endCycle(const ToastResult &res)
+    {
+        if (!inCycle)
+            return;
+        inCycle = false;
+
+        CycleLogEnd e{};
+        e.tag = 'E';
+        e.reason = (uint8_t)res.reason;
+        e.brownIndex = res.brownIndex;
+        e.toastMs = res.toastMs;
+        e.stopWeightMg = (int32_t)lroundf(res.stopWeightG * 1000.0f);
+        e.settleMs = res.settleMs;
+        appendWaiting(&e, sizeof(e));
+        submit(StageClose);
+
+        Serial.printf("[LOG] cycle %lu: %lu samples, %lu dropped\n",
+                      (unsigned long)cycleNo, (unsigned long)samples,
+                      (unsigned long)droppedSamples);
+    }
+
+    uint32_t dropped() { return droppedSamples; }
+
+    void exportAll(Print &out)
+    {
+        if (!mounted || inCycle)
+            return;
+        while (stage[0].busy.load(std::memory_order_acquire) ||
+               stage[1].busy.load(std::memory_order_acquire))
+            delay(1);
+
+        const uint32_t first = cycleNo > CYCLE_LOG_MAX_CYCLES ? cycleNo - CYCLE_LOG_MAX_CYCLES + 1 : 1;
+        char path[32];
+        uint8_t buf[32];
+        for (uint32_t n = first; n <= cycleNo; n++)
+        {
+            pathFor(path, sizeof(path), n);
+            File f = LittleFS.open(path, FILE_READ);
+            if (!f)
+                continue;
+            out.printf("#TLOG v1 cycle=%lu bytes=%lu\n", (unsigned long)n, (unsigned long)f.size());
+            size_t got;
+            while ((got = f.read(buf, sizeof(buf))) > 0)
+            {
+                for (size_t i = 0; i < got; i++)
+                    out.printf("%02x", buf[i]);
+                out.println();
+            }
+            out.println("#END");
+            f.close();
+        }
+    }
+} // namespace CycleLog
+
+#endif // CYCLE_LOG_EN
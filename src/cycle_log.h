@@ -0,0 +1,112 @@
+#pragma once
+#include <Arduino.h>
+
+#include "ModeUI.h"
+#include "sensorManager.h"
+
+// =============== User knobs ===============
+#define CYCLE_LOG_EN 1               // 0 = no logging, no LittleFS mount
+#define CYCLE_LOG_MAX_CYCLES 16      // newest cycles kept on flash (~50 KB each at 5 min)
+#define CYCLE_LOG_STAGE_RECORDS 64   // records per RAM staging buffer (two buffers)
+#define CYCLE_LOG_TASK_CORE 0        // flash writer task (ESP32)
+#define CYCLE_LOG_TASK_PRIO 1        // below the sensor task
+#define CYCLE_LOG_TASK_STACK 3072    // bytes
+#define CYCLE_LOG_SERIAL_CMD 'L'     // send over Serial from the menu to stream the cycles
+// =========================================
+
+// Every runToastingFlow() is written to LittleFS as /tlog/<cycle>.bin: one
+// 32-byte CycleLogHeader, then fixed 16-byte records, little-endian:
+//
+//   'S' sample   one per control tick. Time, weight and object temperature
+//                are deltas from the previous sample (the header holds the
+//                starting values). A delta that does not fit saturates and
+//                the rest is carried into the next record, so the decoded
+//                track never drifts. RGBC is one colour sensor's latest
+//                frame (round-robin), scaled to 614 ms / 1x.
+//   'E' end      stop reason, stop weight, browning index, durations.
+//
+// A file without an 'E' record is a cycle cut short by a reset. Samples
+// are staged in RAM and a writer task does the flash work, so sample() is
+// a copy; if the writer falls behind whole batches are dropped (counted),
+// never waited for. Decode the Serial export with tools/tlog2csv.py.
+
+struct CycleLogHeader
+{
+    char magic[4];          // "TLOG"
+    uint8_t version;        // 1
+    uint8_t guide;          // ToastGuide
+    uint16_t periodMs;      // nominal sample spacing
+    uint32_t cycle;         // running cycle number (also the file name)
+    uint32_t startMs;       // millis() when toasting started
+    int32_t startWeightMg;  // settled start weight
+    int32_t targetWeightMg; // moisture-loss target
+    int32_t startTempMc;    // object temperature at the start, milli-degC
+    uint16_t lossFracQ4;    // loss fraction x 10000
+    uint16_t reserved;
+};
+
+struct CycleLogSample
+{
+    uint8_t tag;           // 'S'
+    uint8_t sensor;        // colour sensor in r..c (3 = none)
+    uint16_t dtMs;         // since the previous sample
+    int16_t dWeightMg;     // weight delta, mg
+    int16_t dTempMc;       // object temperature delta, milli-degC
+    uint16_t r, g, b, c;   // that sensor's frame at 614 ms / 1x, clamped
+};
+
+struct CycleLogEnd
+{
+    uint8_t tag;           // 'E'
+    uint8_t reason;        // ToastStop
+    int16_t brownIndex;
+    uint32_t toastMs;
+    int32_t stopWeightMg;
+    uint32_t settleMs;
+};
+
+static_assert(sizeof(CycleLogHeader) == 32, "CycleLogHeader is two record slots");
+static_assert(sizeof(CycleLogSample) == 16, "CycleLogSample is one record slot");
+static_assert(sizeof(CycleLogEnd) == 16, "CycleLogEnd is one record slot");
+
+#if CYCLE_LOG_EN
+
+namespace CycleLog
+{
+    // Mount LittleFS (formatting it if it will not mount) and find the
+    // newest stored cycle; call once from setup()
+    bool begin();
+
+    // Toasting is starting: stage the header. Cheap; no flash access.
+    void startCycle(ToastGuide guide, uint16_t periodMs, float startWeightG,
+                    float targetWeightG, float lossFrac, float startTempC);
+
+    // One control tick. Copies into the staging buffer; never blocks.
+    void sample(const SensorSnapshot &s);
+
+    // Stage the end record and hand the rest to the writer
+    void endCycle(const ToastResult &r);
+
+    // Samples lost because both staging buffers were waiting on flash
+    uint32_t dropped();
+
+    // Stream every stored cycle, oldest first, as hex blocks:
+    //   #TLOG v1 cycle=<n> bytes=<len>
+    //   <64 hex digits per line>
+    //   #END
+    void exportAll(Print &out);
+} // namespace CycleLog
+
+#else
+
+namespace CycleLog
+{
+    inline bool begin() { return true; }
+    inline void startCycle(ToastGuide, uint16_t, float, float, float, float) {}
+    inline void sample(const SensorSnapshot &) {}
+    inline void endCycle(const ToastResult &) {}
+    inline uint32_t dropped() { return 0; }
+    inline void exportAll(Print &) {}
+} // namespace CycleLog
+
+#endif
@@ -0,0 +1,282 @@
+#pragma once
+
+// Compile-time composed scalar filter chains. A chain is a list of stage
+// types run in order on every sample:
+//
+//   FilterChain<MedianN<3>, Kalman1D, Deadband> f;
+//   f.configure(cfg);   // every stage picks the fields it uses
+//   f.reset(0.0f);      // steady state at this value
+//   float y = f.step(x);
+//
+// The chain inherits from its stages, so step() is a straight sequence of
+// inlinable calls (no virtual dispatch, no heap). A stage type can appear
+// only once per chain; reach it with stage<T>().
+//
+// A stage is any class with
+//   void configure(const FilterConfig &);
+//   void reset(float x);   // as if x had been the input forever
+//   float step(float x);
+//   float delaySamples() const; // group delay for a slow ramp
+
+#include <Arduino.h>
+#include <math.h>
+
+struct FilterConfig
+{
+    float dtS = 0.05f;       // sample period
+    float deadbandG = 0.5f;  // |y| <= this reads as 0
+    float emaAlpha = 0.2f;   // 0..1, higher = snappier
+    float kalmanSigmaG = 0.05f; // measurement noise (1 sigma)
+    float kalmanAccel = 0.2f;   // process noise: how fast the rate may change, units/s^2
+    float kalmanJumpG = 3.0f;   // innovation beyond this re-seeds the state (load placed/removed)
+};
+
+// ---------- Stages ----------
+
+// Median of the last N samples: removes isolated spikes (knocks, a crumb
+// landing) without smearing a real step, at (N-1)/2 samples of delay.
+template <uint8_t N>
+class MedianN
+{
+    static_assert(N % 2 == 1 && N >= 3 && N <= 15, "MedianN needs an odd window of 3..15");
+
+public:
+    void configure(const FilterConfig &) {}
+
+    void reset(float x)
+    {
+        for (uint8_t i = 0; i < N; i++)
+            _win[i] = x;
+        _pos = 0;
+    }
+
+    float step(float x)
+    {
+        _win[_pos] = x;
+        _pos = (uint8_t)((_pos + 1) % N);
+
+        // insertion sort of a copy: N is tiny
+        float s[N];
+        for (uint8_t i = 0; i < N; i++)
+        {
+            float v = _win[i];
+            int8_t j = (int8_t)i - 1;
+            while (j >= 0 && s[j] > v)
+            {
+                s[j + 1] = s[j];
+                --j;
+            }
+            s[j + 1] = v;
+        }
+        return s[N / 2];
+    }
+
+    float delaySamples() const { return (N - 1) / 2.0f; }
+
+private:
+    float _win[N] = {};
+    uint8_t _pos = 0;
+};
+
+// Fixed-point FIR with a Hann-windowed (raised-cosine) kernel of TAPS taps,
+// unity DC gain. Samples are held as Q8 (1/256 unit) int32, coefficients as
+// Q15, accumulation in int64: an integer multiply-accumulate per tap.
+// Delay is (TAPS-1)/2 samples.
+template <uint8_t TAPS>
+class FirHann
+{
+    static_assert(TAPS >= 3 && TAPS <= 32, "FirHann supports 3..32 taps");
+
+public:
+    FirHann()
+    {
+        // Hann weights without the zero end points, normalised to 32768
+        float w[TAPS], sum = 0.0f;
+        for (uint8_t i = 0; i < TAPS; i++)
+        {
+            w[i] = 0.5f - 0.5f * cosf(6.2831853f * (i + 1) / (TAPS + 1));
+            sum += w[i];
+        }
+        int32_t total = 0;
+        for (uint8_t i = 0; i < TAPS; i++)
+        {
+            _coef[i] = (int16_t)lroundf(w[i] / sum * 32767.0f);
+            total += _coef[i];
+        }
+        _coef[TAPS / 2] += (int16_t)(32768 - total); // exact unity gain
+    }
+
+    void configure(const FilterConfig &) {}
+
+    void reset(float x)
+    {
+        const int32_t q = toQ8(x);
+        for (uint8_t i = 0; i < TAPS; i++)
+            _hist[i] = q;
+        _pos = 0;
+    }
+
+    float step(float x)
+    {
+        _hist[_pos] = toQ8(x);
+        int64_t acc = 0;
+        uint8_t k = _pos;
+        for (uint8_t i = 0; i < TAPS; i++)
+        {
+            acc += (int64_t)_hist[k] * _coef[i];
+            k = k ? k - 1 : TAPS - 1;
+        }
+        _pos = (uint8_t)((_pos + 1) % TAPS);
+        return (float)((acc + (1 << 14)) >> 15) * (1.0f / 256.0f);
+    }
+
+    float delaySamples() const { return (TAPS - 1) / 2.0f; }
+
+private:
+    static int32_t toQ8(float x) { return (int32_t)lroundf(x * 256.0f); }
+
+    int16_t _coef[TAPS];
+    int32_t _hist[TAPS] = {};
+    uint8_t _pos = 0;
+};
+
+// 1-D Kalman filter with a rate state (constant-velocity model). Tracks
+// slow drift such as moisture loss without lag, and exposes the rate
+// itself. An innovation beyond kalmanJumpG is a load change, not noise:
+// the state is re-seeded there instead of crawling towards it.
+class Kalman1D
+{
+public:
+    void configure(const FilterConfig &c)
+    {
+        _dt = c.dtS;
+        _r = c.kalmanSigmaG * c.kalmanSigmaG;
+        _q = c.kalmanAccel * c.kalmanAccel;
+        _jump = c.kalmanJumpG;
+    }
+
+    void reset(float x)
+    {
+        _x = x;
+        _v = 0.0f;
+        _p00 = _r;
+        _p01 = 0.0f;
+        _p11 = _q * _dt;
+    }
+
+    float step(float z)
+    {
+        // predict
+        const float dt = _dt;
+        _x += _v * dt;
+        const float p00 = _p00 + dt * (2.0f * _p01 + dt * _p11) + _q * dt * dt * dt * (1.0f / 3.0f);
+        const float p01 = _p01 + dt * _p11 + _q * dt * dt * 0.5f;
+        const float p11 = _p11 + _q * dt;
+
+        const float y = z - _x;
+        if (fabsf(y) > _jump)
+        {
+            reset(z);
+            return _x;
+        }
+
+        // update
+        const float s = p00 + _r;
+        const float k0 = p00 / s, k1 = p01 / s;
+        _x += k0 * y;
+        _v += k1 * y;
+        _p00 = (1.0f - k0) * p00;
+        _p01 = (1.0f - k0) * p01;
+        _p11 = p11 - k1 * p01;
+        return _x;
+    }
+
+    float rate() const { return _v; } // units per second
+    float delaySamples() const { return 0.0f; } // the rate state tracks ramps
+
+private:
+    float _dt = 0.05f, _q = 0.04f, _r = 0.0025f, _jump = 3.0f;
+    float _x = 0.0f, _v = 0.0f;
+    float _p00 = 0.0f, _p01 = 0.0f, _p11 = 0.0f;
+};
+
+// Exponential moving average (the original fixed smoother)
+class Ema
+{
+public:
+    void configure(const FilterConfig &c) { _alpha = c.emaAlpha; }
+    void reset(float x) { _y = x; }
+    float step(float x)
+    {
+        _y += _alpha * (x - _y);
+        return _y;
+    }
+
+    float delaySamples() const { return (1.0f - _alpha) / _alpha; }
+
+private:
+    float _alpha = 0.2f;
+    float _y = 0.0f;
+};
+
+// Reads small magnitudes as exactly zero (empty scale shows 0.0 g)
+class Deadband
+{
+public:
+    void configure(const FilterConfig &c) { _width = c.deadbandG; }
+    void reset(float) {}
+    float step(float x) { return fabsf(x) <= _width ? 0.0f : x; }
+    float delaySamples() const { return 0.0f; }
+
+private:
+    float _width = 0.5f;
+};
+
+// ---------- Chain ----------
+
+template <class... Stages>
+class FilterChain : private Stages...
+{
+    static_assert(sizeof...(Stages) > 0, "FilterChain needs at least one stage");
+
+public:
+    void configure(const FilterConfig &c) { configureAll<Stages...>(c); }
+    void reset(float x) { resetAll<Stages...>(x); }
+    float step(float x) { return run<Stages...>(x); }
+    // Sum of the stages' delays, in samples
+    float delaySamples() const { return delayOf<Stages...>(); }
+
+    template <class S>
+    S &stage() { return static_cast<S &>(*this); }
+    template <class S>
+    const S &stage() const { return static_cast<const S &>(*this); }
+
+private:
+    template <class S>
+    float run(float x) { return S::step(x); }
+    template <class S, class Next, class... Rest>
+    float run(float x) { return run<Next, Rest...>(S::step(x)); }
+
+    template <class S>
+    float delayOf() const { return S::delaySamples(); }
+    template <class S, class Next, class... Rest>
+    float delayOf() const { return S::delaySamples() + delayOf<Next, Rest...>(); }
+
+    template <class S>
+    void resetAll(float x) { S::reset(x); }
+    template <class S, class Next, class... Rest>
+    void resetAll(float x)
+    {
+        S::reset(x);
+        resetAll<Next, Rest...>(x);
+    }
+
+    template <class S>
+    void configureAll(const FilterConfig &c) { S::configure(c); }
+    template <class S, class Next, class... Rest>
+    void configureAll(const FilterConfig &c)
+    {
+        S::configure(c);
+        configureAll<Next, Rest...>(c);
+    }
+};
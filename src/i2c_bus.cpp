@@ -0,0 +1,231 @@
+#include "i2c_bus.h"
+#include "tca_breakout.h"
+#include "trace.h"
+
+namespace
+{
+    constexpr uint8_t DEV_COUNT = static_cast<uint8_t>(I2CDev::Count);
+    constexpr int8_t MUX_UNKNOWN = -2; // after boot or a failed select
+
+    constexpr uint32_t devClock[DEV_COUNT] = {
+        I2C_CLK_FAST,  // Mux
+        I2C_CLK_FAST,  // Oled
+        I2C_CLK_SMBUS, // Temp
+        I2C_CLK_FAST,  // Scale
+        I2C_CLK_FAST   // Colour
+    };
+
+    const char *const devName[DEV_COUNT] = {"mux", "oled", "mlx", "nau", "tcs"};
+#if TRACE_EN
+    const char *const leaseTrace[DEV_COUNT] = {"i2c.mux", "i2c.oled", "i2c.mlx", "i2c.nau", "i2c.tcs"};
+#endif
+
+    int8_t currentCh = MUX_UNKNOWN;
+    uint32_t currentClock = 0;
+
+    I2CBus::DevStats devStats[DEV_COUNT] = {};
+    I2CBus::MuxStats mux = {};
+
+#if defined(ESP32)
+    SemaphoreHandle_t busLock = nullptr;
+    // Per-device counters only: a few increments, so the DRDY reader can
+    // count its transfers without ever waiting on busLock
+    portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+    inline uint8_t idx(I2CDev dev) { return static_cast<uint8_t>(dev); }
+
+    // Bus lock held
+    void applyClock(uint32_t hz)
+    {
+        if (hz == currentClock)
+            return;
+        Wire.setClock(hz);
+        currentClock = hz;
+        ++mux.clockSwitches;
+    }
+
+    void lock()
+    {
+#if defined(ESP32)
+        if (busLock)
+            xSemaphoreTakeRecursive(busLock, portMAX_DELAY);
+#endif
+    }
+
+    void unlock()
+    {
+#if defined(ESP32)
+        if (busLock)
+            xSemaphoreGiveRecursive(busLock);
+#endif
+    }
+
+    inline void statsEnter()
+    {
+#if defined(ESP32)
+        portENTER_CRITICAL(&statsMux);
+#endif
+    }
+
+    inline void statsExit()
+    {
+#if defined(ESP32)
+        portEXIT_CRITICAL(&statsMux);
+#endif
+    }
+}
+
+namespace I2CBus
+{
+
+    bool begin(int sda, int scl)
+    {
+#if defined(ESP32)
+        if (!busLock)
+            busLock = xSemaphoreCreateRecursiveMutex();
+#endif
+        lock();
+        bool ok = Wire.begin(sda, scl);
+        currentClock = 0;
+        applyClock(I2C_CLK_FAST);
+        currentCh = MUX_UNKNOWN;
+        unlock();
+        return ok;
+    }
+
+    bool acquire(I2CDev dev, int8_t muxCh)
+    {
+        const uint32_t hz = devClock[idx(dev)];
+        const bool exclusive = muxCh >= 0 || hz != I2C_CLK_FAST;
+        // Even a shared lease waits here for an exclusive one to finish, so
+        // it never sees (or sets) the clock mid-lease; it just doesn't keep
+        // the lock afterwards
+        lock();
+        // traced after the lock so waiting for the bus shows as a gap
+        TRACE_BEGIN_ARG(leaseTrace[idx(dev)], muxCh);
+        statsEnter();
+        ++devStats[idx(dev)].leases;
+        statsExit();
+        selectChannel(muxCh);
+        applyClock(hz);
+        if (!exclusive)
+            unlock();
+        return exclusive;
+    }
+
+    void release(I2CDev dev, bool locked)
+    {
+        if (locked && devClock[idx(dev)] != I2C_CLK_FAST)
+            applyClock(I2C_CLK_FAST);
+        TRACE_END(leaseTrace[idx(dev)]);
+        if (locked)
+            unlock();
+    }
+
+    void selectChannel(int8_t ch)
+    {
+        if (ch < 0)
+            return;
+
+        lock();
+        if (ch == currentCh)
+            ++mux.skipped;
+        else
+        {
+            const uint8_t mask = (uint8_t)(1 << (ch & 7));
+            ++mux.selects;
+            currentCh = write(I2CDev::Mux, TCA_ADDR, &mask, 1) ? ch : MUX_UNKNOWN;
+        }
+        unlock();
+    }
+
+    bool write(I2CDev dev, uint8_t addr, const uint8_t *buf, size_t n)
+    {
+        TRACE_SCOPE_ARG("i2c.write", n);
+        Wire.beginTransmission(addr);
+        Wire.write(buf, n);
+        bool ok = Wire.endTransmission() == 0;
+        account(dev, 1, n);
+        return ok;
+    }
+
+    bool writeRead(I2CDev dev, uint8_t addr,
+                   const uint8_t *out, size_t nOut,
+                   uint8_t *in, size_t nIn)
+    {
+        TRACE_SCOPE_ARG("i2c.write_read", nOut + nIn);
+        account(dev, 1, nOut + nIn);
+
+        Wire.beginTransmission(addr);
+        Wire.write(out, nOut);
+        if (Wire.endTransmission(false) != 0)
+            return false;
+        if (Wire.requestFrom(addr, (uint8_t)nIn) != nIn)
+            return false;
+        for (size_t i = 0; i < nIn; i++)
+            in[i] = (uint8_t)Wire.read();
+        return true;
+    }
+
+    void account(I2CDev dev, uint16_t txns, uint32_t bytes)
+    {
+        statsEnter();
+        DevStats &s = devStats[idx(dev)];
+        s.txns += txns;
+        s.bytes += bytes;
+        statsExit();
+    }
+
+    DevStats stats(I2CDev dev)
+    {
+        statsEnter();
+        const DevStats s = devStats[idx(dev)];
+        statsExit();
+        return s;
+    }
+
+    MuxStats muxStats()
+    {
+        lock();
+        const MuxStats m = mux;
+        unlock();
+        return m;
+    }
+
+    void resetStats()
+    {
+        lock();
+        statsEnter();
+        for (auto &s : devStats)
+            s = DevStats{};
+        statsExit();
+        mux = MuxStats{};
+        unlock();
+    }
+
+    void printStats(Print &out)
+    {
+        // Copy, then print: Serial at 115200 would hold the bus for tens of ms
+        DevStats devs[DEV_COUNT];
+        lock();
+        statsEnter();
+        memcpy(devs, devStats, sizeof(devs));
+        statsExit();
+        const MuxStats m = mux;
+        unlock();
+
+        for (uint8_t i = 0; i < DEV_COUNT; i++)
+        {
+            const DevStats &s = devs[i];
+            out.printf("[I2C] %-4s @%3luk leases=%lu txns=%lu bytes=%lu\n",
+                       devName[i], (unsigned long)(devClock[i] / 1000),
+                       (unsigned long)s.leases, (unsigned long)s.txns,
+                       (unsigned long)s.bytes);
+        }
+        out.printf("[I2C] mux selects=%lu skipped=%lu clock switches=%lu\n",
+                   (unsigned long)m.selects, (unsigned long)m.skipped,
+                   (unsigned long)m.clockSwitches);
+    }
+
+} // namespace I2CBus
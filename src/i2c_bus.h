@@ -0,0 +1,90 @@
+#pragma once
+
+// Owner of the shared Wire bus: remembers which TCA9548A channel is selected,
+// runs each device at its own SCL clock and keeps per-device traffic counters.
+//
+// The bus idles at I2C_CLK_FAST. Leases that select a mux channel or need a
+// different clock own the bus exclusively until released (the clock goes
+// back to I2C_CLK_FAST on release). Upstream devices at the idle clock (OLED,
+// NAU7802) take the lock only while their lease is set up, which waits out
+// any exclusive lease in progress, and then rely on Wire's per-transaction
+// lock, so a long blocking driver call on one core never stalls the other.
+// The cached channel and the clock only change under the lock. The
+// per-device counters have a short critical section of their own, so
+// counting a transfer (the NAU7802 DRDY reader's, say) never waits for it.
+
+#include <Arduino.h>
+#include <Wire.h>
+
+// =============== User knobs ===============
+#define I2C_CLK_FAST 400000UL  // OLED, NAU7802, TCS34725, TCA9548A
+#define I2C_CLK_SMBUS 100000UL // MLX90614 is an SMBus part (max 100 kHz)
+// =========================================
+
+enum class I2CDev : uint8_t
+{
+    Mux = 0, // TCA9548A channel selects
+    Oled,
+    Temp,   // MLX90614
+    Scale,  // NAU7802
+    Colour, // TCS34725 x3
+    Count
+};
+
+namespace I2CBus
+{
+    struct DevStats
+    {
+        uint32_t leases; // times the bus was taken for this device
+        uint32_t txns;   // START conditions (write+read with repeated start = 1)
+        uint32_t bytes;  // payload bytes, address bytes excluded
+    };
+
+    struct MuxStats
+    {
+        uint32_t selects; // channel writes actually sent
+        uint32_t skipped; // selects satisfied by the cached channel
+        uint32_t clockSwitches;
+    };
+
+    bool begin(int sda, int scl);
+
+    // Take the bus for one device: selects muxCh if it is >= 0 and not
+    // already selected and applies the device's clock. Returns true if the
+    // bus was locked (recursively); pass that back to release().
+    bool acquire(I2CDev dev, int8_t muxCh = -1);
+    void release(I2CDev dev, bool locked);
+
+    // Cached TCA9548A select; ch < 0 leaves the mux alone
+    void selectChannel(int8_t ch);
+
+    // Counted raw transfers for code that talks to registers directly
+    bool write(I2CDev dev, uint8_t addr, const uint8_t *buf, size_t n);
+    bool writeRead(I2CDev dev, uint8_t addr,
+                   const uint8_t *out, size_t nOut,
+                   uint8_t *in, size_t nIn);
+
+    // For traffic generated inside third-party drivers (known per-call cost)
+    void account(I2CDev dev, uint16_t txns, uint32_t bytes);
+
+    DevStats stats(I2CDev dev);
+    MuxStats muxStats();
+    void resetStats();
+    void printStats(Print &out);
+} // namespace I2CBus
+
+// Scoped I2CBus::acquire()/release()
+class I2CLease
+{
+public:
+    explicit I2CLease(I2CDev dev, int8_t muxCh = -1)
+        : _dev(dev), _locked(I2CBus::acquire(dev, muxCh)) {}
+    ~I2CLease() { I2CBus::release(_dev, _locked); }
+
+    I2CLease(const I2CLease &) = delete;
+    I2CLease &operator=(const I2CLease &) = delete;
+
+private:
+    I2CDev _dev;
+    bool _locked;
+};
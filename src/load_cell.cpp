@@ -1,31 +1,50 @@
 #include "load_cell.h"
+#include "i2c_bus.h"
+#include "settings.h"
 
-static bool eepromReady = false;
-static inline void eepromBeginIfNeeded()
+// One getReading(): register pointer + 24-bit sample. The SparkFun driver's
+// PU_CTRL polling in available() is not included in the counters.
+static inline void accountReadings(uint16_t n)
 {
+    I2CBus::account(I2CDev::Scale, n, n * 4u);
+}
+
+#if LC_STREAM_EN
+static constexpr uint8_t NAU_ADDR = 0x2A;
+static constexpr uint32_t LC_SAMPLE_US = 1000000UL / LC_STREAM_SPS;
+static_assert((LC_RING_SAMPLES & (LC_RING_SAMPLES - 1)) == 0, "LC_RING_SAMPLES must be a power of 2");
+static_assert(LC_STREAM_SPS == 80 || LC_STREAM_SPS == 320, "LC_STREAM_SPS must be 80 or 320");
+
 #if defined(ESP32)
-    if (!eepromReady)
-    {
-        EEPROM.begin(64);
-        eepromReady = true;
-    }
+// The DRDY ISR needs an object; there is one scale
+static LoadCellNAU7802 *streamOwner = nullptr;
+#endif
 #endif
-}
 
 bool LoadCellNAU7802::begin(float countsPerGram)
 {
-    if (!_scale.begin())
+    I2CLease lease(I2CDev::Scale);
+    // The library's own bring-up, but at the final rate, so the AFE is
+    // calibrated once rather than at 80 SPS and again after the switch
+    if (!_scale.begin(Wire, false) || !_scale.reset() || !_scale.powerUp())
         return false;
-
-    // Your original ritual
-    _scale.setGain(128);
-    _scale.setSampleRate(10);
+    _scale.setLDO(NAU7802_LDO_3V3);
+    _scale.setGain(NAU7802_GAIN_128);
+#if LC_STREAM_EN
+    _scale.setSampleRate(LC_STREAM_SPS == 320 ? NAU7802_SPS_320 : NAU7802_SPS_80);
+    _scale.setIntPolarityHigh();
+    _scale.clearBit(NAU7802_CTRL1_DRDY_SEL, NAU7802_CTRL1); // DRDY pin = conversion ready
+#else
+    _scale.setSampleRate(NAU7802_SPS_320);
+#endif
+    _scale.setRegister(NAU7802_ADC, 0x30); // CLK_CHP off
+    _scale.setBit(7, NAU7802_PGA_PWR);     // PGA output cap
     _scale.calibrateAFE();
 
-#if LC_EEPROM_EN
+#if LC_SAVE_EN
     if (isnan(countsPerGram))
     {
-        loadFromEEPROM();
+        loadCalibration();
     }
     else
     {
@@ -38,15 +57,63 @@ bool LoadCellNAU7802::begin(float countsPerGram)
 
     _scale.setCalibrationFactor(_cpg);
 
-    // quick tare: average a few readings for zero offset
-    _zeroOffset = averagedReading(16);
+    // Zero: a short look first. Empty and still against the saved zero ->
+    // keep it; anything else -> the full tare, saved for the next boot
+    // when the scale was still.
+    long mean, spread;
+    if (!averagedReading(LC_BOOT_READINGS, mean, &spread))
+        return false;
+    const bool still = spread / _cpg <= LC_OP_MAX_SPREAD_G;
+    bool restored = false;
+#if LC_SAVE_EN
+    int32_t saved;
+    if (still && Settings::get(Setting::ScaleZero, saved) && fabsf((mean - saved) / _cpg) <= LC_ZERO_RESTORE_G)
+    {
+        _zeroOffset = saved;
+        restored = true;
+    }
+#endif
+    if (!restored)
+    {
+        long rest, restSpread;
+        const int more = LC_TARE_READINGS > LC_BOOT_READINGS ? LC_TARE_READINGS - LC_BOOT_READINGS : 0;
+        if (more && !averagedReading(more, rest, &restSpread))
+            return false;
+        _zeroOffset = more ? (mean * LC_BOOT_READINGS + rest * more) / (LC_BOOT_READINGS + more) : mean;
+#if LC_SAVE_EN
+        if (still && (!more || restSpread / _cpg <= LC_OP_MAX_SPREAD_G))
+            Settings::set(Setting::ScaleZero, (int32_t)_zeroOffset);
+#endif
+    }
     _scale.setZeroOffset(_zeroOffset);
+    Serial.printf("[LC] zero %s\n", restored ? "restored" : "tared");
 
     // init stream
+#if LC_STREAM_EN
+    _filter.configure(filterConfig((float)LC_CIC_DECIM / LC_STREAM_SPS));
+#else
+    _filter.configure(filterConfig(_period / 1000.0f));
+#endif
+    _filter.reset(0.0f);
     _w_raw_g = 0;
     _w_g = 0;
     _baseline_g = 0;
     _inited = true;
+
+#if LC_STREAM_EN
+    _cic.reset();
+    _ringHead.store(0);
+    _ringTail.store(0);
+    _lastSampleUs = micros();
+    pinMode(LC_DRDY_PIN, INPUT);
+#if defined(ESP32)
+    streamOwner = this;
+    attachInterrupt(digitalPinToInterrupt(LC_DRDY_PIN), drdyIsr, RISING);
+    if (!_reader)
+        xTaskCreatePinnedToCore(readerTask, "scale", LC_READER_STACK, this,
+                                LC_READER_PRIO, &_reader, LC_READER_CORE);
+#endif
+#endif
     return true;
 }
 
@@ -54,22 +121,38 @@ void LoadCellNAU7802::update()
 {
     if (!_inited)
         return;
+#if LC_STREAM_EN
+#if !defined(ESP32)
+    // No reader task: gather one decimation block here instead
+    collectBlock();
+#endif
+    const bool fresh = drainRing();
+#else
+    bool fresh = false;
     uint32_t now = millis();
-    if (now - _last < _period)
-        return;
-    _last = now;
-
-    // SparkFun helper: getWeight(true) does avail/waiting internally
-    float g = _scale.getWeight(true);
-
-    // deadband small/negative like your sketch
-    if (fabsf(g) <= LC_DEADBAND_G)
-        g = 0.0f;
-
-    _w_raw_g = g;
+    if (now - _last >= _period)
+    {
+        _last = now;
+        int32_t counts;
+        {
+            I2CLease lease(I2CDev::Scale);
+            counts = _scale.getAverage(8, LC_READ_TIMEOUT_MS); // 0 on timeout
+            accountReadings(8);
+        }
+        if (counts != 0)
+        {
+            onReading(counts);
+            fresh = true;
+        }
+    }
+#endif
 
-    // EMA smoothing so prints are stable
-    _w_g = (1.0f - LC_SMOOTH_ALPHA) * _w_g + LC_SMOOTH_ALPHA * g;
+    // An operation times out even if no readings arrive at all
+    if (!fresh)
+    {
+        checkOpTimeout();
+        return;
+    }
 
     // ---- Optional OLED feedback ----
     if (_oled)
@@ -85,104 +168,406 @@ void LoadCellNAU7802::update()
     }
 }
 
-void LoadCellNAU7802::tare()
+FilterConfig LoadCellNAU7802::filterConfig(float dtS)
 {
-    _zeroOffset = averagedReading(32);
-    _scale.setZeroOffset(_zeroOffset);
-    _baseline_g = 0.0f;
-#if LC_EEPROM_EN
-    saveToEEPROM(); // keep zero across boots if you like
+    FilterConfig c;
+    c.dtS = dtS;
+    c.deadbandG = LC_DEADBAND_G;
+    c.emaAlpha = LC_SMOOTH_ALPHA;
+    c.kalmanSigmaG = LC_KALMAN_SIGMA_G;
+    c.kalmanAccel = LC_KALMAN_ACCEL;
+    c.kalmanJumpG = LC_KALMAN_JUMP_G;
+    return c;
+}
+
+float LoadCellNAU7802::readingLagS() const
+{
+#if LC_STREAM_EN
+    const float dtS = (float)LC_CIC_DECIM / LC_STREAM_SPS;
+    return _cic.delaySamples() / LC_STREAM_SPS + (_filter.delaySamples() + 0.5f) * dtS;
+#else
+    const float dtS = _period / 1000.0f;
+    return (_filter.delaySamples() + 0.5f) * dtS;
 #endif
 }
 
-bool LoadCellNAU7802::calibrate(float knownMass_g)
+LoadCellNAU7802::StreamStats LoadCellNAU7802::streamStats() const
 {
-    if (knownMass_g <= 0.0f)
+    return _stream;
+}
+
+#if LC_STREAM_EN
+// ---------- Streaming (DRDY -> ring -> CIC) ----------
+
+bool LoadCellNAU7802::readSample(int32_t &counts)
+{
+    // No lease: the reader runs beside other tasks' leases and must never
+    // retune the clock under them, nor wait for them (the transfer is
+    // counted without the bus lock). A 3-byte read of an upstream part
+    // works at either clock and whatever mux channel is selected.
+    const uint8_t reg = NAU7802_ADCO_B2;
+    uint8_t b[3];
+    if (!I2CBus::writeRead(I2CDev::Scale, NAU_ADDR, &reg, 1, b, sizeof(b)))
         return false;
 
-    // ensure zeroed first
-    tare();
+    uint32_t v = ((uint32_t)b[0] << 16) | ((uint32_t)b[1] << 8) | b[2];
+    if (v & 0x00800000)
+        v |= 0xFF000000; // sign-extend 24-bit
+    counts = (int32_t)v;
+    return true;
+}
 
-    // ask user to place known mass, settle a moment (caller can also wait)
-    delay(300);
+void LoadCellNAU7802::pushSample(int32_t counts)
+{
+    const uint32_t now = micros();
+    const uint32_t gap = now - _lastSampleUs;
+    _lastSampleUs = now;
+    if (gap > LC_SAMPLE_US * 3 / 2)
+        _stream.missed += (gap + LC_SAMPLE_US / 2) / LC_SAMPLE_US - 1;
+    _stream.samples++;
+
+    const uint16_t head = _ringHead.load(std::memory_order_relaxed);
+    if ((uint16_t)(head - _ringTail.load(std::memory_order_acquire)) >= LC_RING_SAMPLES)
+    {
+        _stream.overruns++;
+        return;
+    }
+    _ring[head & (LC_RING_SAMPLES - 1)] = counts;
+    _ringHead.store(head + 1, std::memory_order_release);
+}
 
-    // average counts at this load
-    long countsWithMass = averagedReading(32);
-    long deltaCounts = countsWithMass - _zeroOffset;
-    if (deltaCounts <= 0)
-        return false;
+bool LoadCellNAU7802::drainRing()
+{
+    bool fresh = false;
+    uint16_t tail = _ringTail.load(std::memory_order_relaxed);
+    const uint16_t head = _ringHead.load(std::memory_order_acquire);
+    for (; tail != head; ++tail)
+    {
+        int32_t counts;
+        if (!_cic.push(_ring[tail & (LC_RING_SAMPLES - 1)], counts))
+            continue;
+        onReading(counts);
+        _stream.outputs++;
+        fresh = true;
+    }
+    _ringTail.store(tail, std::memory_order_release);
+    return fresh;
+}
 
-    _cpg = (float)deltaCounts / knownMass_g;
-    _scale.setCalibrationFactor(_cpg);
+#if defined(ESP32)
+void IRAM_ATTR LoadCellNAU7802::drdyIsr()
+{
+    BaseType_t woken = pdFALSE;
+    if (streamOwner && streamOwner->_reader)
+        vTaskNotifyGiveFromISR(streamOwner->_reader, &woken);
+    if (woken)
+        portYIELD_FROM_ISR();
+}
 
-#if LC_EEPROM_EN
-    saveToEEPROM();
+void LoadCellNAU7802::readerTask(void *arg)
+{
+    LoadCellNAU7802 *lc = static_cast<LoadCellNAU7802 *>(arg);
+    const TickType_t timeout = pdMS_TO_TICKS(2 * LC_SAMPLE_US / 1000 + 2);
+    for (;;)
+    {
+        // DRDY stays high until ADCO is read, so a lost edge would stall
+        // the stream for good: on timeout, check the pin and read anyway.
+        const bool edge = ulTaskNotifyTake(pdTRUE, timeout) > 0;
+        if (!edge && !digitalRead(LC_DRDY_PIN))
+            continue;
+
+        int32_t counts;
+        if (lc->readSample(counts))
+            lc->pushSample(counts);
+    }
+}
+#else
+void LoadCellNAU7802::collectBlock()
+{
+    // Nothing reads the chip between update() calls here, so read one
+    // decimation block back to back, waiting on DRDY like the reader task.
+    _lastSampleUs = micros();
+    for (uint16_t n = 0; n < _cic.decimation(); n++)
+    {
+        const uint32_t t0 = micros();
+        while (!digitalRead(LC_DRDY_PIN))
+        {
+            if ((uint32_t)micros() - t0 > 4 * LC_SAMPLE_US)
+                return; // DRDY not wired / chip not converting
+            delayMicroseconds(50);
+        }
+        int32_t counts;
+        if (!readSample(counts))
+            return;
+        pushSample(counts);
+    }
+}
+#endif
 #endif
+
+void LoadCellNAU7802::onReading(int32_t counts)
+{
+    accumulateOp(counts);
+    _w_raw_g = (float)(counts - _zeroOffset) / _cpg;
+    _w_g = _filter.step(_w_raw_g);
+}
+
+// ---------- Tare / calibration ----------
+
+bool LoadCellNAU7802::startOp(OpKind kind, float massG, uint16_t readings, uint32_t timeoutMs)
+{
+    if (!_inited || opStatus() == OpStatus::Running)
+        return false;
+    _opKind = kind;
+    _opMassG = massG;
+    _opNeeded = max<uint16_t>(1, readings);
+    _opSkip = 1; // the reading in flight may predate the request
+    _opCount = 0;
+    _opSum = 0;
+    _opStartMs = millis();
+    _opTimeoutMs = timeoutMs;
+    _opStatus.store(OpStatus::Running, std::memory_order_release);
     return true;
 }
 
+bool LoadCellNAU7802::startTare(uint16_t readings, uint32_t timeoutMs)
+{
+    return startOp(OpKind::Tare, 0.0f, readings, timeoutMs);
+}
+
+bool LoadCellNAU7802::startCalibrate(float knownMass_g, uint16_t readings, uint32_t timeoutMs)
+{
+    if (knownMass_g <= 0.0f)
+        return false;
+    return startOp(OpKind::Calibrate, knownMass_g, readings, timeoutMs);
+}
+
+void LoadCellNAU7802::cancelOp()
+{
+    OpStatus running = OpStatus::Running;
+    _opStatus.compare_exchange_strong(running, OpStatus::Idle, std::memory_order_acq_rel);
+}
+
+float LoadCellNAU7802::opProgress() const
+{
+    const OpStatus st = opStatus();
+    if (st == OpStatus::Done)
+        return 1.0f;
+    if (st != OpStatus::Running || _opNeeded == 0)
+        return 0.0f;
+    return min(1.0f, (float)_opCount / _opNeeded);
+}
+
+const char *LoadCellNAU7802::opStatusName(OpStatus s)
+{
+    switch (s)
+    {
+    case OpStatus::Idle:
+        return "idle";
+    case OpStatus::Running:
+        return "running";
+    case OpStatus::Done:
+        return "done";
+    case OpStatus::Timeout:
+        return "timeout";
+    case OpStatus::Unstable:
+        return "unstable";
+    default:
+        return "failed";
+    }
+}
+
+void LoadCellNAU7802::checkOpTimeout()
+{
+    if (opStatus() == OpStatus::Running && millis() - _opStartMs > _opTimeoutMs)
+        finishOp(OpStatus::Timeout);
+}
+
+void LoadCellNAU7802::accumulateOp(int32_t counts)
+{
+    if (opStatus() != OpStatus::Running)
+        return;
+    if (_opSkip)
+    {
+        --_opSkip;
+        return;
+    }
+    if (_opCount == 0 || counts < _opMin)
+        _opMin = counts;
+    if (_opCount == 0 || counts > _opMax)
+        _opMax = counts;
+    _opSum += counts;
+    if (++_opCount < _opNeeded)
+    {
+        checkOpTimeout();
+        return;
+    }
+
+    if ((float)(_opMax - _opMin) / _cpg > LC_OP_MAX_SPREAD_G)
+    {
+        finishOp(OpStatus::Unstable);
+        return;
+    }
+
+    const long avg = (long)(_opSum / _opCount);
+    if (_opKind == OpKind::Tare)
+    {
+        _zeroOffset = avg;
+        _scale.setZeroOffset(_zeroOffset);
+        _baseline_g = 0.0f;
+        _filter.reset(0.0f);
+    }
+    else
+    {
+        const long deltaCounts = avg - _zeroOffset;
+        if (deltaCounts <= 0)
+        {
+            finishOp(OpStatus::Failed);
+            return;
+        }
+        _cpg = (float)deltaCounts / _opMassG;
+        _scale.setCalibrationFactor(_cpg);
+        _filter.reset(_opMassG);
+    }
+#if LC_SAVE_EN
+    saveCalibration(); // keep zero/factor across boots
+#endif
+    finishOp(OpStatus::Done);
+}
+
+void LoadCellNAU7802::finishOp(OpStatus result)
+{
+    _opStatus.store(result, std::memory_order_release);
+}
+
 void LoadCellNAU7802::setCountsPerGram(float cpg)
 {
     if (cpg > 0.0f)
     {
         _cpg = cpg;
         _scale.setCalibrationFactor(_cpg);
-#if LC_EEPROM_EN
-        saveToEEPROM();
+#if LC_SAVE_EN
+        saveCalibration();
 #endif
     }
 }
 
-long LoadCellNAU7802::averagedReading(int samples)
+// Direct reads, before the stream runs (begin() only)
+bool LoadCellNAU7802::averagedReading(int samples, long &out, long *spread)
 {
-    long sum = 0;
+    I2CLease lease(I2CDev::Scale);
+    long sum = 0, lo = 0, hi = 0;
     int n = max(1, samples);
+    uint32_t lastMs = millis();
     for (int i = 0; i < n;)
     {
         if (_scale.available())
         {
-            sum += _scale.getReading();
+            const long v = _scale.getReading();
+            sum += v;
+            lo = (i == 0 || v < lo) ? v : lo;
+            hi = (i == 0 || v > hi) ? v : hi;
             ++i;
+            lastMs = millis();
+        }
+        else if (millis() - lastMs > LC_READ_TIMEOUT_MS)
+        {
+            return false;
         }
     }
-    return sum / n;
+    accountReadings(n);
+    out = sum / n;
+    if (spread)
+        *spread = hi - lo;
+    return true;
 }
 
-void LoadCellNAU7802::handleSerial()
+// ---------- CicDecimator ----------
+
+void CicDecimator::reset()
 {
-    if (!Serial.available())
-        return;
-    char c = (char)Serial.read();
+    for (int i = 0; i < ORDER; i++)
+        _integ[i] = _comb[i] = 0;
+    _phase = 0;
+    _warmup = ORDER;
+}
 
-    if (c == 't')
+bool CicDecimator::push(int32_t x, int32_t &out)
+{
+    // Unsigned so the integrators wrap (well-defined); the combs undo the
+    // wrap exactly as long as the true output fits in 64 bits.
+    uint64_t v = (uint64_t)(int64_t)x;
+    for (int i = 0; i < ORDER; i++)
+        v = _integ[i] += v;
+    if (++_phase < _r)
+        return false;
+    _phase = 0;
+
+    for (int i = 0; i < ORDER; i++)
     {
-        Serial.println("[LC] Tare...");
-        tare();
-        Serial.println("[LC] Tare done.");
+        const uint64_t prev = _comb[i];
+        _comb[i] = v;
+        v -= prev;
     }
-    else if (c == 'c')
+    if (_warmup)
     {
-        Serial.printf("[LC] Calibrate using %.1fg... remove all weight, press any key\n", LC_KNOWN_MASS_G);
-        while (!Serial.available())
-            delay(10);
-        while (Serial.available())
-            Serial.read();
+        --_warmup;
+        return false;
+    }
 
-        tare();
+    const int64_t gain = (int64_t)_r * _r * _r;
+    const int64_t y = (int64_t)v;
+    out = (int32_t)((y >= 0 ? y + gain / 2 : y - gain / 2) / gain);
+    return true;
+}
 
-        Serial.println("[LC] Place known mass, press any key when stable...");
-        while (!Serial.available())
-            delay(10);
-        while (Serial.available())
-            Serial.read();
+void LoadCellNAU7802::reportOp()
+{
+    const OpStatus st = opStatus();
+    if (st == _serialReported)
+        return;
+    _serialReported = st;
+    const char *what = _opKind == OpKind::Tare ? "Tare" : "Calibration";
+    if (st == OpStatus::Done)
+        Serial.printf("[LC] %s done (zero=%ld, countsPerGram=%.3f)\n", what, _zeroOffset, _cpg);
+    else if (st != OpStatus::Running && st != OpStatus::Idle)
+        Serial.printf("[LC] %s failed: %s\n", what, opStatusName(st));
+
+    // A calibration whose tare failed or was cancelled has no fresh zero
+    // to measure against: the next 'c' starts over
+    if (_serialCalArmed && _opKind == OpKind::Tare && st != OpStatus::Running && st != OpStatus::Done)
+    {
+        _serialCalArmed = false;
+        Serial.println("[LC] Calibration cancelled; press 'c' to start again");
+    }
+}
 
-        if (calibrate(LC_KNOWN_MASS_G))
+bool LoadCellNAU7802::handleCommand(char c)
+{
+    if (c == 't')
+    {
+        Serial.println(startTare() ? "[LC] Tare..." : "[LC] Busy");
+    }
+    else if (c == 'c')
+    {
+        // Two presses: tare the empty scale, then measure the known mass
+        if (!_serialCalArmed)
         {
-            Serial.printf("[LC] New countsPerGram = %.3f\n", _cpg);
+            _serialCalArmed = startTare();
+            if (_serialCalArmed)
+                Serial.printf("[LC] Calibrate using %.1fg: taring; then place the mass and press 'c' again\n",
+                              LC_KNOWN_MASS_G);
+            else
+                Serial.println("[LC] Busy");
+        }
+        else if (startCalibrate(LC_KNOWN_MASS_G))
+        {
+            _serialCalArmed = false;
+            Serial.println("[LC] Measuring known mass...");
         }
         else
         {
-            Serial.println("[LC] Calibration failed (deltaCounts <= 0?)");
+            Serial.println("[LC] Busy");
         }
     }
     else if (c == 'b')
@@ -190,41 +575,30 @@ void LoadCellNAU7802::handleSerial()
         setBaselineToCurrent();
         Serial.printf("[LC] Baseline set to %.2fg\n", _baseline_g);
     }
+    else
+    {
+        return false;
+    }
+    return true;
 }
 
-void LoadCellNAU7802::loadFromEEPROM()
+void LoadCellNAU7802::loadCalibration()
 {
-#if LC_EEPROM_EN
-    eepromBeginIfNeeded();
-    if (EEPROM.read(LC_EE_BASE) != LC_EE_SIG)
-        return;
-
-    uint8_t *p = (uint8_t *)&_cpg;
-    for (int i = 0; i < 4; i++)
-        p[i] = EEPROM.read(LC_EE_BASE + 1 + i);
-
-    long z = 0;
-    for (int i = 0; i < 4; i++)
-        ((uint8_t *)&z)[i] = EEPROM.read(LC_EE_BASE + 5 + i);
-    _zeroOffset = z;
+#if LC_SAVE_EN
+    float cpg;
+    int32_t zero;
+    if (Settings::get(Setting::ScaleCountsPerGram, cpg) && cpg > 0.0f && isfinite(cpg))
+        _cpg = cpg;
+    if (Settings::get(Setting::ScaleZero, zero))
+        _zeroOffset = zero;
 #endif
 }
 
-void LoadCellNAU7802::saveToEEPROM()
+void LoadCellNAU7802::saveCalibration()
 {
-#if LC_EEPROM_EN
-    eepromBeginIfNeeded();
-    EEPROM.write(LC_EE_BASE, LC_EE_SIG);
-    uint8_t *p = (uint8_t *)&_cpg;
-    for (int i = 0; i < 4; i++)
-        EEPROM.write(LC_EE_BASE + 1 + i, p[i]);
-
-    uint8_t *q = (uint8_t *)&_zeroOffset;
-    for (int i = 0; i < 4; i++)
-        EEPROM.write(LC_EE_BASE + 5 + i, q[i]);
-
-#if defined(ESP32)
-    EEPROM.commit();
-#endif
+#if LC_SAVE_EN
+    // Staged; Settings::poll() writes both in one image
+    Settings::set(Setting::ScaleCountsPerGram, _cpg);
+    Settings::set(Setting::ScaleZero, (int32_t)_zeroOffset);
 #endif
 }
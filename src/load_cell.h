@@ -2,20 +2,74 @@
 #include <Arduino.h>
 #include <SparkFun_Qwiic_Scale_NAU7802_Arduino_Library.h> // NAU7802
 #include <Wire.h>
-#include <EEPROM.h>
 #include <Adafruit_SSD1306.h> // for optional OLED display
 
+#include <atomic>
+
+#include "filter_chain.h"
+
 // =============== User knobs ===============
-#define LC_EEPROM_EN 1         // set 0 to disable EEPROM save/restore
+#define LC_SAVE_EN 1           // set 0 to never save/restore the calibration (settings.h)
 #define LC_KNOWN_MASS_G 200.0f // grams used during quick calibration
 #define LC_DEADBAND_G 0.5f     // treat |weight| < this as zero
-#define LC_SMOOTH_ALPHA 0.2f   // EMA smoothing 0..1 (higher = snappier)
+#define LC_SMOOTH_ALPHA 0.2f   // EMA smoothing 0..1 (higher = snappier), if LcFilter has an Ema
+#define LC_KALMAN_SIGMA_G 0.05f // per-sample noise the Kalman stage assumes
+#define LC_KALMAN_ACCEL 0.2f    // how fast the weight trend may change, g/s^2
+#define LC_KALMAN_JUMP_G 3.0f   // larger jumps are a load change: follow at once
+#define LC_TARE_READINGS 16     // readings averaged by startTare() (0.8 s streaming)
+#define LC_CAL_READINGS 32      // readings averaged by startCalibrate()
+#define LC_OP_TIMEOUT_MS 5000   // tare/calibrate give up after this
+#define LC_OP_MAX_SPREAD_G 2.0f // readings spread wider than this = scale not still
+#define LC_READ_TIMEOUT_MS 200  // begin()'s direct reads give up after this
+#define LC_BOOT_READINGS 8      // begin() looks this long before deciding on the zero
+#define LC_ZERO_RESTORE_G 1.0f  // ... and keeps the saved zero if it reads within this
 #define LC_PRINT_INTERVAL 250  // ms between prints (example main)
+
+// Streaming mode: the NAU7802 free-runs at LC_STREAM_SPS, every conversion
+// is read on its DRDY edge into a ring and update() decimates the ring with
+// a CIC filter. Output rate = LC_STREAM_SPS / LC_CIC_DECIM. Needs the chip's
+// DRDY pin wired to LC_DRDY_PIN; set 0 for the polled getWeight() path.
+#define LC_STREAM_EN 1
+#define LC_DRDY_PIN 27         // NAU7802 DRDY (active high)
+#define LC_STREAM_SPS 320      // 80 or 320
+#define LC_CIC_DECIM 16        // 320 SPS -> 20 Hz
+#define LC_RING_SAMPLES 64     // raw samples buffered between update() calls (power of 2)
+#define LC_READER_CORE 0
+#define LC_READER_PRIO 3       // above the sensor task: the chip has no FIFO
+#define LC_READER_STACK 2048
 // =========================================
 
-// EEPROM layout (ESP32 needs EEPROM.begin(size) once)
-static constexpr int LC_EE_BASE = 0x30;
-static constexpr uint8_t LC_EE_SIG = 0x5A;
+// Third-order CIC decimator (no droop compensation: a scale only uses the
+// passband near DC). Integer and exact; the R^3 gain is divided out, so the
+// output is in input counts. The first outputs after reset() are withheld
+// until the comb delays are filled.
+class CicDecimator
+{
+public:
+    explicit CicDecimator(uint16_t decim) : _r(decim ? decim : 1) { reset(); }
+
+    void reset();
+
+    // Feed one input; true (and out set) on every R-th input
+    bool push(int32_t x, int32_t &out);
+
+    uint16_t decimation() const { return _r; }
+    // Group delay in input samples
+    float delaySamples() const { return ORDER * (_r - 1) / 2.0f; }
+
+private:
+    static constexpr int ORDER = 3;
+    uint16_t _r;
+    uint16_t _phase = 0;
+    uint8_t _warmup = 0;
+    uint64_t _integ[ORDER];
+    uint64_t _comb[ORDER];
+};
+
+// Filter run on every new reading (decimated stream or polled average).
+// Compose from the stages in filter_chain.h; `pio run -e bench` reports
+// each stage's cost and step response.
+typedef FilterChain<MedianN<3>, Kalman1D, Deadband> LcFilter;
 
 class LoadCellNAU7802
 {
@@ -24,36 +78,100 @@ public:
         : _period(periodMs) {}
 
     // Call once in setup() after Wire.begin()
-    // If you already have a saved calibration, pass NAN to load it from EEPROM.
+    // If you already have a saved calibration, pass NAN to load it (settings.h).
     // Otherwise pass your known factor (counts per gram).
     bool begin(float countsPerGram = NAN);
 
-    // Call often (e.g., every loop); it self-throttles by _period
+    // Call often (e.g., every loop). Polled mode self-throttles by _period;
+    // streaming mode drains whatever the DRDY reader has buffered.
     void update();
 
-    // Commands
-    void tare();                       // fast tare (zero offset)
-    bool calibrate(float knownMass_g); // place known mass, computes new cal factor
+    struct StreamStats
+    {
+        uint32_t samples;  // raw conversions read
+        uint32_t outputs;  // decimated outputs
+        uint32_t overruns; // samples dropped because the ring was full
+        uint32_t missed;   // conversions the reader was too late for
+    };
+    StreamStats streamStats() const;
+
+    // ---------- Tare / calibration ----------
+    // Both average readings from the normal update() stream, so nothing
+    // blocks: start one from any task, then poll opStatus()/opProgress().
+    // A new result is applied (and saved) by update() when it completes.
+    enum class OpStatus : uint8_t
+    {
+        Idle,
+        Running,
+        Done,
+        Timeout,  // not enough readings in time (chip not converting?)
+        Unstable, // readings spread over LC_OP_MAX_SPREAD_G
+        Failed    // calibration: no positive load seen
+    };
+
+    // Zero offset from the current (empty) load. False if one is running.
+    bool startTare(uint16_t readings = LC_TARE_READINGS, uint32_t timeoutMs = LC_OP_TIMEOUT_MS);
+    // Counts per gram from knownMass_g, which must already be on the scale;
+    // uses the current zero, so tare first.
+    bool startCalibrate(float knownMass_g, uint16_t readings = LC_CAL_READINGS,
+                        uint32_t timeoutMs = LC_OP_TIMEOUT_MS);
+    void cancelOp();
+    OpStatus opStatus() const { return _opStatus.load(std::memory_order_acquire); }
+    float opProgress() const; // 0..1 of the readings needed
+    static const char *opStatusName(OpStatus s);
+
     void setCountsPerGram(float cpg);
     float countsPerGram() const { return _cpg; }
 
     // Getters (smoothed)
-    float weight_g() const { return _w_g; }  // net (after zero offset), smoothed
-    float raw_g() const { return _w_raw_g; } // unsmoothed latest
+    float weight_g() const { return _w_g; }  // net (after zero offset), filtered
+    float raw_g() const { return _w_raw_g; } // unfiltered latest
     float baseline_g() const { return _baseline_g; }
     void setBaselineToCurrent() { _baseline_g = _w_g; }
     float deltaFromBaseline_g() const { return _w_g - _baseline_g; }
 
-    // Optional: handle simple serial commands ('t' tare, 'c' calibrate, 'b' baseline)
-    void handleSerial();
+    // Configures LcFilter from the LC_* knobs for a given sample period
+    static FilterConfig filterConfig(float dtS);
+
+    // How far weight_g() trails the load on a slow ramp: decimator and
+    // filter group delay plus half a reading period
+    float readingLagS() const;
+
+    // Console commands ('t' tare, 'c' calibrate, 'b' baseline), fed one
+    // byte at a time by the caller. Non-blocking; false if c is not one.
+    bool handleCommand(char c);
+    // Print each finished tare / calibration once; call regularly
+    void reportOp();
 
     void attachDisplay(Adafruit_SSD1306 *disp) { _oled = disp; }
 
 private:
     // helpers
-    long averagedReading(int samples = 16);
-    void loadFromEEPROM();
-    void saveToEEPROM();
+    bool averagedReading(int samples, long &out, long *spread = nullptr);
+    void onReading(int32_t counts);
+    enum class OpKind : uint8_t
+    {
+        Tare,
+        Calibrate
+    };
+    bool startOp(OpKind kind, float massG, uint16_t readings, uint32_t timeoutMs);
+    void accumulateOp(int32_t counts);
+    void checkOpTimeout();
+    void finishOp(OpStatus result);
+#if LC_STREAM_EN
+    bool readSample(int32_t &counts);
+    void pushSample(int32_t counts);
+    bool drainRing();
+#if defined(ESP32)
+    static void drdyIsr();
+    static void readerTask(void *arg);
+    TaskHandle_t _reader = nullptr;
+#else
+    void collectBlock();
+#endif
+#endif
+    void loadCalibration();
+    void saveCalibration();
     Adafruit_SSD1306 *_oled = nullptr;
 
     NAU7802 _scale;
@@ -64,9 +182,32 @@ private:
     long _zeroOffset = 0;
 
     // data
-    float _w_raw_g = 0.0f;    // latest net grams (unsmoothed)
-    float _w_g = 0.0f;        // smoothed grams, deadband applied
+    float _w_raw_g = 0.0f;    // latest net grams (unfiltered)
+    float _w_g = 0.0f;        // LcFilter output
+    LcFilter _filter;
     float _baseline_g = 0.0f; // for “delta” readout
 
+    StreamStats _stream = {};
+#if LC_STREAM_EN
+    // DRDY reader -> update(): single producer, single consumer
+    int32_t _ring[LC_RING_SAMPLES];
+    std::atomic<uint16_t> _ringHead{0}, _ringTail{0};
+    CicDecimator _cic{LC_CIC_DECIM};
+    uint32_t _lastSampleUs = 0;
+#endif
+
+    // tare / calibrate in progress. The starter fills these, then
+    // publishes Running; update() owns them until it leaves Running.
+    std::atomic<OpStatus> _opStatus{OpStatus::Idle};
+    OpKind _opKind = OpKind::Tare;
+    float _opMassG = 0.0f;
+    uint16_t _opNeeded = 0, _opSkip = 0;
+    volatile uint16_t _opCount = 0;
+    uint32_t _opStartMs = 0, _opTimeoutMs = 0;
+    int64_t _opSum = 0;
+    int32_t _opMin = 0, _opMax = 0;
+    OpStatus _serialReported = OpStatus::Idle;
+    bool _serialCalArmed = false;
+
     bool _inited = false;
 };
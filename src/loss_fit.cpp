@@ -0,0 +1,82 @@
+#include "loss_fit.h"
+
+// Past this the forgetting factor is suspended: with the weight flat (before
+// drying starts) the slope direction is unexcited and P would grow without
+// bound, then throw the first real samples around.
+static constexpr float P_MAX = 1000.0f;
+
+void LossCurveFit::reset(float refG)
+{
+    _ref = refG;
+    _trend.reset();
+    _fits = 0;
+    _a = _b = 0.0f;
+    _p00 = _p11 = 1.0f;
+    _p01 = 0.0f;
+    _wNow = refG;
+    _rate = 0.0f;
+}
+
+void LossCurveFit::push(float weightG)
+{
+    _trend.push(weightG);
+    if (!_trend.full())
+    {
+        _wNow = weightG;
+        return;
+    }
+
+    // Trend mean and slope both describe the window's centre
+    const float slope = _trend.slope() / _dtS;
+    const float x = _trend.mean() - _ref;
+
+    // RLS update for slope = a + b x
+    const float lambda = (_p00 + _p11 < P_MAX) ? LOSS_FIT_FORGET : 1.0f;
+    const float px0 = _p00 + _p01 * x;
+    const float px1 = _p01 + _p11 * x;
+    const float den = lambda + px0 + x * px1;
+    const float k0 = px0 / den, k1 = px1 / den;
+    const float err = slope - (_a + _b * x);
+    _a += k0 * err;
+    _b += k1 * err;
+    _p00 = (_p00 - k0 * px0) / lambda;
+    _p01 = (_p01 - k0 * px1) / lambda;
+    _p11 = (_p11 - k1 * px1) / lambda;
+    if (_fits < UINT32_MAX)
+        _fits++;
+
+    // Newest point on the trend line rather than the noisy sample itself
+    _wNow = _trend.mean() + _trend.slope() * (LOSS_FIT_WINDOW - 1) * 0.5f;
+    _rate = exponential() ? _a + _b * (_wNow - _ref) : slope;
+}
+
+bool LossCurveFit::valid() const
+{
+    return _trend.full() && _rate < 0.0f;
+}
+
+bool LossCurveFit::exponential() const
+{
+    if (_fits < LOSS_FIT_WINDOW || _b >= 0.0f)
+        return false;
+    const float tau = tauS();
+    return tau >= LOSS_FIT_MIN_TAU_S && tau <= LOSS_FIT_MAX_TAU_S && endWeight() < _wNow;
+}
+
+float LossCurveFit::timeTo(float targetG) const
+{
+    if (!_trend.full())
+        return -1.0f;
+    if (_wNow <= targetG)
+        return 0.0f;
+    if (exponential())
+    {
+        const float end = endWeight();
+        if (targetG <= end)
+            return -1.0f; // the curve levels off above the target
+        return tauS() * logf((_wNow - end) / (targetG - end));
+    }
+    if (_rate < 0.0f)
+        return (_wNow - targetG) / -_rate;
+    return -1.0f;
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+
+#include "settle_detector.h"
+
+// =============== User knobs ===============
+#define LOSS_FIT_WINDOW 32        // samples per local trend (3.2 s at the 10 Hz toast loop)
+#define LOSS_FIT_FORGET 0.995f    // RLS forgetting per sample (~20 s memory at 10 Hz)
+#define LOSS_FIT_MIN_TAU_S 5.0f   // fitted time constants outside this range
+#define LOSS_FIT_MAX_TAU_S 1200.0f //   fall back to a straight-line ETA
+// =========================================
+
+// Online fit of the moisture-loss curve. Drying approaches an end weight
+// exponentially, w(t) = wEnd + (w0 - wEnd) e^(-t/tau), so the loss rate is
+// linear in the weight itself:
+//
+//   dw/dt = a + b (w - wRef),   b = -1/tau,  wEnd = wRef - a/b
+//
+// Each sample updates a sliding trend (mean and slope over LOSS_FIT_WINDOW
+// samples, both centred on the same instant) and the (mean, slope) pair
+// feeds a two-parameter recursive least-squares fit with forgetting, so the
+// model follows the cycle as it moves from warm-up into steady drying.
+// Nothing is differentiated sample to sample, and a noisy reading moves the
+// trend by 1/N of itself.
+class LossCurveFit
+{
+public:
+    explicit LossCurveFit(float dtS = 0.1f) : _dtS(dtS) { reset(0.0f); }
+
+    // New cycle; refG is the settled starting weight
+    void reset(float refG);
+
+    // One weight sample, every dtS
+    void push(float weightG);
+
+    // Enough history for a trend, and the weight is falling
+    bool valid() const;
+    // The fit has a plausible exponential shape (else ETA is straight-line)
+    bool exponential() const;
+
+    float weightNow() const { return _wNow; } // trend value at the latest sample
+    float rate() const { return _rate; }      // g/s at the latest sample (negative while drying)
+    float tauS() const { return _b < 0.0f ? -1.0f / _b : INFINITY; }
+    float endWeight() const { return _b < 0.0f ? _ref - _a / _b : -INFINITY; }
+
+    // Seconds after the latest sample until the trend reaches targetG;
+    // 0 if already there, negative if it is not heading there
+    float timeTo(float targetG) const;
+
+private:
+    float _dtS;
+    float _ref = 0.0f;
+    SlidingStats<LOSS_FIT_WINDOW> _trend;
+    uint32_t _fits = 0;
+
+    // RLS state: theta = (a, b), P symmetric
+    float _a = 0.0f, _b = 0.0f;
+    float _p00 = 1.0f, _p01 = 0.0f, _p11 = 1.0f;
+
+    float _wNow = 0.0f, _rate = 0.0f;
+};
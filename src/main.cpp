@@ -1,104 +1,98 @@
 #include <Arduino.h>
-#include "DisplayUI.h"
-#include "Input.h"
 #include "ModeUI.h"
+#include "trace.h"
+#include "cycle_log.h"
+#include "settings.h"
+#include "boot.h"
+#include "scheduler.h"
 #include "sensorManager.h"
 
-void setup()
-{
-  Serial.begin(115200);
-
-  if (!DisplayUI::begin())
-  {
-    DisplayUI::showInitError(F("SSD1306 alloc failed"));
-    while (true)
-    {
-      delay(1000);
-    }
-  }
-
-  Input::begin();
-  sensorsBegin();
-
-  DisplayUI::showSplash();
-  delay(3000);
-
-  ModeUI::begin();
-}
-
-void loop()
+namespace
 {
-  Mode selectedMode;
-
-  if (!ModeUI::mainMenuStep(selectedMode))
+  constexpr uint32_t CONSOLE_PERIOD_MS = 20;
+  constexpr uint32_t SETTINGS_PERIOD_MS = 100;
+
+  // Serial console: every byte is read here and routed, anything else is
+  // dropped (line endings included), so one stray byte can never block the
+  // commands behind it. Timing stats any time (also mid-cycle, to watch the
+  // control rate under load); the dumps stall the loop for a while and a
+  // cycle needs the scale as it is, so those and the scale commands only
+  // from the menu.
+  bool fromMenu(char cmd)
   {
-    // Stay in menu; avoid extra work to keep rotary snappy
-    return;
+    if (ModeUI::inMenu() && Boot::sensorsReady())
+      return true;
+    Serial.printf("[CON] '%c' only from the menu\n", cmd);
+    return false;
   }
 
-  switch (selectedMode)
-  {
-  case Mode::Toast:
+  void pollConsole()
   {
-    // Clear any residual press from the menu selection
-    Input::updateButton();
-    Input::consumeButtonPress();
-    while (Input::isButtonDown())
+    if (Boot::sensorsReady())
     {
-      delay(2);
-      Input::updateButton();
-      Input::consumeButtonPress();
+      // Without the sensor task nothing acquires in the menu: keep a
+      // tare / calibration fed from here (a no-op with the task running)
+      if (scaleOpStatus() == LoadCellNAU7802::OpStatus::Running)
+        sensorsUpdate();
+      scaleConsoleReport();
     }
-
-    bool tempGuided = ModeUI::runYesNoDialog(); // true if jig setup (temp-assisted)
-    ModeUI::runToastingFlow(tempGuided);
-    break;
-  }
-
-  case Mode::Sensors:
-  {
-    while (true)
+    while (Serial.available())
     {
-      sensorsUpdate();
-      SensorSnapshot s = getSensorSnapshot();
-
-      DisplayUI::showSensorShowcase(
-          s.tempC,
-          s.weightG,
-          s.r8, s.g8, s.b8,
-          s.brightness);
-
-      Input::updateButton();
-      if (Input::consumeButtonPress())
+      const char c = (char)Serial.read();
+      switch (c)
       {
+      case SCHED_SERIAL_CMD:
+        Sched::printStats(Serial);
+        break;
+#if TRACE_EN
+      case TRACE_SERIAL_CMD:
+        if (fromMenu(c))
+          Trace::dump(Serial);
+        break;
+#endif
+#if CYCLE_LOG_EN
+      case CYCLE_LOG_SERIAL_CMD:
+        if (fromMenu(c))
+          CycleLog::exportAll(Serial);
+        break;
+#endif
+      case 't': // scale tare / calibrate / baseline
+      case 'c':
+      case 'b':
+        if (fromMenu(c))
+          scaleConsoleCommand(c);
+        break;
+      default:
         break;
       }
-
-      delay(10);
     }
-    break;
   }
 
-  case Mode::Logo:
+  void pollSettings()
+  {
+    if (Boot::sensorsReady())
+      Settings::poll();
+  }
+}
+
+void setup()
+{
+  Serial.begin(115200);
+
+  if (!Boot::run())
   {
-    DisplayUI::showSplash();
     while (true)
     {
-      Input::updateButton();
-      if (Input::consumeButtonPress())
-      {
-        break;
-      }
-      delay(5);
+      delay(1000);
     }
-    break;
-  }
   }
 
-  while (Input::isButtonDown())
-  {
-    delay(2);
-  }
+  Sched::every("console", CONSOLE_PERIOD_MS, pollConsole);
+  Sched::every("settings", SETTINGS_PERIOD_MS, pollSettings);
+}
 
-  ModeUI::begin();
+void loop()
+{
+  // UI flows, console and settings commits; sleeps until the next is due
+  Sched::runOnce();
 }
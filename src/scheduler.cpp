@@ -0,0 +1,272 @@
+#include "scheduler.h"
+
+#include <math.h>
+
+namespace
+{
+    struct Activity
+    {
+        const char *name;
+        uint32_t periodMs;     // fixed-rate only
+        uint32_t dueMs;        // fixed-rate only
+        void (*fn)();          // fixed-rate only
+        Coroutine *co;         // coroutine only
+
+        uint32_t runs;
+        uint32_t overruns;     // fixed-rate: re-phased after running past a whole period
+        uint32_t lateMaxMs;    // fixed-rate: start behind the deadline
+        uint32_t runMaxUs;     // longest run / step
+    };
+
+    Activity acts[SCHED_MAX_ACTIVITIES];
+    uint8_t actCount = 0;
+    const FixedRate *rates[SCHED_MAX_RATES];
+    uint8_t rateCount = 0;
+
+    // Set while runUntilDone() owns the coroutines
+    Coroutine *exclusive = nullptr;
+
+    inline bool reached(uint32_t dueMs, uint32_t nowMs)
+    {
+        return (int32_t)(nowMs - dueMs) >= 0;
+    }
+
+    bool coroutineDue(const Coroutine &co, uint32_t nowMs)
+    {
+        if (co.done())
+            return false;
+        return co.waitsInput() ? Input::pending() : reached(co.wakeMs(), nowMs);
+    }
+
+    void timed(Activity &a, uint32_t startUs)
+    {
+        const uint32_t us = micros() - startUs;
+        a.runs++;
+        if (us > a.runMaxUs)
+            a.runMaxUs = us;
+    }
+
+    void runFixed(Activity &a, uint32_t now)
+    {
+        const uint32_t late = now - a.dueMs;
+        if (late > a.lateMaxMs)
+            a.lateMaxMs = late;
+        const uint32_t startUs = micros();
+        a.fn();
+        timed(a, startUs);
+        a.dueMs += a.periodMs;
+        now = millis();
+        if (reached(a.dueMs, now))
+        {
+            a.dueMs = now + a.periodMs; // overran a whole period: re-phase
+            a.overruns++;
+        }
+    }
+
+    void stepCoroutine(Activity *a, Coroutine &co)
+    {
+        const uint32_t startUs = micros();
+        co.step();
+        if (a)
+            timed(*a, startUs);
+    }
+
+    Activity *find(const Coroutine &co)
+    {
+        for (uint8_t i = 0; i < actCount; i++)
+            if (acts[i].co == &co)
+                return &acts[i];
+        return nullptr;
+    }
+
+    // Earliest deadline among the fixed-rate activities and the coroutines
+    // that may run; input wakes the sleep early if one of those waits for it
+    void sleep()
+    {
+        const uint32_t now = millis();
+        uint32_t next = now + SCHED_MAX_SLEEP_MS;
+        bool inputWakes = false;
+        auto consider = [&](uint32_t dueMs) {
+            if ((int32_t)(dueMs - next) < 0)
+                next = dueMs;
+        };
+        auto considerCo = [&](const Coroutine &co) {
+            if (co.done())
+                return;
+            if (co.waitsInput())
+                inputWakes = true;
+            else
+                consider(co.wakeMs());
+        };
+
+        for (uint8_t i = 0; i < actCount; i++)
+        {
+            const Activity &a = acts[i];
+            if (a.fn)
+                consider(a.dueMs);
+            else if (!exclusive)
+                considerCo(*a.co);
+        }
+        if (exclusive)
+            considerCo(*exclusive);
+
+        const int32_t waitMs = (int32_t)(next - now);
+        if (waitMs <= 0)
+            return;
+        if (inputWakes)
+            Input::waitPending(waitMs);
+        else
+            delay(waitMs);
+    }
+} // namespace
+
+namespace Sched
+{
+    bool every(const char *name, uint32_t periodMs, void (*fn)())
+    {
+        if (actCount >= SCHED_MAX_ACTIVITIES || !fn || periodMs == 0)
+            return false;
+        acts[actCount++] = {name, periodMs, (uint32_t)millis(), fn, nullptr, 0, 0, 0, 0};
+        return true;
+    }
+
+    bool start(const char *name, Coroutine &co)
+    {
+        co.restart();
+        if (find(co))
+            return true;
+        if (actCount >= SCHED_MAX_ACTIVITIES)
+            return false;
+        acts[actCount++] = {name, 0, 0, nullptr, &co, 0, 0, 0, 0};
+        return true;
+    }
+
+    void runOnce()
+    {
+        for (uint8_t i = 0; i < actCount; i++)
+        {
+            Activity &a = acts[i];
+            const uint32_t now = millis();
+            if (a.fn)
+            {
+                if (reached(a.dueMs, now))
+                    runFixed(a, now);
+            }
+            else if (!exclusive && coroutineDue(*a.co, now))
+                stepCoroutine(&a, *a.co);
+        }
+        if (exclusive && coroutineDue(*exclusive, millis()))
+            stepCoroutine(find(*exclusive), *exclusive);
+        sleep();
+    }
+
+    void runUntilDone(Coroutine &co)
+    {
+        Coroutine *outer = exclusive;
+        exclusive = &co;
+        while (!co.done())
+            runOnce();
+        exclusive = outer;
+    }
+
+    void printStats(Print &out)
+    {
+        for (uint8_t i = 0; i < actCount; i++)
+        {
+            const Activity &a = acts[i];
+            if (a.fn)
+                out.printf("[SCHED] %-9s every %3lu ms  runs=%lu  late max %lu ms  overruns=%lu  run max %.2f ms\n",
+                           a.name, (unsigned long)a.periodMs, (unsigned long)a.runs, (unsigned long)a.lateMaxMs,
+                           (unsigned long)a.overruns, a.runMaxUs / 1000.0f);
+            else
+                out.printf("[SCHED] %-9s coroutine       steps=%lu  step max %.2f ms\n", a.name,
+                           (unsigned long)a.runs, a.runMaxUs / 1000.0f);
+        }
+        for (uint8_t i = 0; i < rateCount; i++)
+            rates[i]->print(out);
+    }
+} // namespace Sched
+
+// ================= FixedRate =================
+
+void FixedRate::start(uint32_t periodMs)
+{
+    _periodUs = periodMs * 1000u;
+    _dueUs = micros();
+    _nextMs = millis();
+    _first = true;
+    _stats = Stats{};
+    _stats.periodMinUs = UINT32_MAX;
+
+    bool listed = false;
+    for (uint8_t i = 0; i < rateCount; i++)
+        listed |= rates[i] == this;
+    if (!listed && rateCount < SCHED_MAX_RATES)
+        rates[rateCount++] = this;
+}
+
+void FixedRate::beginTick()
+{
+    const uint32_t now = micros();
+    const int32_t late = (int32_t)(now - _dueUs);
+    if (late > 0)
+    {
+        _stats.lateSumUs += late;
+        if ((uint32_t)late > _stats.lateMaxUs)
+            _stats.lateMaxUs = late;
+    }
+    if (!_first)
+    {
+        const uint32_t interval = now - _tickStartUs;
+        _stats.periodSumUs += interval;
+        if (interval < _stats.periodMinUs)
+            _stats.periodMinUs = interval;
+        if (interval > _stats.periodMaxUs)
+            _stats.periodMaxUs = interval;
+        const int32_t dev = (int32_t)(interval - _periodUs);
+        const uint32_t absDev = dev < 0 ? -dev : dev;
+        if (absDev > _stats.jitterMaxUs)
+            _stats.jitterMaxUs = absDev;
+        _stats.jitterSqSum += (dev / 1000.0f) * (dev / 1000.0f);
+    }
+    _first = false;
+    _tickStartUs = now;
+    _stats.ticks++;
+}
+
+void FixedRate::endTick()
+{
+    const uint32_t now = micros();
+    const uint32_t work = now - _tickStartUs;
+    _stats.workSumUs += work;
+    if (work > _stats.workMaxUs)
+        _stats.workMaxUs = work;
+
+    _dueUs += _periodUs;
+    int32_t leftUs = (int32_t)(_dueUs - now);
+    if (leftUs <= 0)
+    {
+        _stats.overruns++; // ran past the next deadline: re-phase from now
+        _dueUs = now;
+        leftUs = 0;
+    }
+    // The sleep is in whole milliseconds; round up so a tick never starts early
+    _nextMs = millis() + ((uint32_t)leftUs + 999u) / 1000u;
+}
+
+void FixedRate::print(Print &out) const
+{
+    const Stats &st = _stats;
+    if (st.ticks == 0)
+        return;
+    const uint32_t intervals = st.ticks - 1;
+    const float periodAvgMs = intervals ? st.periodSumUs / 1000.0f / intervals : 0.0f;
+    const float jitterRmsMs = intervals ? sqrtf(st.jitterSqSum / intervals) : 0.0f;
+    out.printf("[RATE] %s  %lu ms  n=%lu  period %.2f (%.2f..%.2f) ms  jitter rms %.2f max %.2f ms\n", _name,
+               (unsigned long)periodMs(), (unsigned long)st.ticks, periodAvgMs,
+               intervals ? st.periodMinUs / 1000.0f : 0.0f, st.periodMaxUs / 1000.0f, jitterRmsMs,
+               st.jitterMaxUs / 1000.0f);
+    out.printf("[RATE] %s  late avg %.2f max %.2f ms  work avg %.2f max %.2f ms  overruns=%lu\n", _name,
+               st.lateSumUs / 1000.0f / st.ticks, st.lateMaxUs / 1000.0f, st.workSumUs / 1000.0f / st.ticks,
+               st.workMaxUs / 1000.0f, (unsigned long)st.overruns);
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <Arduino.h>
+
+#include "coroutine.h"
+
+// =============== User knobs ===============
+#define SCHED_MAX_ACTIVITIES 8
+#define SCHED_MAX_SLEEP_MS 100 // longest idle wait with nothing due
+#define SCHED_MAX_RATES 4      // FixedRate loops listed by the stats command
+#define SCHED_SERIAL_CMD 'S'   // send over Serial to print the timing statistics
+// =========================================
+
+// Cooperative scheduler for the Arduino loop task: everything that used to
+// be a blocking loop (the UI flows, the serial console, settings commits)
+// is an activity here, and loop() is one Sched::runOnce() after another.
+//
+// Two kinds of activity:
+// - every(): a plain function run at a fixed rate on absolute deadlines,
+//   so a slow run does not shift the ones after it (a run late by a whole
+//   period re-phases instead of bursting);
+// - start(): a coroutine, stepped when its sleep runs out or, while it
+//   waits for input, as soon as an input event is queued.
+//
+// Between passes the loop task sleeps until the earliest deadline, woken
+// early by the input queue, so an idle menu costs no CPU. Acquisition and
+// the flash writer keep their own tasks on core 0.
+//
+// Timing is measured as it runs. SCHED_SERIAL_CMD prints one line per
+// activity (runs, lateness, longest run or step) and two per FixedRate
+// loop:
+//
+//   [SCHED] ui        coroutine       steps=626  step max 67.61 ms
+//   [SCHED] console   every  20 ms  runs=4870  late max 1 ms  overruns=0  run max 0.03 ms
+//   [RATE] control  100 ms  n=936  period 100.00 (99.03..100.89) ms  jitter rms 0.57 max 0.97 ms
+//   [RATE] control  late avg 0.52 max 1.03 ms  work avg 47.58 max 66.31 ms  overruns=0
+//
+// The control loop's two [RATE] lines are also printed after every cycle.
+
+// Deadlines and timing statistics for a loop a coroutine runs at a fixed
+// rate. Deadlines are absolute (no drift from the work time); a tick whose
+// work runs past the next deadline is an overrun and the loop re-phases
+// instead of bursting.
+//
+//   _rate.start(100);
+//   for (;;) { _rate.beginTick(); work(); _rate.endTick(); CO_SLEEP_UNTIL(_rate.nextMs()); }
+class FixedRate
+{
+public:
+    struct Stats
+    {
+        uint32_t ticks;
+        uint32_t overruns;
+        uint32_t periodMinUs; // start-to-start intervals
+        uint32_t periodMaxUs;
+        uint64_t periodSumUs;
+        uint32_t jitterMaxUs; // largest |interval - period|
+        float jitterSqSum;    // sum of (interval - period)^2, ms^2
+        uint32_t lateMaxUs;   // tick start behind its deadline
+        uint64_t lateSumUs;
+        uint32_t workMaxUs;   // beginTick() to endTick()
+        uint64_t workSumUs;
+    };
+
+    explicit FixedRate(const char *name) : _name(name) {}
+
+    // First tick due now; clears the statistics and lists this loop in the
+    // stats command
+    void start(uint32_t periodMs);
+
+    void beginTick();
+    void endTick();
+
+    // millis() deadline of the next tick
+    uint32_t nextMs() const { return _nextMs; }
+
+    const char *name() const { return _name; }
+    uint32_t periodMs() const { return _periodUs / 1000; }
+    const Stats &stats() const { return _stats; }
+    void print(Print &out) const;
+
+private:
+    const char *_name;
+    uint32_t _periodUs = 0;
+    uint32_t _dueUs = 0;
+    uint32_t _nextMs = 0;
+    uint32_t _tickStartUs = 0;
+    bool _first = true;
+    Stats _stats{};
+};
+
+namespace Sched
+{
+    // False if the table is full
+    bool every(const char *name, uint32_t periodMs, void (*fn)());
+
+    // Register co (or restart it if it already is) and step it from the
+    // next pass; it is dropped from the passes once it finishes
+    bool start(const char *name, Coroutine &co);
+
+    // One pass: run everything that is due, then sleep until the next
+    // deadline or input
+    void runOnce();
+
+    // Blocking: run passes until co (already restarted) finishes. The
+    // fixed-rate activities keep running; other coroutines are paused
+    // meanwhile.
+    void runUntilDone(Coroutine &co);
+
+    // Activity and FixedRate statistics, as above
+    void printStats(Print &out);
+} // namespace Sched
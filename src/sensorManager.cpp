@@ -1,5 +1,10 @@
 #include "sensorManager.h"
 #include "tca_breakout.h"
+#include "trace.h"
+#include "settings.h"
+#include "boot.h"
+
+#include <atomic>
 
 // Adjust to your actual mux channel for MLX90614
 static constexpr int8_t TEMP_MUX_CH = 0;
@@ -12,35 +17,51 @@ static constexpr uint32_t LC_PERIOD_MS = 200;
 static TemperatureSensor g_tempSensor(TEMP_MUX_CH, TEMP_PERIOD_MS);
 static LoadCellNAU7802 g_loadCell(LC_PERIOD_MS);
 
-void sensorsBegin()
-{
-    if (!g_tempSensor.begin())
-    {
-        Serial.println(F("[TEMP] MLX90614 init failed"));
-    }
-
-    if (!g_loadCell.begin(NAN))
-    {
-        Serial.println(F("[LC] NAU7802 init failed"));
-    }
+// ---------- Published snapshot (seqlock) ----------
+// Single writer (whoever runs acquireAndPublish), any number of readers.
+// Odd sequence = publish in progress.
+static std::atomic<uint32_t> g_snapSeq{0};
+static SensorSnapshot g_snap{};
 
-    colourSetup();
-    // Optional white calibration on CS_0:
-    // colourCalibrateWhite(CS_0, 16);
-}
+#if SENSOR_TASK_EN && defined(ESP32)
+static TaskHandle_t g_sensorTask = nullptr;
+#endif
 
-void sensorsUpdate()
+static void publishSnapshot(const SensorSnapshot &s)
 {
-    uint32_t now = millis();
-    g_tempSensor.update(now);
-    g_loadCell.update();
-    colourTickAll();
+    uint32_t seq = g_snapSeq.load(std::memory_order_relaxed);
+    g_snapSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    g_snap = s;
+    std::atomic_thread_fence(std::memory_order_release);
+    g_snapSeq.store(seq + 2, std::memory_order_release);
 }
 
-SensorSnapshot getSensorSnapshot()
+static void acquireAndPublish()
 {
+    // Fast (400 kHz) devices first, walking the mux channels in order, then
+    // the SMBus MLX so the clock only drops once per pass.
+    TRACE_SCOPE("sens.pass");
+    {
+        TRACE_SCOPE("sens.colour");
+        colourTickAll();
+    }
+    {
+        TRACE_SCOPE("sens.loadcell");
+        g_loadCell.update();
+    }
+    {
+        TRACE_SCOPE("sens.temp");
+        g_tempSensor.update(millis());
+    }
+
     SensorSnapshot s{};
-    s.tempC = static_cast<float>(g_tempSensor.object());
+    s.tempC = g_tempSensor.object();
+    const TempEstimator &te = g_tempSensor.estimator();
+    s.tempFiltC = te.valid() ? te.tempC() : s.tempC;
+    s.tempRateCps = te.rateCps();
+    s.tempConf = te.confidence();
+    s.tempFlat = te.flat();
     s.weightG = g_loadCell.weight_g();
 
     ColourReading cr{};
@@ -56,6 +77,127 @@ SensorSnapshot getSensorSnapshot()
         s.r8 = s.g8 = s.b8 = 0;
         s.brightness = 0.0f;
     }
+    s.tMs = millis();
+
+    publishSnapshot(s);
+}
+
+#if SENSOR_TASK_EN && defined(ESP32)
+static void sensorTask(void *)
+{
+    TickType_t wake = xTaskGetTickCount();
+    for (;;)
+    {
+        acquireAndPublish();
+        vTaskDelayUntil(&wake, pdMS_TO_TICKS(SENSOR_TASK_PERIOD_MS));
+    }
+}
+#endif
 
+void sensorsBegin()
+{
+    // Every saved calibration in one pass, before any sensor wants it
+    {
+        BootStage stage("settings");
+        Settings::begin();
+    }
+
+    {
+        BootStage stage("temp");
+        if (!g_tempSensor.begin())
+        {
+            Serial.println(F("[TEMP] MLX90614 init failed"));
+        }
+    }
+
+    {
+        BootStage stage("scale");
+        if (!g_loadCell.begin(NAN))
+        {
+            Serial.println(F("[LC] NAU7802 init failed"));
+        }
+    }
+
+    {
+        BootStage stage("colour");
+        colourSetup();
+        // Optional white calibration on CS_0:
+        // colourCalibrateWhite(CS_0, 16);
+    }
+
+    // Prime the snapshot so readers never see an empty one
+    {
+        BootStage stage("snapshot");
+        acquireAndPublish();
+    }
+
+#if SENSOR_TASK_EN && defined(ESP32)
+    // The OLED sits upstream of the TCA mux and Wire serializes each
+    // transaction internally, so the UI can keep drawing from core 1.
+    xTaskCreatePinnedToCore(sensorTask, "sensors", SENSOR_TASK_STACK, nullptr,
+                            SENSOR_TASK_PRIO, &g_sensorTask, SENSOR_TASK_CORE);
+#endif
+}
+
+void sensorsUpdate()
+{
+#if SENSOR_TASK_EN && defined(ESP32)
+    if (g_sensorTask)
+        return;
+#endif
+    acquireAndPublish();
+}
+
+SensorSnapshot getSensorSnapshot()
+{
+    SensorSnapshot s;
+    uint32_t before, after;
+    do
+    {
+        before = g_snapSeq.load(std::memory_order_acquire);
+        s = g_snap;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = g_snapSeq.load(std::memory_order_relaxed);
+    } while ((before & 1u) || before != after);
     return s;
 }
+
+float sensorsWeightLagS()
+{
+    return g_loadCell.readingLagS();
+}
+
+bool scaleStartTare()
+{
+    return g_loadCell.startTare();
+}
+
+bool scaleStartCalibrate(float knownMassG)
+{
+    return g_loadCell.startCalibrate(knownMassG);
+}
+
+void scaleCancelOp()
+{
+    g_loadCell.cancelOp();
+}
+
+LoadCellNAU7802::OpStatus scaleOpStatus()
+{
+    return g_loadCell.opStatus();
+}
+
+float scaleOpProgress()
+{
+    return g_loadCell.opProgress();
+}
+
+bool scaleConsoleCommand(char c)
+{
+    return g_loadCell.handleCommand(c);
+}
+
+void scaleConsoleReport()
+{
+    g_loadCell.reportOp();
+}
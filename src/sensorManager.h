@@ -5,14 +5,53 @@
 #include "load_cell.h"
 #include "colour.h"
 
+// =============== User knobs ===============
+#define SENSOR_TASK_EN 1          // 1 = acquire on a core-0 task, 0 = inline in sensorsUpdate()
+#define SENSOR_TASK_CORE 0        // PRO core; the Arduino loop runs on core 1
+#define SENSOR_TASK_PRIO 2        // above the loop task (1)
+#define SENSOR_TASK_STACK 4096    // bytes
+#define SENSOR_TASK_PERIOD_MS 10  // acquisition tick; drivers self-throttle below this
+// =========================================
+
 struct SensorSnapshot
 {
-    float tempC;
+    float tempC;       // latest MLX object reading
+    float tempFiltC;   // estimator: filtered object temperature
+    float tempRateCps; // estimator: dT/dt, °C per second
+    float tempConf;    // estimator: 0..1, how tightly the rate is known
+    bool tempFlat;     // rate statistically within +-TEMP_FLAT_CPS
     float weightG;
     uint8_t r8, g8, b8;
     float brightness;
+    uint32_t tMs; // millis() when this snapshot was published
 };
 
 void sensorsBegin();
+
+// With the acquisition task running this is a no-op kept for callers that
+// still pace themselves on it; otherwise it acquires inline.
 void sensorsUpdate();
+
+// Copy of the latest published snapshot. Safe from any core; never blocks
+// on the acquisition side (retries only if it overlaps a publish).
 SensorSnapshot getSensorSnapshot();
+
+// How far SensorSnapshot::weightG trails the load on a slow ramp, in seconds
+// (load-cell decimation and filtering; the snapshot itself is fresh)
+float sensorsWeightLagS();
+
+// Scale tare / calibration (load_cell.h): nothing blocks, the acquisition
+// side averages its normal readings, then applies and saves the result.
+// Start one from any task and poll scaleOpStatus(). False if one is
+// already running or the scale is not up.
+bool scaleStartTare();
+bool scaleStartCalibrate(float knownMassG); // the mass must already be on the scale
+void scaleCancelOp();
+LoadCellNAU7802::OpStatus scaleOpStatus();
+float scaleOpProgress(); // 0..1
+
+// The scale's console commands ('t' tare, 'c' calibrate, 'b' baseline);
+// false if c is not one of them. scaleConsoleReport() prints each finished
+// operation once.
+bool scaleConsoleCommand(char c);
+void scaleConsoleReport();
@@ -0,0 +1,343 @@
+#include "settings.h"
+
+#include <Preferences.h>
+#include <math.h>
+#include <stddef.h>
+#include <string.h>
+#if SETTINGS_LEGACY_IMPORT
+#include <EEPROM.h>
+#endif
+
+namespace
+{
+    constexpr uint32_t IMAGE_MAGIC = 0x54455354; // "TSET"
+    constexpr uint8_t MAX_VALUE = 8;
+    constexpr const char *SLOT_KEY[2] = {"img0", "img1"};
+
+    struct ImageHeader
+    {
+        uint32_t magic;
+        uint16_t schema;
+        uint16_t len;  // record bytes after the header
+        uint32_t seq;  // newer image = higher
+        uint32_t crc;  // CRC32 of the header up to here, then the records
+    };
+    static_assert(sizeof(ImageHeader) == 16, "ImageHeader layout");
+
+    constexpr size_t IMAGE_MAX = sizeof(ImageHeader) + SETTINGS_MAX_KEYS * (2 + MAX_VALUE);
+
+    struct Slot
+    {
+        uint8_t id = 0; // 0 = free
+        uint8_t size = 0;
+        uint8_t value[MAX_VALUE];
+    };
+
+    Slot slots[SETTINGS_MAX_KEYS];
+    Preferences prefs;
+    bool started = false;
+    bool loaded = false;
+    bool dirty = false;
+    uint32_t changedAtMs = 0;
+    uint32_t seq = 0;
+    uint8_t nextSlot = 0; // NVS blob the next image goes to
+    uint32_t commitCount = 0;
+
+#if defined(ESP32)
+    // set() can come from the sensor task (a tare finishing) while the
+    // main loop commits
+    SemaphoreHandle_t lock = nullptr;
+#endif
+
+    struct Guard
+    {
+        Guard()
+        {
+#if defined(ESP32)
+            if (lock)
+                xSemaphoreTake(lock, portMAX_DELAY);
+#endif
+        }
+        ~Guard()
+        {
+#if defined(ESP32)
+            if (lock)
+                xSemaphoreGive(lock);
+#endif
+        }
+    };
+
+    uint32_t crc32(uint32_t crc, const uint8_t *p, size_t n)
+    {
+        crc = ~crc;
+        while (n--)
+        {
+            crc ^= *p++;
+            for (int k = 0; k < 8; k++)
+                crc = (crc >> 1) ^ (0xEDB88320u & (0u - (crc & 1u)));
+        }
+        return ~crc;
+    }
+
+    uint32_t imageCrc(const ImageHeader &h, const uint8_t *records)
+    {
+        const uint32_t c = crc32(0, (const uint8_t *)&h, offsetof(ImageHeader, crc));
+        return crc32(c, records, h.len);
+    }
+
+    Slot *find(SettingId id)
+    {
+        for (Slot &s : slots)
+            if (s.id == (uint8_t)id)
+                return &s;
+        return nullptr;
+    }
+
+    Slot *findOrAdd(SettingId id)
+    {
+        Slot *s = find(id);
+        if (s)
+            return s;
+        for (Slot &f : slots)
+            if (f.id == 0)
+            {
+                f.id = (uint8_t)id;
+                return &f;
+            }
+        return nullptr;
+    }
+
+    // Whole image checks out: magic, length, CRC and every record in bounds
+    bool valid(const uint8_t *buf, size_t n, uint32_t &seqOut)
+    {
+        if (n < sizeof(ImageHeader))
+            return false;
+        ImageHeader h;
+        memcpy(&h, buf, sizeof(h));
+        const uint8_t *rec = buf + sizeof(h);
+        if (h.magic != IMAGE_MAGIC || sizeof(h) + h.len != n || imageCrc(h, rec) != h.crc)
+            return false;
+
+        size_t count = 0;
+        for (size_t off = 0; off < h.len; off += 2 + rec[off + 1], count++)
+            if (off + 2 > h.len || rec[off] == 0 || rec[off + 1] > MAX_VALUE || off + 2 + rec[off + 1] > h.len)
+                return false;
+        if (count > SETTINGS_MAX_KEYS)
+            return false;
+        seqOut = h.seq;
+        return true;
+    }
+
+    // A valid image -> slots. Schema 1 is the first; older images would be
+    // converted here.
+    void load(const uint8_t *buf)
+    {
+        ImageHeader h;
+        memcpy(&h, buf, sizeof(h));
+        const uint8_t *rec = buf + sizeof(h);
+        for (Slot &s : slots)
+            s = Slot();
+        for (size_t off = 0, i = 0; off < h.len; off += 2 + rec[off + 1], i++)
+        {
+            slots[i].id = rec[off];
+            slots[i].size = rec[off + 1];
+            memcpy(slots[i].value, rec + off + 2, slots[i].size);
+        }
+    }
+
+    size_t build(uint8_t *buf, uint32_t imageSeq)
+    {
+        ImageHeader h{};
+        h.magic = IMAGE_MAGIC;
+        h.schema = SETTINGS_SCHEMA;
+        h.seq = imageSeq;
+        uint8_t *rec = buf + sizeof(h);
+        size_t len = 0;
+        for (const Slot &s : slots)
+        {
+            if (s.id == 0)
+                continue;
+            rec[len] = s.id;
+            rec[len + 1] = s.size;
+            memcpy(rec + len + 2, s.value, s.size);
+            len += 2 + s.size;
+        }
+        h.len = (uint16_t)len;
+        h.crc = imageCrc(h, rec);
+        memcpy(buf, &h, sizeof(h));
+        return sizeof(h) + len;
+    }
+
+#if SETTINGS_LEGACY_IMPORT
+    // The raw EEPROM layout before this store: colour C_ref at 0x00,
+    // scale factor and zero at 0x30, each behind a signature byte
+    bool importLegacy()
+    {
+#if defined(ESP32)
+        EEPROM.begin(64);
+#endif
+        bool any = false;
+        if (EEPROM.read(0x00) == 0xA5)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                const uint16_t v = (uint16_t)EEPROM.read(1 + i * 2) | ((uint16_t)EEPROM.read(2 + i * 2) << 8);
+                if (v >= 10 && v < 65535)
+                {
+                    Settings::set(Setting::ColourRef[i], v);
+                    any = true;
+                }
+            }
+        }
+        if (EEPROM.read(0x30) == 0x5A)
+        {
+            float cpg;
+            int32_t zero;
+            uint8_t raw[8];
+            for (int i = 0; i < 8; i++)
+                raw[i] = EEPROM.read(0x31 + i);
+            memcpy(&cpg, raw, 4);
+            memcpy(&zero, raw + 4, 4);
+            if (cpg > 0.0f && isfinite(cpg))
+            {
+                Settings::set(Setting::ScaleCountsPerGram, cpg);
+                Settings::set(Setting::ScaleZero, zero);
+                any = true;
+            }
+        }
+        return any;
+    }
+#endif
+} // namespace
+
+namespace Settings
+{
+    bool begin()
+    {
+        if (started)
+            return loaded;
+        started = true;
+#if defined(ESP32)
+        lock = xSemaphoreCreateMutex();
+#endif
+        if (!prefs.begin(SETTINGS_NAMESPACE))
+        {
+            Serial.println(F("[SET] NVS open failed, defaults only"));
+            return false;
+        }
+
+        // Newest copy that checks out; the other slot takes the next write
+        static uint8_t buf[2][IMAGE_MAX];
+        bool ok[2] = {false, false};
+        bool present[2] = {false, false};
+        uint32_t seqs[2] = {0, 0};
+        for (uint8_t i = 0; i < 2; i++)
+        {
+            const size_t n = prefs.getBytesLength(SLOT_KEY[i]);
+            present[i] = n != 0;
+            ok[i] = n && n <= IMAGE_MAX && prefs.getBytes(SLOT_KEY[i], buf[i], n) == n && valid(buf[i], n, seqs[i]);
+        }
+        int use = -1;
+        if (ok[0] && ok[1])
+            use = (int32_t)(seqs[1] - seqs[0]) > 0 ? 1 : 0;
+        else if (ok[0] || ok[1])
+            use = ok[0] ? 0 : 1;
+
+        if (use >= 0)
+        {
+            load(buf[use]);
+            seq = seqs[use];
+            nextSlot = use ^ 1;
+            loaded = true;
+
+            uint8_t keys = 0;
+            for (const Slot &s : slots)
+                keys += s.id != 0;
+            Serial.printf("[SET] %u keys from %s (image %lu)%s\n", keys, SLOT_KEY[use], (unsigned long)seq,
+                          ok[use ^ 1] || !present[use ^ 1] ? "" : ", other copy corrupt");
+            return true;
+        }
+
+        for (Slot &s : slots)
+            s = Slot();
+#if SETTINGS_LEGACY_IMPORT
+        if (importLegacy())
+        {
+            Serial.println(F("[SET] imported the EEPROM calibration"));
+            loaded = flush();
+            return loaded;
+        }
+#endif
+        if (present[0] || present[1])
+            Serial.println(F("[SET] stored settings corrupt, defaults"));
+        else
+            Serial.println(F("[SET] no stored settings, defaults"));
+        return false;
+    }
+
+    bool getRaw(SettingId id, void *out, uint8_t size)
+    {
+        Guard g;
+        const Slot *s = find(id);
+        if (!s || s->size != size)
+            return false;
+        memcpy(out, s->value, size);
+        return true;
+    }
+
+    void setRaw(SettingId id, const void *value, uint8_t size)
+    {
+        if (size > MAX_VALUE)
+            return;
+        Guard g;
+        Slot *s = findOrAdd(id);
+        if (!s)
+        {
+            Serial.println(F("[SET] no free key slot"));
+            return;
+        }
+        if (s->size == size && memcmp(s->value, value, size) == 0)
+            return;
+        s->size = size;
+        memcpy(s->value, value, size);
+        dirty = true;
+        changedAtMs = millis();
+    }
+
+    void poll()
+    {
+        if (dirty && millis() - changedAtMs >= SETTINGS_COMMIT_DELAY_MS)
+            flush();
+    }
+
+    bool flush()
+    {
+        static uint8_t buf[IMAGE_MAX];
+        size_t n;
+        uint8_t slot;
+        {
+            Guard g;
+            if (!dirty)
+                return true;
+            n = build(buf, seq + 1);
+            slot = nextSlot;
+            dirty = false;
+        }
+
+        // The other copy stays intact until this one is complete
+        if (prefs.putBytes(SLOT_KEY[slot], buf, n) != n)
+        {
+            Guard g;
+            dirty = true; // try again on the next poll
+            changedAtMs = millis();
+            Serial.println(F("[SET] write failed"));
+            return false;
+        }
+        seq++;
+        nextSlot = slot ^ 1;
+        commitCount++;
+        return true;
+    }
+
+    uint32_t commits() { return commitCount; }
+} // namespace Settings
@@ -0,0 +1,86 @@
+#pragma once
+#include <Arduino.h>
+
+// =============== User knobs ===============
+#define SETTINGS_NAMESPACE "toaster"  // NVS namespace (Preferences)
+#define SETTINGS_COMMIT_DELAY_MS 2000 // changes are written once they have been quiet this long
+#define SETTINGS_MAX_KEYS 16          // RAM slots (every key ever stored, known or not)
+#define SETTINGS_LEGACY_IMPORT 1      // empty store: take over the old raw EEPROM calibration
+// =========================================
+
+// Everything the device learns about itself, in one store. The values live
+// in RAM, loaded once at boot (Settings::begin(), from sensorsBegin());
+// set() only touches RAM and Settings::poll() writes the whole image once
+// the changes have gone quiet, so a calibration that updates several keys
+// costs one flash write.
+//
+// The image is a list of (id, size, value) records behind a header with
+// the schema version, a sequence number and a CRC32. It is written to two
+// NVS blobs in turn; boot takes the newest copy whose CRC holds, so a
+// corrupted or half-written image falls back to the previous one instead
+// of to defaults. Records with ids this firmware does not know are kept
+// and written back.
+//
+// Ids are forever: never reuse one or change its type. A key whose meaning
+// changes gets a new id; bump SETTINGS_SCHEMA only for a conversion that
+// Settings::begin() has to apply to older images.
+
+#define SETTINGS_SCHEMA 1
+
+enum class SettingId : uint8_t
+{
+    ColourRef0 = 1,     // uint16_t: white clear count at 614 ms / 1x, CS_0
+    ColourRef1 = 2,     // ... CS_1
+    ColourRef2 = 3,     // ... CS_2
+    ScaleCountsPerGram = 4, // float
+    ScaleZero = 5,      // int32_t: raw counts with the jig empty
+};
+
+template <typename T>
+struct SettingKey
+{
+    SettingId id;
+};
+
+namespace Setting
+{
+    constexpr SettingKey<uint16_t> ColourRef[3] = {
+        {SettingId::ColourRef0}, {SettingId::ColourRef1}, {SettingId::ColourRef2}};
+    constexpr SettingKey<float> ScaleCountsPerGram{SettingId::ScaleCountsPerGram};
+    constexpr SettingKey<int32_t> ScaleZero{SettingId::ScaleZero};
+} // namespace Setting
+
+namespace Settings
+{
+    // Load the store (once; later calls return the first result). False
+    // if nothing valid was found and every key is at its default.
+    bool begin();
+
+    // Write pending changes once SETTINGS_COMMIT_DELAY_MS has passed since
+    // the last one; call from the main loop
+    void poll();
+
+    // Write pending changes now. False if the write failed.
+    bool flush();
+
+    // Images written since boot
+    uint32_t commits();
+
+    bool getRaw(SettingId id, void *out, uint8_t size);
+    void setRaw(SettingId id, const void *value, uint8_t size);
+
+    // False (out untouched) if the key was never stored
+    template <typename T>
+    bool get(SettingKey<T> key, T &out)
+    {
+        return getRaw(key.id, &out, sizeof(T));
+    }
+
+    // Stage a new value; an unchanged one is not a change
+    template <typename T>
+    void set(SettingKey<T> key, const T &value)
+    {
+        static_assert(sizeof(T) <= 8, "setting values are at most 8 bytes");
+        setRaw(key.id, &value, sizeof(T));
+    }
+} // namespace Settings
@@ -0,0 +1,204 @@
+#pragma once
+
+// Sliding-window statistics and a step / settle detector built on them,
+// both O(1) per sample. Meant for uniformly paced samples (a control loop
+// reading the sensor snapshot), so time is measured in samples.
+//
+//   SettleDetector<8> det(cfg);
+//   switch (det.push(weightG)) { case SettleEvent::Step: ...; case SettleEvent::Settled: ...; }
+//
+// Thresholds are multiples of the detector's own noise floor, learned from
+// quiet windows, so the same code serves a 0.03 g scale and a 0.2 C
+// thermometer.
+
+#include <Arduino.h>
+#include <math.h>
+
+// Mean, variance (sliding Welford) and least-squares slope over the last
+// N samples. The running sums are rebuilt from the ring once per N
+// samples so float error cannot accumulate.
+template <uint8_t N>
+class SlidingStats
+{
+    static_assert(N >= 3, "SlidingStats needs a window of at least 3");
+
+public:
+    SlidingStats() { reset(); }
+
+    void reset()
+    {
+        _n = 0;
+        _head = 0;
+        _mean = _m2 = _s0 = _s1 = 0.0f;
+    }
+
+    void push(float x)
+    {
+        if (_n < N)
+        {
+            // growing: plain Welford, new sample at position _n
+            const float d = x - _mean;
+            _buf[_head] = x;
+            _s1 += _n * x;
+            _s0 += x;
+            ++_n;
+            _mean += d / _n;
+            _m2 += d * (x - _mean);
+        }
+        else
+        {
+            // sliding: drop the oldest (position 0), shift, append at N-1
+            const float old = _buf[_head];
+            const float oldMean = _mean;
+            _buf[_head] = x;
+            _mean += (x - old) / N;
+            _m2 += (x - old) * (x - _mean + old - oldMean);
+            _s1 += (N - 1) * x - (_s0 - old);
+            _s0 += x - old;
+        }
+        if (++_head == N)
+        {
+            _head = 0;
+            resync();
+        }
+    }
+
+    uint8_t count() const { return _n; }
+    bool full() const { return _n == N; }
+    float mean() const { return _mean; }
+    float variance() const { return _n > 1 ? fmaxf(0.0f, _m2 / (_n - 1)) : 0.0f; }
+    float stddev() const { return sqrtf(variance()); }
+
+    // Least-squares slope, units per sample
+    float slope() const
+    {
+        if (_n < 2)
+            return 0.0f;
+        const float n = _n;
+        const float sk = n * (n - 1.0f) * 0.5f;
+        const float skk = (n - 1.0f) * n * (2.0f * n - 1.0f) / 6.0f;
+        return (n * _s1 - sk * _s0) / (n * skk - sk * sk);
+    }
+
+    // Variance left once the linear trend is removed (the noise)
+    float residualVariance() const
+    {
+        const float b = slope();
+        return fmaxf(0.0f, variance() - b * b * _n * (_n + 1) / 12.0f);
+    }
+
+    // Where the trend puts the next sample
+    float predictNext() const { return _mean + slope() * (_n + 1) * 0.5f; }
+
+private:
+    // Exact sums, oldest sample first (called when _head wraps to 0)
+    void resync()
+    {
+        if (_n < N)
+            return;
+        float s0 = 0.0f, s1 = 0.0f;
+        for (uint8_t k = 0; k < N; k++)
+        {
+            s0 += _buf[k];
+            s1 += k * _buf[k];
+        }
+        const float mean = s0 / N;
+        float m2 = 0.0f;
+        for (uint8_t k = 0; k < N; k++)
+            m2 += (_buf[k] - mean) * (_buf[k] - mean);
+        _s0 = s0;
+        _s1 = s1;
+        _mean = mean;
+        _m2 = m2;
+    }
+
+    float _buf[N];
+    uint8_t _n, _head;
+    float _mean, _m2; // Welford
+    float _s0, _s1;   // sum y, sum k*y (k = 0 for the oldest)
+};
+
+struct SettleConfig
+{
+    float minNoise = 0.02f; // never assume a quieter signal than this
+    float minStep = 1.0f;   // smallest departure that counts as a step
+    float stepK = 6.0f;     // step: sample leaves the trend by stepK x noise
+    float settleK = 3.0f;   // settled: spread and drift across the window within settleK x noise
+    float floorRise = 0.02f; // per sample: how fast the noise floor may climb
+};
+
+enum class SettleEvent : uint8_t
+{
+    None,
+    Step,    // sample broke away from the window's trend; window restarted
+    Settled  // window has become quiet (reported once per quiet spell)
+};
+
+template <uint8_t N>
+class SettleDetector
+{
+public:
+    explicit SettleDetector(const SettleConfig &cfg = SettleConfig()) : _cfg(cfg), _floor(cfg.minNoise) {}
+
+    void reset()
+    {
+        _stats.reset();
+        _settled = false;
+    }
+
+    SettleEvent push(float x)
+    {
+        if (_stats.count() >= 3)
+        {
+            const float ref = _stats.full() ? _stats.predictNext() : _stats.mean();
+            if (fabsf(x - ref) > stepThreshold())
+            {
+                _stepFrom = ref;
+                _step = x - ref;
+                _stats.reset();
+                _stats.push(x);
+                _settled = false;
+                return SettleEvent::Step;
+            }
+        }
+
+        _stats.push(x);
+        if (!_stats.full())
+            return SettleEvent::None;
+
+        // Noise floor: follows quiet windows down at once, noisy ones up slowly
+        const float resid = sqrtf(_stats.residualVariance());
+        _floor = resid < _floor ? resid : _floor + _cfg.floorRise * (resid - _floor);
+
+        const float quiet = _cfg.settleK * noise();
+        const bool calm = _stats.stddev() <= quiet && fabsf(drift()) <= quiet;
+        if (calm && !_settled)
+        {
+            _settled = true;
+            return SettleEvent::Settled;
+        }
+        if (!calm)
+            _settled = false;
+        return SettleEvent::None;
+    }
+
+    bool settled() const { return _settled; }
+    float noise() const { return fmaxf(_floor, _cfg.minNoise); }
+    float stepThreshold() const { return fmaxf(_cfg.stepK * noise(), _cfg.minStep); }
+
+    // Change across the window according to its trend
+    float drift() const { return _stats.slope() * (N - 1); }
+
+    // Last step: where the trend was and how far the sample jumped from it
+    float stepFrom() const { return _stepFrom; }
+    float stepSize() const { return _step; }
+
+    const SlidingStats<N> &stats() const { return _stats; }
+
+private:
+    SettleConfig _cfg;
+    SlidingStats<N> _stats;
+    float _floor;
+    float _stepFrom = 0.0f, _step = 0.0f;
+    bool _settled = false;
+};
@@ -0,0 +1,61 @@
+#pragma once
+
+// Fixed-size ring for exactly one producer and one consumer, e.g. an ISR
+// pushing and a task popping. Lock-free and wait-free on both sides: the
+// producer owns the head, the consumer the tail, and each publishes its
+// index with a release store the other side reads with acquire.
+//
+//   SpscQueue<InputEvent, 32> q;
+//   q.push(ev);            // producer only; false when full
+//   while (q.pop(ev)) ...  // consumer only
+//
+// The indices run free and wrap at 2^16, so N is a power of two and all
+// N slots are usable.
+
+#include <Arduino.h>
+#include <atomic>
+
+template <typename T, uint16_t N>
+class SpscQueue
+{
+    static_assert(N >= 2 && N <= 32768 && (N & (N - 1)) == 0, "SpscQueue size must be a power of two");
+
+public:
+    bool push(const T &v)
+    {
+        const uint16_t head = _head.load(std::memory_order_relaxed);
+        if ((uint16_t)(head - _tail.load(std::memory_order_acquire)) >= N)
+            return false;
+        _buf[head & (N - 1)] = v;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pop(T &out)
+    {
+        const uint16_t tail = _tail.load(std::memory_order_relaxed);
+        if (tail == _head.load(std::memory_order_acquire))
+            return false;
+        out = _buf[tail & (N - 1)];
+        _tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side: drop everything queued so far
+    void clear()
+    {
+        _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+    uint16_t size() const
+    {
+        return (uint16_t)(_head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire));
+    }
+
+    bool empty() const { return size() == 0; }
+
+private:
+    T _buf[N];
+    std::atomic<uint16_t> _head{0};
+    std::atomic<uint16_t> _tail{0};
+};
@@ -1,7 +1,99 @@
 // TemperatureSensor.h
 #pragma once
+#include <math.h>
 #include <Adafruit_MLX90614.h>
 #include "tca_breakout.h"
+#include "i2c_bus.h"
+
+// =============== User knobs ===============
+#define TEMP_EST_ACCEL 0.05f     // °C/s²: how fast the heating rate itself may change
+#define TEMP_EST_NOISE_C 0.15f   // °C rms: MLX object reading noise
+#define TEMP_FLAT_CPS 0.25f      // |dT/dt| (plus 2 sigma) under this counts as flat
+#define TEMP_FLAT_MIN_SAMPLES 10 // estimator samples before it may call anything flat
+#define TEMP_AMBIENT_EVERY 10    // read the die (ambient) every Nth update; 0 = never
+// =========================================
+
+// Constant-rate Kalman filter on the object temperature: filtered value,
+// dT/dt and the rate's own uncertainty. While the innovations run larger
+// than the model expects (a bend in the heating curve, a door opening) the
+// process noise is scaled up by their normalised size, so the filter
+// follows quickly and the rate's error bars widen until it has caught up.
+class TempEstimator
+{
+public:
+    void reset() { _n = 0; }
+
+    // dtS since the previous sample; 0 (or a gap too long to bridge)
+    // restarts from this reading
+    void push(float z, float dtS)
+    {
+        if (_n == 0 || !(dtS > 0.0f) || dtS > MAX_GAP_S)
+        {
+            _t = z;
+            _v = 0.0f;
+            _nis = 1.0f;
+            _p00 = TEMP_EST_NOISE_C * TEMP_EST_NOISE_C;
+            _p01 = 0.0f;
+            _p11 = 100.0f; // nothing known about the rate yet
+            _n = 1;
+            return;
+        }
+
+        // Predict: rate held, white acceleration
+        const float q = TEMP_EST_ACCEL * TEMP_EST_ACCEL * fmaxf(_nis, 1.0f);
+        const float dt2 = dtS * dtS;
+        _t += _v * dtS;
+        _p00 += dtS * (2.0f * _p01 + dtS * _p11) + q * dt2 * dt2 * 0.25f;
+        _p01 += dtS * _p11 + q * dt2 * dtS * 0.5f;
+        _p11 += q * dt2;
+
+        // Update
+        const float y = z - _t;
+        const float s = _p00 + TEMP_EST_NOISE_C * TEMP_EST_NOISE_C;
+        const float k0 = _p00 / s, k1 = _p01 / s;
+        _t += k0 * y;
+        _v += k1 * y;
+        _p11 -= k1 * _p01;
+        _p01 -= k0 * _p01;
+        _p00 -= k0 * _p00;
+
+        // Normalised innovation squared, averaged: ~1 when the model fits
+        _nis += (y * y / s - _nis) * (1.0f / 16.0f);
+
+        if (_n < UINT16_MAX)
+            _n++;
+    }
+
+    bool valid() const { return _n > 0; }
+    float tempC() const { return _t; }
+    float rateCps() const { return _v; }
+    float rateSigma() const { return sqrtf(fmaxf(_p11, 0.0f)); }
+    float mismatch() const { return _nis; } // ~1 while the model fits
+
+    // 1 when the rate is pinned far tighter than the flat band, 0 when its
+    // 2-sigma spread would cover the whole band
+    float confidence() const
+    {
+        if (_n < TEMP_FLAT_MIN_SAMPLES)
+            return 0.0f;
+        const float c = 1.0f - 2.0f * rateSigma() / TEMP_FLAT_CPS;
+        return c > 0.0f ? c : 0.0f;
+    }
+
+    // Rate within +-TEMP_FLAT_CPS even at the edge of its 2-sigma band
+    bool flat() const
+    {
+        return _n >= TEMP_FLAT_MIN_SAMPLES && fabsf(_v) + 2.0f * rateSigma() <= TEMP_FLAT_CPS;
+    }
+
+private:
+    static constexpr float MAX_GAP_S = 2.0f;
+
+    float _t = 0, _v = 0;
+    float _p00 = 0, _p01 = 0, _p11 = 0;
+    float _nis = 1.0f;
+    uint16_t _n = 0;
+};
 
 class TemperatureSensor
 {
@@ -10,7 +102,8 @@ public:
         : ch(muxCh), period(periodMs) {}
     bool begin()
     {
-        tcaSelectChannel(ch);
+        I2CLease lease(I2CDev::Temp, ch);
+        est.reset();
         return mlx.begin();
     }
     void update(uint32_t now)
@@ -18,17 +111,40 @@ public:
         if (now - last < period)
             return;
         last = now;
-        tcaSelectChannel(ch);
-        ambC = mlx.readAmbientTempC();
-        objC = mlx.readObjectTempC();
+
+        // Only the object reading drives anything; the die temperature is
+        // refreshed now and then for diagnostics
+        const bool wantAmbient = TEMP_AMBIENT_EVERY > 0 && ambientIn == 0;
+        if (TEMP_AMBIENT_EVERY > 0)
+            ambientIn = wantAmbient ? TEMP_AMBIENT_EVERY - 1 : ambientIn - 1;
+        float obj;
+        {
+            I2CLease lease(I2CDev::Temp, ch);
+            if (wantAmbient)
+                ambC = (float)mlx.readAmbientTempC();
+            obj = (float)mlx.readObjectTempC();
+            const uint8_t reads = wantAmbient ? 2 : 1;
+            I2CBus::account(I2CDev::Temp, reads, reads * 4); // cmd + 2 data + PEC each
+        }
+
+        // A failed SMBus read comes back as raw 0 (-273 °C)
+        if (obj < -70.0f)
+            return;
+        objC = obj;
+        est.push(objC, est.valid() ? (now - estMs) / 1000.0f : 0.0f);
+        estMs = now;
     }
-    double ambient() const { return ambC; }
-    double object() const { return objC; }
+    float ambient() const { return ambC; }
+    float object() const { return objC; }
+    const TempEstimator &estimator() const { return est; }
 
 private:
     int8_t ch;
     uint32_t period;
     uint32_t last = 0;
+    uint32_t estMs = 0;    // millis() of the estimator's last sample
+    uint8_t ambientIn = 0; // updates until the next ambient read
     Adafruit_MLX90614 mlx;
-    double ambC = 0, objC = 0;
+    float ambC = 0, objC = 0;
+    TempEstimator est;
 };
@@ -0,0 +1,83 @@
+#include "trace.h"
+
+#if TRACE_EN
+
+#include <atomic>
+#include <esp_timer.h>
+
+static_assert((TRACE_BUF_EVENTS & (TRACE_BUF_EVENTS - 1)) == 0,
+              "TRACE_BUF_EVENTS must be a power of two");
+
+namespace
+{
+    struct Event
+    {
+        uint32_t tUs;
+        const char *name;
+        uint32_t arg;
+        uint8_t ph;
+        uint8_t core;
+    };
+
+    Event ring[TRACE_BUF_EVENTS];
+
+    // Writers claim a slot with one atomic add and overwrite the oldest
+    // event; nothing blocks, so ISRs and both cores can record freely.
+    std::atomic<uint32_t> head{0};
+    std::atomic<bool> recording{true};
+
+    inline uint8_t coreId()
+    {
+#if defined(ESP32)
+        return (uint8_t)xPortGetCoreID();
+#else
+        return 0;
+#endif
+    }
+}
+
+namespace Trace
+{
+
+    void IRAM_ATTR record(const char *name, Phase ph, uint32_t arg)
+    {
+        if (!recording.load(std::memory_order_relaxed))
+            return;
+        const uint32_t i = head.fetch_add(1, std::memory_order_relaxed);
+        Event &e = ring[i & (TRACE_BUF_EVENTS - 1)];
+        e.tUs = (uint32_t)esp_timer_get_time();
+        e.name = name;
+        e.arg = arg;
+        e.ph = ph;
+        e.core = coreId();
+    }
+
+    void clear()
+    {
+        head.store(0, std::memory_order_relaxed);
+    }
+
+    void dump(Print &out)
+    {
+        recording.store(false);
+        delay(2); // let writers already inside record() finish their slot
+
+        const uint32_t end = head.load();
+        const uint32_t count = end < TRACE_BUF_EVENTS ? end : TRACE_BUF_EVENTS;
+        out.printf("#TRACE v1 events=%lu lost=%lu clock=us\n",
+                   (unsigned long)count, (unsigned long)(end - count));
+        for (uint32_t i = end - count; i != end; i++)
+        {
+            const Event &e = ring[i & (TRACE_BUF_EVENTS - 1)];
+            out.printf("%lu %c %u %s %lu\n", (unsigned long)e.tUs, (char)e.ph,
+                       (unsigned)e.core, e.name, (unsigned long)e.arg);
+        }
+        out.println("#END");
+
+        clear();
+        recording.store(true);
+    }
+
+} // namespace Trace
+
+#endif // TRACE_EN
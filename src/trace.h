@@ -0,0 +1,73 @@
+#pragma once
+#include <Arduino.h>
+
+// =============== User knobs ===============
+// Event tracing into a RAM ring. With TRACE_EN 0 every TRACE_* macro
+// expands to nothing and no buffer is allocated. Enable from the build
+// (-D TRACE_EN=1) or here.
+#ifndef TRACE_EN
+#define TRACE_EN 0
+#endif
+#define TRACE_BUF_EVENTS 1024 // ring size, power of two (16 B per event on ESP32)
+#define TRACE_SERIAL_CMD 'T'  // send over Serial from the menu to dump the ring
+// =========================================
+
+// Event names must be string literals without spaces ("i2c.tcs").
+// Timestamps are esp_timer microseconds (low 32 bits); the dump is turned
+// into Chrome trace / Perfetto JSON by tools/trace2chrome.py.
+
+#if TRACE_EN
+
+namespace Trace
+{
+    enum Phase : uint8_t
+    {
+        Begin = 'B',
+        End = 'E',
+        Instant = 'i',
+        Counter = 'C'
+    };
+
+    // Safe from any task on either core and from ISRs
+    void record(const char *name, Phase ph, uint32_t arg = 0);
+
+    // Stops recording, prints the ring oldest-first, then clears and resumes
+    void dump(Print &out);
+    void clear();
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name, uint32_t arg = 0) : _name(name) { record(name, Begin, arg); }
+        ~Scope() { record(_name, End); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *_name;
+    };
+} // namespace Trace
+
+#define TRACE_CAT_(a, b) a##b
+#define TRACE_CAT(a, b) TRACE_CAT_(a, b)
+
+#define TRACE_BEGIN(name) Trace::record(name, Trace::Begin)
+#define TRACE_BEGIN_ARG(name, arg) Trace::record(name, Trace::Begin, (uint32_t)(arg))
+#define TRACE_END(name) Trace::record(name, Trace::End)
+#define TRACE_SCOPE(name) Trace::Scope TRACE_CAT(traceScope_, __LINE__)(name)
+#define TRACE_SCOPE_ARG(name, arg) Trace::Scope TRACE_CAT(traceScope_, __LINE__)(name, (uint32_t)(arg))
+#define TRACE_INSTANT(name, arg) Trace::record(name, Trace::Instant, (uint32_t)(arg))
+#define TRACE_COUNTER(name, value) Trace::record(name, Trace::Counter, (uint32_t)(value))
+
+#else
+
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_BEGIN_ARG(name, arg) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_SCOPE(name) ((void)0)
+#define TRACE_SCOPE_ARG(name, arg) ((void)0)
+#define TRACE_INSTANT(name, arg) ((void)0)
+#define TRACE_COUNTER(name, value) ((void)0)
+
+#endif
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Decode toast-cycle logs (src/cycle_log.h) into CSV.
+
+Capture the export from the firmware's main menu by sending 'L' over
+Serial and saving the monitor output, e.g.
+
+    pio device monitor | tee cycles.log
+    tools/tlog2csv.py cycles.log -o samples.csv
+    tools/tlog2csv.py cycles.log --summary
+
+Raw /tlog/<n>.bin files copied off the flash are accepted too. The input
+may contain other log lines; every #TLOG ... #END block is decoded. Use
+'-' for stdin.
+"""
+
+import argparse
+import csv
+import struct
+import sys
+
+HEADER = struct.Struct("<4sBBHIIiiiHH")  # CycleLogHeader, 32 bytes
+SAMPLE = struct.Struct("<BBHhhHHHH")     # CycleLogSample, 16 bytes
+END = struct.Struct("<BBhIiI")           # CycleLogEnd, 16 bytes
+
+GUIDES = {0: "weight", 1: "temp", 2: "colour"}
+REASONS = {0: "weight", 1: "temp_hold", 2: "timeout", 3: "colour"}
+
+
+def parse_blocks(lines):
+    """Yield the raw bytes of every #TLOG block."""
+    data = None
+    for raw in lines:
+        line = raw.strip()
+        if line.startswith("#TLOG"):
+            data = bytearray()
+            continue
+        if data is None:
+            continue
+        if line == "#END":
+            yield bytes(data)
+            data = None
+            continue
+        try:
+            data += bytes.fromhex(line)
+        except ValueError:
+            continue  # interleaved log output
+    if data:
+        yield bytes(data)  # truncated capture: keep what arrived
+
+
+def decode(data):
+    """One cycle file -> dict(header..., samples=[...], end=dict or None)."""
+    if len(data) < HEADER.size:
+        return None
+    (magic, version, guide, period_ms, cycle, start_ms, start_mg, target_mg,
+     start_mc, loss_q4, _) = HEADER.unpack_from(data, 0)
+    if magic != b"TLOG" or version != 1:
+        return None
+
+    out = {
+        "cycle": cycle,
+        "guide": GUIDES.get(guide, str(guide)),
+        "period_ms": period_ms,
+        "start_weight_g": start_mg / 1000.0,
+        "target_weight_g": target_mg / 1000.0,
+        "start_temp_c": start_mc / 1000.0,
+        "loss_frac": loss_q4 / 10000.0,
+        "samples": [],
+        "end": None,
+    }
+
+    # Deltas rebuild the track from the header's starting values
+    t_ms, w_mg, t_mc = 0, start_mg, start_mc
+    for off in range(HEADER.size, len(data) - 15, 16):
+        tag = data[off]
+        if tag == ord("S"):
+            _, sensor, dt, dw, dtemp, r, g, b, c = SAMPLE.unpack_from(data, off)
+            t_ms += dt
+            w_mg += dw
+            t_mc += dtemp
+            out["samples"].append({
+                "t_s": t_ms / 1000.0,
+                "weight_g": w_mg / 1000.0,
+                "temp_c": t_mc / 1000.0,
+                "sensor": sensor if sensor < 3 else "",
+                "r": r, "g": g, "b": b, "c": c,
+            })
+        elif tag == ord("E"):
+            _, reason, brown, toast_ms, stop_mg, settle_ms = END.unpack_from(data, off)
+            out["end"] = {
+                "reason": REASONS.get(reason, str(reason)),
+                "brown_index": brown,
+                "toast_s": toast_ms / 1000.0,
+                "stop_weight_g": stop_mg / 1000.0,
+                "settle_ms": settle_ms,
+            }
+    return out
+
+
+def read_cycles(paths):
+    cycles = []
+    for path in paths:
+        if path.endswith(".bin"):
+            with open(path, "rb") as f:
+                blobs = [f.read()]
+        else:
+            src = sys.stdin if path == "-" else open(path, errors="replace")
+            with src:
+                blobs = list(parse_blocks(src))
+        cycles += [c for c in map(decode, blobs) if c]
+    return cycles
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("input", nargs="+", help="Serial capture(s) with #TLOG blocks, .bin files, or -")
+    ap.add_argument("-o", "--output", default="-", help="CSV output (default stdout)")
+    ap.add_argument("--summary", action="store_true", help="one row per cycle instead of per sample")
+    args = ap.parse_args()
+
+    cycles = read_cycles(args.input)
+    dst = sys.stdout if args.output == "-" else open(args.output, "w", newline="")
+    with dst:
+        w = csv.writer(dst)
+        if args.summary:
+            w.writerow(["cycle", "guide", "start_weight_g", "target_weight_g", "start_temp_c",
+                        "loss_frac", "samples", "reason", "toast_s", "stop_weight_g",
+                        "brown_index", "settle_ms"])
+            for c in cycles:
+                e = c["end"] or {}
+                w.writerow([c["cycle"], c["guide"], c["start_weight_g"], c["target_weight_g"],
+                            c["start_temp_c"], c["loss_frac"], len(c["samples"]),
+                            e.get("reason", "cut_short"), e.get("toast_s", ""),
+                            e.get("stop_weight_g", ""), e.get("brown_index", ""),
+                            e.get("settle_ms", "")])
+        else:
+            w.writerow(["cycle", "t_s", "weight_g", "temp_c", "sensor", "r", "g", "b", "c"])
+            for c in cycles:
+                for s in c["samples"]:
+                    w.writerow([c["cycle"], s["t_s"], s["weight_g"], s["temp_c"], s["sensor"],
+                                s["r"], s["g"], s["b"], s["c"]])
+
+    print("%d cycles" % len(cycles), file=sys.stderr)
+    return 0 if cycles else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
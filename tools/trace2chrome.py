@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Convert a Trace::dump() capture into Chrome trace / Perfetto JSON.
+
+Capture with the firmware built with -D TRACE_EN=1: in the main menu send
+'T' over Serial and save the monitor output, e.g.
+
+    pio device monitor | tee toast.log
+    tools/trace2chrome.py toast.log -o toast.json
+
+then open toast.json in chrome://tracing or https://ui.perfetto.dev.
+The input may contain other log lines; every #TRACE ... #END block is
+converted (later blocks continue the same timeline). Use '-' for stdin.
+"""
+
+import argparse
+import json
+import sys
+
+WRAP = 1 << 32
+
+
+def parse_blocks(lines):
+    """Yield lists of (t_us, ph, core, name, arg) per #TRACE block."""
+    block = None
+    for raw in lines:
+        line = raw.strip()
+        if line.startswith("#TRACE"):
+            block = []
+            continue
+        if block is None:
+            continue
+        if line == "#END":
+            yield block
+            block = None
+            continue
+        parts = line.split()
+        if len(parts) != 5:
+            continue  # interleaved log output
+        try:
+            block.append((int(parts[0]), parts[1], int(parts[2]), parts[3], int(parts[4])))
+        except ValueError:
+            continue
+    if block:
+        yield block  # truncated capture: keep what arrived
+
+
+def convert(blocks):
+    events = []
+    cores = set()
+    epoch = 0
+    last = None
+    open_spans = {}  # (core, name) -> depth, to drop ends whose begin was overwritten
+
+    for block in blocks:
+        for t, ph, core, name, arg in block:
+            # esp_timer low 32 bits wrap every ~71 min
+            if last is not None and t + epoch < last - WRAP // 2:
+                epoch += WRAP
+            ts = t + epoch
+            last = ts
+            cores.add(core)
+
+            ev = {"name": name, "ts": ts, "pid": 0, "tid": core}
+            key = (core, name)
+            if ph == "B":
+                open_spans[key] = open_spans.get(key, 0) + 1
+                ev.update(ph="B", cat=name.split(".")[0])
+                if arg:
+                    ev["args"] = {"arg": arg}
+            elif ph == "E":
+                if open_spans.get(key, 0) == 0:
+                    continue
+                open_spans[key] -= 1
+                ev["ph"] = "E"
+            elif ph == "i":
+                ev.update(ph="i", s="t", args={"arg": arg})
+            elif ph == "C":
+                ev.update(ph="C", args={name: arg})
+            else:
+                continue
+            events.append(ev)
+
+    meta = [{"name": "process_name", "ph": "M", "pid": 0, "args": {"name": "toaster"}}]
+    for core in sorted(cores):
+        meta.append({"name": "thread_name", "ph": "M", "pid": 0, "tid": core,
+                     "args": {"name": "core %d" % core}})
+    return {"traceEvents": meta + events, "displayTimeUnit": "ms"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("input", help="Serial capture containing #TRACE blocks, or -")
+    ap.add_argument("-o", "--output", default="-", help="JSON output (default stdout)")
+    args = ap.parse_args()
+
+    src = sys.stdin if args.input == "-" else open(args.input, errors="replace")
+    with src:
+        trace = convert(parse_blocks(src))
+
+    n = len(trace["traceEvents"])
+    if args.output == "-":
+        json.dump(trace, sys.stdout)
+        sys.stdout.write("\n")
+    else:
+        with open(args.output, "w") as f:
+            json.dump(trace, f)
+    print("%d events" % n, file=sys.stderr)
+    return 0 if n else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())